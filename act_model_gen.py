@@ -0,0 +1,172 @@
+"""Quantise a float activity MLP into the firmware's int8 model format.
+
+Input is an .npz with
+    mean, std    per-feature normalisation (12 values, activity_features.h order)
+    W0, b0, ...  dense layers, W of shape (n_in, n_out), ReLU on all but the last
+    calib        raw feature rows (N x 12) used to pick activation ranges
+    labels       optional class per calib row, to report int8 vs float accuracy
+
+and the output replaces smartwatch_all_sensors/src/activity_model.c.
+act_model_synth.py makes the synthetic .npz behind the placeholder model.
+
+    python act_model_gen.py model.npz --id 2 -o smartwatch_all_sensors/src/activity_model.c
+"""
+import argparse
+import sys
+
+import numpy as np
+
+N_FEAT = 12
+N_CLASSES = 5
+WIDTH_MAX = 64      # MLP_WIDTH_MAX in mlp_int8.h
+
+
+def qparams(lo, hi):
+    """Asymmetric int8 scale / zero point covering [lo, hi] (and 0)."""
+    lo, hi = min(lo, 0.0), max(hi, 0.0)
+    scale = max(hi - lo, 1e-6) / 255.0
+    zp = int(round(-128 - lo / scale))
+    return scale, max(-128, min(127, zp))
+
+
+def q31(m):
+    """m = mult / 2^31 / 2^shift with mult in [2^30, 2^31)."""
+    if not 0 < m < 1:
+        sys.exit(f"requantisation multiplier {m} out of range")
+    shift = 0
+    while m < 0.5:
+        m *= 2
+        shift += 1
+    mult = int(round(m * (1 << 31)))
+    if mult == 1 << 31:
+        mult //= 2
+        shift -= 1
+    return mult, shift
+
+
+def requant(acc, mult, shift):
+    hi = (acc.astype(np.int64) * mult + (1 << 30)) >> 31
+    if shift > 0:
+        hi = (hi + (1 << (shift - 1))) >> shift
+    return hi
+
+
+def build(npz):
+    mean = npz["mean"].astype(np.float64)
+    std = npz["std"].astype(np.float64)
+    calib = npz["calib"].astype(np.float64)
+    Ws, bs = [], []
+    while f"W{len(Ws)}" in npz:
+        Ws.append(npz[f"W{len(Ws)}"].astype(np.float64))
+        bs.append(npz[f"b{len(bs)}"].astype(np.float64))
+
+    if len(mean) != N_FEAT or Ws[0].shape[0] != N_FEAT or Ws[-1].shape[1] != N_CLASSES:
+        sys.exit("model does not match the feature / class layout")
+    if any(W.shape[1] > WIDTH_MAX for W in Ws):
+        sys.exit(f"layer wider than {WIDTH_MAX}")
+
+    x = (calib - mean) / std
+    in_s, in_zp = qparams(np.percentile(x, 0.1), np.percentile(x, 99.9))
+
+    layers = []
+    a, s_prev, zp_prev = x, in_s, in_zp
+    for k, (W, b) in enumerate(zip(Ws, bs)):
+        last = k == len(Ws) - 1
+        a = a @ W + b
+        if not last:
+            a = np.maximum(a, 0)
+        out_s, out_zp = qparams(a.min(), a.max())
+        w_s = np.abs(W).max() / 127.0
+        Wq = np.clip(np.round(W / w_s), -127, 127).astype(np.int32)
+        bq = np.round(b / (s_prev * w_s)).astype(np.int64) - zp_prev * Wq.sum(axis=0)
+        mult, shift = q31(s_prev * w_s / out_s)
+        layers.append(dict(W=Wq, b=bq, mult=mult, shift=shift, zp=out_zp, relu=not last))
+        s_prev, zp_prev = out_s, out_zp
+
+    in_mult = np.round(65536.0 / (std * in_s)).astype(np.int64)
+    return dict(mean=np.round(mean).astype(np.int64), in_mult=in_mult, in_zp=in_zp,
+                layers=layers, out_scale=s_prev, Wf=Ws, bf=bs, fmean=mean, fstd=std)
+
+
+def run_int8(m, feats):
+    """Bit-exact model of activity_task.c + mlp_int8.c."""
+    q = ((feats.astype(np.int64) - m["mean"]) * m["in_mult"] + 0x8000 >> 16) + m["in_zp"]
+    a = np.clip(q, -128, 127)
+    for L in m["layers"]:
+        acc = a @ L["W"] + L["b"]
+        y = requant(acc, L["mult"], L["shift"]) + L["zp"]
+        a = np.clip(y, L["zp"] if L["relu"] else -128, 127)
+    return a
+
+
+def run_float(m, feats):
+    a = (feats - m["fmean"]) / m["fstd"]
+    for k, (W, b) in enumerate(zip(m["Wf"], m["bf"])):
+        a = a @ W + b
+        if k < len(m["Wf"]) - 1:
+            a = np.maximum(a, 0)
+    return a
+
+
+def c_array(ctype, name, vals, per_line=16):
+    vals = [int(v) for v in np.asarray(vals).ravel()]
+    rows = [", ".join(str(v) for v in vals[i:i + per_line])
+            for i in range(0, len(vals), per_line)]
+    return f"static const {ctype} {name}[{len(vals)}] = {{\n\t" + ",\n\t".join(rows) + ",\n};\n"
+
+
+def emit(m, model_id, source, note):
+    head = f"/* Generated by act_model_gen.py from {source}, do not edit"
+    head += f"\n * {note}\n */" if note else " */"
+    out = [head, '#include "activity_model.h"', ""]
+    for k, L in enumerate(m["layers"]):
+        out.append(c_array("int8_t", f"w{k}", L["W"].T))
+        out.append(c_array("int32_t", f"b{k}", L["b"], 8))
+
+    out.append("static const struct mlp_layer layers[] = {")
+    for k, L in enumerate(m["layers"]):
+        n_in, n_out = L["W"].shape
+        out.append(f"\t{{ .n_in = {n_in}, .n_out = {n_out}, .w = w{k}, .bias = b{k},\n"
+                   f"\t  .out_zp = {L['zp']}, .mult_q31 = {L['mult']}, .shift = {L['shift']},"
+                   f" .relu = {int(L['relu'])} }},")
+    out.append("};\n")
+
+    join = lambda v: ", ".join(str(int(x)) for x in v)
+    out.append("const struct act_model act_model = {")
+    out.append(f"\t.id = {model_id},")
+    out.append("\t.n_layers = DSP_ARRAY_LEN(layers),")
+    out.append("\t.layers = layers,")
+    out.append(f"\t.in_mean = {{ {join(m['mean'])} }},")
+    out.append(f"\t.in_mult_q16 = {{ {join(m['in_mult'])} }},")
+    out.append(f"\t.in_zp = {m['in_zp']},")
+    out.append(f"\t.out_scale_q16 = {int(round(m['out_scale'] * 65536))},")
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("npz")
+    ap.add_argument("--id", type=int, default=1)
+    ap.add_argument("--note", default="", help="one line for the file header")
+    ap.add_argument("-o", "--out", default="smartwatch_all_sensors/src/activity_model.c")
+    args = ap.parse_args()
+
+    npz = np.load(args.npz)
+    m = build(npz)
+
+    if "labels" in npz:
+        feats, y = npz["calib"], npz["labels"]
+        acc_f = (run_float(m, feats).argmax(1) == y).mean()
+        acc_q = (run_int8(m, feats).argmax(1) == y).mean()
+        print(f"accuracy float {acc_f:.3f} int8 {acc_q:.3f}")
+
+    flash = sum(L["W"].size + 4 * L["b"].size for L in m["layers"])
+    print(f"{len(m['layers'])} layers, {flash} B weights+bias")
+
+    with open(args.out, "w", encoding="utf-8") as f:
+        f.write(emit(m, args.id, args.npz.split("/")[-1], args.note))
+
+
+if __name__ == "__main__":
+    main()
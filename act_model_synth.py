@@ -0,0 +1,118 @@
+"""Train the placeholder activity MLP on synthetic per-class features.
+
+Each class draws its 12 features (activity_features.h order) from normal
+distributions picked to look like the class, a 12-24-16-5 ReLU MLP is
+trained on them with Adam, and the result is saved in the .npz layout
+act_model_gen.py reads. Seeded, so the checked-in activity_model.c is
+reproduced by
+
+    python act_model_synth.py -o synthetic.npz
+    python act_model_gen.py synthetic.npz --id 1 \\
+        --note "Placeholder: act_model_synth.py --seed 42, synthetic per-class features."
+
+Replace with a model trained on recorded data as soon as there is some.
+"""
+import argparse
+
+import numpy as np
+
+# enum act_class order; per class (mean, sd) of
+# |a| - 1 g mean, |a| std, per-axis std, gyro, cadence, steps/min, HR, gravity
+CLASSES = {
+    0: dict(mm=(40, 25), ms=(220, 70), sa=(200, 60), gy=(70, 25), cad=(105, 15), st=(105, 15),
+            hr=(95, 12), grav=((0, -800, -300), 250)),
+    1: dict(mm=(180, 70), ms=(650, 180), sa=(550, 150), gy=(220, 60), cad=(160, 15), st=(160, 15),
+            hr=(150, 15), grav=((0, -700, -200), 300)),
+    2: dict(mm=(20, 15), ms=(90, 40), sa=(80, 35), gy=(35, 15), cad=(45, 25), st=(6, 8),
+            hr=(120, 15), grav=((200, -100, -900), 250)),
+    3: dict(mm=(5, 6), ms=(20, 12), sa=(18, 10), gy=(8, 6), cad=(8, 8), st=(1, 2),
+            hr=(72, 8), grav=((0, -300, -850), 300)),
+    4: dict(mm=(2, 3), ms=(5, 4), sa=(5, 3), gy=(1.5, 1.5), cad=(1, 2), st=(0, 0.5),
+            hr=(58, 6), grav=((0, 0, 0), 700)),
+}
+OFF_WRIST = 4        # any orientation, |gravity| = 1 g
+HR_MISSING = 0.15    # share of windows without a recent HR estimate
+SIZES = [12, 24, 16, 5]
+
+
+def sample(rng, c, n):
+    d = CLASSES[c]
+    g = lambda k: rng.normal(*d[k], n)
+    sa = np.abs(rng.normal(d["sa"][0], d["sa"][1], (n, 3)) * rng.uniform(0.6, 1.4, (n, 3)))
+    gm, gs = d["grav"]
+    grav = rng.normal(gm, gs, (n, 3))
+    if c == OFF_WRIST:
+        grav = grav / np.linalg.norm(grav, axis=1, keepdims=True) * 1000
+    else:
+        grav = np.clip(grav, -1000, 1000)
+    hr = g("hr")
+    hr[rng.random(n) < HR_MISSING] = 0
+    X = np.column_stack([g("mm"), np.abs(g("ms")), sa, grav, np.abs(g("gy")), np.abs(g("cad")),
+                         np.abs(g("st")), np.maximum(hr, 0)])
+    return np.round(X)
+
+
+def train(rng, X, y, epochs, lr=3e-3, batch=128):
+    mean, std = X.mean(0), X.std(0) + 1e-6
+    Xn = (X - mean) / std
+    W = [rng.normal(0, np.sqrt(2 / a), (a, b)) for a, b in zip(SIZES, SIZES[1:])]
+    b = [np.zeros(s) for s in SIZES[1:]]
+    mW = [np.zeros_like(w) for w in W]
+    vW = [np.zeros_like(w) for w in W]
+    mb = [np.zeros_like(x) for x in b]
+    vb = [np.zeros_like(x) for x in b]
+    t = 0
+    last = len(W) - 1
+
+    for _ in range(epochs):
+        idx = rng.permutation(len(X))
+        for i in range(0, len(X), batch):
+            j = idx[i:i + batch]
+            a = [Xn[j]]
+            for k in range(len(W)):
+                z = a[-1] @ W[k] + b[k]
+                a.append(np.maximum(z, 0) if k < last else z)
+
+            # softmax cross-entropy
+            p = np.exp(a[-1] - a[-1].max(1, keepdims=True))
+            p /= p.sum(1, keepdims=True)
+            d = p
+            d[np.arange(len(j)), y[j]] -= 1
+            d /= len(j)
+
+            t += 1
+            for k in reversed(range(len(W))):
+                gW = a[k].T @ d
+                gb = d.sum(0)
+                if k > 0:
+                    d = (d @ W[k].T) * (a[k] > 0)
+                for P, G, M, V in ((W, gW, mW, vW), (b, gb, mb, vb)):
+                    M[k] = 0.9 * M[k] + 0.1 * G
+                    V[k] = 0.999 * V[k] + 0.001 * G * G
+                    P[k] -= lr * (M[k] / (1 - 0.9 ** t)) / (np.sqrt(V[k] / (1 - 0.999 ** t)) + 1e-8)
+    return mean, std, W, b
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--seed", type=int, default=42)
+    ap.add_argument("--train", type=int, default=3000, help="windows per class")
+    ap.add_argument("--calib", type=int, default=500, help="held-out windows per class")
+    ap.add_argument("--epochs", type=int, default=60)
+    ap.add_argument("-o", "--out", default="synthetic.npz")
+    args = ap.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    n_cls = len(CLASSES)
+    X = np.vstack([sample(rng, c, args.train) for c in range(n_cls)])
+    y = np.repeat(np.arange(n_cls), args.train)
+    mean, std, W, b = train(rng, X, y, args.epochs)
+
+    Xt = np.vstack([sample(rng, c, args.calib) for c in range(n_cls)])
+    yt = np.repeat(np.arange(n_cls), args.calib)
+    layers = {f"{n}{k}": v for k in range(len(W)) for n, v in (("W", W[k]), ("b", b[k]))}
+    np.savez(args.out, mean=mean, std=std, **layers, calib=Xt, labels=yt)
+
+
+if __name__ == "__main__":
+    main()
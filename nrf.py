@@ -1,10 +1,12 @@
 import sys
 import asyncio
+import binascii
+import struct
 
 from PySide6.QtWidgets import (
     QApplication, QMainWindow, QWidget, QVBoxLayout, QHBoxLayout,
     QPushButton, QLabel, QTextEdit, QListWidget, QListWidgetItem,
-    QMessageBox, QTabWidget
+    QMessageBox, QTabWidget, QFileDialog
 )
 from PySide6.QtCore import Qt
 
@@ -12,6 +14,92 @@ from qasync import QEventLoop, asyncSlot
 from bleak import BleakScanner, BleakClient
 
 LOG_NOTIFY_UUID = "9f7b0001-6c35-4d2c-9c85-4a8c1a2b3c4d"
+REC_NOTIFY_UUID = "9f7b0002-6c35-4d2c-9c85-4a8c1a2b3c4d"
+CTRL_UUID = "9f7b0003-6c35-4d2c-9c85-4a8c1a2b3c4d"
+
+# Binary records: u8 type | u8 len | u32 t_ms | payload (little endian)
+# Keep in sync with smartwatch_all_sensors/src/sensor_records.h
+REC_HDR = struct.Struct("<BBI")
+REC_FORMATS = {
+    0x01: ("HR", "<HBBHH", ("bpm_x10", "conf", "beats", "cyc", "anc_cyc")),
+    0x02: ("SPO2", "<HHBB", ("spo2_x10", "r_x1000", "conf", "beats")),
+    0x03: ("AGC", "<BBBBI", ("led", "from", "to", "reason", "dc")),
+    0x04: ("SQI", "<BBHBBH", ("led", "score", "pi_x1e4", "period", "clip_pct", "motion_mg")),
+    0x06: ("HRV", "<HHBBHHHH", ("rmssd_x10", "sdnn_x10", "pnn50", "n_ibi",
+                                "lf_ms2", "hf_ms2", "lf_hf_x100", "kcyc")),
+    0x07: ("RESP", "<HBBHHH", ("brpm_x10", "quality", "used", "am_x10", "bw_x10", "fm_x10")),
+    0x08: ("SCR", "<IHHH", ("onset_ms", "rise_ms", "amp_ns", "tonic_ns")),
+    0x09: ("EDA", "<HhBB", ("tonic_ns", "phasic_ns", "scr_per_min", "contact")),
+    0x0A: ("STRESS", "<BBBBBB", ("score", "fresh", "scr", "hrv", "hr", "temp")),
+    0x0B: ("IMU_EVT", "<BBI", ("evt", "detail", "steps")),
+    0x0C: ("CTRL_ACK", "<BbH", ("op", "err", "arg")),
+    0x0D: ("QUAT", "<hhhhhhH", ("qx", "qy", "qz", "lin_x", "lin_y", "lin_z", "age_ms")),
+    0x0E: ("TREMOR", "<HHHHBBBH", ("move_x10", "tremor_x10", "high_x10", "dom_hz_x10",
+                                   "entropy", "tremor_pct", "n_win", "kcyc")),
+    0x0F: ("FALL", "<BBHHbH", ("seq", "flags", "peak_mg", "freefall_ms", "cos_x100",
+                               "impact_age_ms")),
+    0x10: ("ALERT_TX", "<BBHH", ("type", "tries", "queue_ms", "tx_ms")),
+    0x11: ("ACTIVITY", "<BBBHHH", ("cls", "conf", "model", "infer_cyc", "arena_b", "flash_b")),
+    0x12: ("SLEEP", "<BHHHHHH", ("flags", "n", "score", "hr_x10", "hr_sd_x10", "rmssd_x10",
+                                 "night")),
+    0x13: ("WEAR", "<BBbbhH", ("worn", "votes", "prox", "eda", "temp_c10", "still_s")),
+    0x14: ("PPG_SPOT", "<BBHHHH", ("trig", "spo2", "len_s", "hr_x10", "spo2_x10", "duty_pm")),
+    0x15: ("POWER", "<HHHH", ("wake_x10", "duty_x100", "batch_ms", "win_s")),
+    0x16: ("TEMP_ALERT", "<Bhh", ("evt", "temp_c10", "thresh_c10")),
+    0x18: ("SUBS", "<BBII", ("sub", "sensors", "wanted", "chans")),
+}
+
+# Send-on-delta records (slow_report.h): hold each value until the channel's
+# next record; a seq gap is lost data, not a flat signal
+REC_SLOW = 0x17
+SLOW_FMT = "<BBBHi"          # ch, kind (0 moved, 1 heartbeat), seq, delta, value
+SLOW_CHANNELS = {0: ("temp", "mC"), 1: ("eda", "uV")}
+
+# Subscribers (SUBS "sub", CTRL_SUBSCRIBE last byte, default 0)
+SUBSCRIBERS = ("ble", "nand", "algo")
+
+# Subscribable channels (chan_sub.h), bit n of the SUBS masks
+CHANNELS = ("log", "hr", "spo2", "hrv", "resp", "ppg_diag", "eda", "temp", "imu_evt",
+            "quat", "tremor", "fall", "activity", "stress", "sleep", "wear", "power")
+
+# Records on the firmware's high-priority alert path (alert_task.h)
+REC_ALERTS = (0x0F, 0x10)
+
+# Variable-length records: fixed head followed by an array of one item type
+REC_ARRAYS = {
+    0x05: ("IBI", "<I", ("t_last_ms",), "<H", "ibi_ms"),
+}
+
+
+# Control writes (CTRL_UUID): u8 op | args, see sensor_records.h
+CTRL_FSM_BEGIN = 0x10
+CTRL_FSM_DATA = 0x11
+CTRL_FSM_COMMIT = 0x12
+CTRL_FSM_CLEAR = 0x13
+CTRL_FUSION_RATE = 0x20
+CTRL_SPECTRAL = 0x21         # u8 mode: 0 off, 1 = 416 Hz, 2 = 833 Hz, 3 = 1666 Hz
+CTRL_PPG_SCHED = 0x22        # "<BBBHHH": op, mode (0 continuous, 1 spot), flags, period_s, len_s, quiet_wait_s
+CTRL_PPG_MEASURE = 0x23      # "<BH": op, seconds
+CTRL_TEMP_CFG = 0x24         # "<BHhh": op, interval_s, low_c10, high_c10 (ALERT above high until below low)
+CTRL_SLOW_CFG = 0x25         # "<BBHH": op, channel, delta, heartbeat_s
+CTRL_SUBSCRIBE = 0x26        # "<BBBHB": op, channel (0xFF all), on, period_ms (0 default), subscriber
+CTRL_SUBS_QUERY = 0x27       # op only: answered with one SUBS record per subscriber
+FSM_OP_WAIT = 0xFF
+FSM_PAIRS_PER_WRITE = 8      # 3 + 16 bytes fits the default 20-byte ATT payload
+
+
+def parse_ucf(text: str) -> bytes:
+    """ST .ucf register sequence -> reg/val pairs ("WAIT n" -> FSM_OP_WAIT n)."""
+    pairs = bytearray()
+    for line in text.splitlines():
+        tok = line.split()
+        if not tok or tok[0].startswith("--"):
+            continue
+        if tok[0].upper() == "WAIT":
+            pairs += bytes((FSM_OP_WAIT, min(int(tok[1]), 255)))
+        elif tok[0] == "Ac" and len(tok) >= 3:
+            pairs += bytes((int(tok[1], 16), int(tok[2], 16)))
+    return bytes(pairs)
 
 
 class MainWindow(QMainWindow):
@@ -26,6 +114,9 @@ class MainWindow(QMainWindow):
         # Buffer to reassemble fragmented notifications into full lines
         self._rx_buf = ""
 
+        # Next expected REC_SLOW seq per channel
+        self._slow_seq = {}
+
         # -------- Widgets --------
         self.device_list = QListWidget()
 
@@ -33,6 +124,8 @@ class MainWindow(QMainWindow):
         self.connect_btn = QPushButton("Connect")
         self.disconnect_btn = QPushButton("Disconnect")
         self.clear_btn = QPushButton("Clear Current Tab")
+        self.fsm_btn = QPushButton("Load FSM (.ucf)")
+        self.fsm_clear_btn = QPushButton("Clear FSM")
 
         self.status_lbl = QLabel("Status: Idle")
 
@@ -58,6 +151,11 @@ class MainWindow(QMainWindow):
 
         left.addLayout(btn_row)
         left.addWidget(self.clear_btn)
+
+        fsm_row = QHBoxLayout()
+        fsm_row.addWidget(self.fsm_btn)
+        fsm_row.addWidget(self.fsm_clear_btn)
+        left.addLayout(fsm_row)
         left.addWidget(self.status_lbl)
         main.addLayout(left, 3)
 
@@ -74,6 +172,8 @@ class MainWindow(QMainWindow):
         self.connect_btn.clicked.connect(self.on_connect)
         self.disconnect_btn.clicked.connect(self.on_disconnect)
         self.clear_btn.clicked.connect(self.on_clear_current_tab)
+        self.fsm_btn.clicked.connect(self.on_fsm_load)
+        self.fsm_clear_btn.clicked.connect(self.on_fsm_clear)
 
     # -------- Tab helpers --------
     def _ensure_tab(self, name: str) -> QTextEdit:
@@ -163,6 +263,99 @@ class MainWindow(QMainWindow):
             # Append to module tab
             self._append(module, line)
 
+    # -------- Binary records (one record per notification) --------
+    def decode_record(self, data: bytes) -> str:
+        if len(data) < REC_HDR.size:
+            return f"short record: {data.hex()}"
+
+        rtype, rlen, t_ms = REC_HDR.unpack_from(data)
+        payload = data[REC_HDR.size:REC_HDR.size + rlen]
+
+        arr = REC_ARRAYS.get(rtype)
+        if arr is not None:
+            name, head, fields, item, items = arr
+            hsz, isz = struct.calcsize(head), struct.calcsize(item)
+            if len(payload) >= hsz and (len(payload) - hsz) % isz == 0:
+                values = struct.unpack_from(head, payload)
+                body = " ".join(f"{k}={v}" for k, v in zip(fields, values))
+                tail = [v for (v,) in struct.iter_unpack(item, payload[hsz:])]
+                return f"{name} t={t_ms}ms {body} {items}={tail}"
+
+        if rtype == REC_SLOW and len(payload) == struct.calcsize(SLOW_FMT):
+            return self.decode_slow(t_ms, payload)
+
+        fmt = REC_FORMATS.get(rtype)
+        if fmt is None or struct.calcsize(fmt[1]) != len(payload):
+            return f"REC 0x{rtype:02X} t={t_ms}ms raw={payload.hex()}"
+
+        name, layout, fields = fmt
+        values = struct.unpack(layout, payload)
+        body = " ".join(f"{k}={v}" for k, v in zip(fields, values))
+        return f"{name} t={t_ms}ms {body}"
+
+    def decode_slow(self, t_ms: int, payload: bytes) -> str:
+        ch, kind, seq, delta, value = struct.unpack(SLOW_FMT, payload)
+        name, unit = SLOW_CHANNELS.get(ch, (f"ch{ch}", ""))
+        expect = self._slow_seq.get(ch)
+        self._slow_seq[ch] = (seq + 1) & 0xFF
+
+        gap = ""
+        if expect is not None and seq != expect:
+            gap = f" [{(seq - expect) & 0xFF} lost]"
+        what = "unchanged" if kind == 1 else "moved"
+        return f"SLOW t={t_ms}ms {name}={value} {unit} +/-{delta} ({what}) seq={seq}{gap}"
+
+    def on_record(self, sender: int, data: bytearray):
+        line = self.decode_record(bytes(data))
+        self._append("All", line)
+        self._append("Records", line)
+        if data and data[0] in REC_ALERTS:
+            self._append("Alerts", line)
+
+    # -------- LSM6DSO FSM programs (result arrives as a CTRL_ACK record) --------
+    @asyncSlot()
+    async def on_fsm_load(self):
+        if not self.client:
+            QMessageBox.warning(self, "Not connected", "Connect to the device first.")
+            return
+
+        path, _ = QFileDialog.getOpenFileName(self, "FSM program", "", "UCF (*.ucf);;All (*)")
+        if not path:
+            return
+
+        with open(path, "r", encoding="utf-8", errors="replace") as f:
+            pairs = parse_ucf(f.read())
+        n = len(pairs) // 2
+        if n == 0:
+            QMessageBox.warning(self, "FSM", "No register writes found in file.")
+            return
+
+        try:
+            await self.client.write_gatt_char(
+                CTRL_UUID, struct.pack("<BH", CTRL_FSM_BEGIN, n), response=True)
+            step = FSM_PAIRS_PER_WRITE
+            for i in range(0, n, step):
+                chunk = pairs[2 * i:2 * (i + step)]
+                await self.client.write_gatt_char(
+                    CTRL_UUID, struct.pack("<BH", CTRL_FSM_DATA, i) + chunk, response=True)
+            crc = binascii.crc_hqx(pairs, 0xFFFF)
+            await self.client.write_gatt_char(
+                CTRL_UUID, struct.pack("<BH", CTRL_FSM_COMMIT, crc), response=True)
+        except Exception as e:
+            QMessageBox.critical(self, "FSM upload failed", str(e))
+            return
+
+        self._append("All", f"FSM program sent: {n} ops, crc=0x{crc:04X}")
+
+    @asyncSlot()
+    async def on_fsm_clear(self):
+        if not self.client:
+            return
+        try:
+            await self.client.write_gatt_char(CTRL_UUID, bytes((CTRL_FSM_CLEAR,)), response=True)
+        except Exception as e:
+            QMessageBox.critical(self, "FSM clear failed", str(e))
+
     # -------- BLE Connect --------
     @asyncSlot()
     async def on_connect(self):
@@ -177,6 +370,7 @@ class MainWindow(QMainWindow):
             await self.on_disconnect()
 
         self._rx_buf = ""
+        self._slow_seq = {}
 
         self.set_status(f"Connecting to {address} ...")
         self._append("All", f"Connecting to {address} ...")
@@ -234,6 +428,13 @@ class MainWindow(QMainWindow):
             await self.on_disconnect()
             return
 
+        # Record stream is optional (older firmware only has the log stream)
+        try:
+            await self.client.start_notify(REC_NOTIFY_UUID, self.on_record)
+            self._append("All", f"Starting notify on: {REC_NOTIFY_UUID}")
+        except Exception:
+            self._append("All", "Record characteristic not available.")
+
         self.set_status("Streaming logs")
         self._append("All", "✅ Notifications enabled. Waiting for logs...")
 
@@ -242,10 +443,11 @@ class MainWindow(QMainWindow):
     async def on_disconnect(self):
         if self.client:
             try:
-                try:
-                    await self.client.stop_notify(LOG_NOTIFY_UUID)
-                except Exception:
-                    pass
+                for uuid in (LOG_NOTIFY_UUID, REC_NOTIFY_UUID):
+                    try:
+                        await self.client.stop_notify(uuid)
+                    except Exception:
+                        pass
                 await self.client.disconnect()
             except Exception:
                 pass
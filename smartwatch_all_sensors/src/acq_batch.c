@@ -0,0 +1,125 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#include "acq_batch.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "sensor_records.h"
+
+LOG_MODULE_REGISTER(acq_batch, LOG_LEVEL_INF);
+
+#define ACQ_STATS_BATCHES  40     /* 10 s */
+
+static int64_t boundary(uint32_t n)
+{
+	int64_t now = k_uptime_get();
+
+	return (now / ACQ_BATCH_MS + n) * ACQ_BATCH_MS;
+}
+
+k_timeout_t acq_batch_timeout(uint32_t n)
+{
+	return K_TIMEOUT_ABS_MS(boundary(n));
+}
+
+void acq_batch_sleep(uint32_t n)
+{
+	(void)k_sleep(acq_batch_timeout(n));
+}
+
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL) && defined(CONFIG_SCHED_THREAD_USAGE_ANALYSIS)
+
+/* CPU duty from the kernel's runtime stats; wakeups are the idle thread's
+ * scheduling windows (total / average), one per return from sleep
+ */
+static struct k_thread *idle;
+static uint64_t prev_busy, prev_all, prev_windows;
+static int64_t prev_ms;
+
+static void find_idle(const struct k_thread *t, void *user)
+{
+	ARG_UNUSED(user);
+
+	const char *name = k_thread_name_get((k_tid_t)t);
+
+	if (name && strcmp(name, "idle") == 0) {
+		idle = (struct k_thread *)t;
+	}
+}
+
+static uint64_t idle_windows(void)
+{
+	k_thread_runtime_stats_t st;
+
+	if (!idle || k_thread_runtime_stats_get(idle, &st) || st.average_cycles == 0) {
+		return 0;
+	}
+	return st.total_cycles / st.average_cycles;
+}
+
+static void stats_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(stats_work, stats_work_fn);
+
+static void stats_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	k_thread_runtime_stats_t all;
+	int64_t now = k_uptime_get();
+	uint64_t windows = idle_windows();
+
+	(void)k_thread_runtime_stats_all_get(&all);
+
+	uint64_t d_busy = all.total_cycles - prev_busy;
+	uint64_t d_all = all.execution_cycles - prev_all;
+	uint64_t d_wk = windows - prev_windows;
+	uint32_t d_ms = (uint32_t)(now - prev_ms);
+
+	prev_busy = all.total_cycles;
+	prev_all = all.execution_cycles;
+	prev_windows = windows;
+	prev_ms = now;
+
+	struct rec_power rec = {
+		.wake_x10 = (uint16_t)MIN(d_ms ? d_wk * 10000 / d_ms : 0, UINT16_MAX),
+		.duty_x100 = (uint16_t)(d_all ? d_busy * 10000 / d_all : 0),
+		.batch_ms = ACQ_BATCH_MS,
+		.win_s = (uint16_t)(d_ms / 1000),
+	};
+	if (chan_sub_wanted(CHAN_POWER)) {
+		(void)ble_rec_send(REC_POWER, &rec, sizeof(rec));
+
+		LOG_INF("CPU wakeups %u.%u/s, duty %u.%02u%% (batch %u ms)",
+			rec.wake_x10 / 10, rec.wake_x10 % 10, rec.duty_x100 / 100,
+			rec.duty_x100 % 100, ACQ_BATCH_MS);
+	}
+
+	k_work_schedule(&stats_work, acq_batch_timeout(ACQ_STATS_BATCHES));
+}
+
+void acq_batch_stats_start(void)
+{
+	k_thread_runtime_stats_t all;
+
+	k_thread_foreach(find_idle, NULL);
+	if (!idle) {
+		LOG_WRN("Idle thread not found: no wakeup count");
+	}
+
+	(void)k_thread_runtime_stats_all_get(&all);
+	prev_busy = all.total_cycles;
+	prev_all = all.execution_cycles;
+	prev_windows = idle_windows();
+	prev_ms = k_uptime_get();
+	k_work_schedule(&stats_work, acq_batch_timeout(ACQ_STATS_BATCHES));
+}
+
+#else
+
+void acq_batch_stats_start(void)
+{
+}
+
+#endif
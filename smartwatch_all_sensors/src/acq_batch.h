@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+/* Shared batch clock for the sensor tasks. Every periodic wait ends on a
+ * multiple of ACQ_BATCH_MS of uptime, so all FIFOs (MAX30101, LSM6DSO),
+ * the ADS1113 conversion register and the AS6221 are read in one CPU
+ * wakeup per batch. FIFO depths bound the period: 32 PPG frames at
+ * 100 sps (320 ms), one EDA sample at 4 Hz.
+ */
+#define ACQ_BATCH_MS    250
+
+/* Absolute timeout at the n-th batch boundary from now (n >= 1) */
+k_timeout_t acq_batch_timeout(uint32_t n);
+
+/* Sleep until the n-th batch boundary */
+void acq_batch_sleep(uint32_t n);
+
+/* Report CPU wakeups per second and duty cycle as REC_POWER */
+void acq_batch_stats_start(void);
@@ -0,0 +1,8 @@
+#pragma once
+
+/* Owners of a sensor task's low-rate request (*_set_low_rate()). Requests
+ * from different owners combine; a sensor is back at its normal rate once
+ * no owner holds one.
+ */
+#define ACQ_LOW_SLEEP     0x01    /* sleep_task.c */
+#define ACQ_LOW_OFFWRIST  0x02    /* offwrist_task.c */
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "activity_features.h"
+
+#define ACT_MIN_SAMPLES   64
+#define ACT_XING_EMA_SH   6       /* ~0.6 s at 104 Hz: below the step period */
+
+void act_feat_init(struct act_feat_acc *f)
+{
+	memset(f, 0, sizeof(*f));
+	f->mag_avg = (struct dsp_ema)DSP_EMA_INIT(ACT_XING_EMA_SH);
+}
+
+void act_feat_reset(struct act_feat_acc *f)
+{
+	struct dsp_ema avg = f->mag_avg;
+	bool above = f->above;
+
+	memset(f, 0, sizeof(*f));
+	f->mag_avg = avg;
+	f->above = above;
+}
+
+static uint32_t norm3(const int32_t v[3])
+{
+	return dsp_isqrt64((int64_t)v[0] * v[0] + (int64_t)v[1] * v[1] +
+			   (int64_t)v[2] * v[2]);
+}
+
+void act_feat_push(struct act_feat_acc *f, const int32_t a_mg[3], const int32_t g_mdps[3])
+{
+	int32_t mag = (int32_t)norm3(a_mg);
+
+	for (int i = 0; i < 3; i++) {
+		f->sum[i] += a_mg[i];
+		f->sumsq[i] += (int64_t)a_mg[i] * a_mg[i];
+	}
+	f->sum_mag += mag;
+	f->sumsq_mag += (int64_t)mag * mag;
+	f->sum_gyro_mdps += norm3(g_mdps);
+	f->n++;
+
+	int32_t ref = dsp_ema_step(&f->mag_avg, mag);
+
+	if (!f->above && mag > ref + ACT_XING_HYST_MG) {
+		f->above = true;
+		f->xings++;
+	} else if (f->above && mag < ref - ACT_XING_HYST_MG) {
+		f->above = false;
+	}
+}
+
+static int32_t stdev(int64_t sum, int64_t sumsq, uint32_t n)
+{
+	int64_t var = (sumsq * n - sum * sum) / ((int64_t)n * n);
+
+	return (int32_t)dsp_isqrt64((var > 0) ? (uint64_t)var : 0);
+}
+
+bool act_feat_get(const struct act_feat_acc *f, uint32_t win_ms, uint32_t steps,
+		  uint16_t hr_bpm, int32_t out[ACT_N_FEAT])
+{
+	uint32_t n = f->n;
+
+	if (n < ACT_MIN_SAMPLES || win_ms == 0) {
+		return false;
+	}
+
+	out[ACT_F_MAG_MEAN] = (int32_t)(f->sum_mag / n) - 1000;
+	out[ACT_F_MAG_STD] = stdev(f->sum_mag, f->sumsq_mag, n);
+	for (int i = 0; i < 3; i++) {
+		out[ACT_F_STD_X + i] = stdev(f->sum[i], f->sumsq[i], n);
+		out[ACT_F_GRAV_X + i] = (int32_t)(f->sum[i] / n);
+	}
+	out[ACT_F_GYRO] = (int32_t)(f->sum_gyro_mdps / n / 1000);
+	out[ACT_F_CADENCE] = (int32_t)((uint64_t)f->xings * 60000 / win_ms);
+	out[ACT_F_STEPS] = (int32_t)((uint64_t)steps * 60000 / win_ms);
+	out[ACT_F_HR] = hr_bpm;
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Per-window features for activity recognition, from the 104 Hz accel/gyro
+ * pairs plus the pedometer and the heart rate. Integer units as listed; the
+ * model (activity_model.h) owns the normalisation and quantisation, so a new
+ * model only has to agree on this list, not on any scaling.
+ */
+enum act_feat {
+	ACT_F_MAG_MEAN = 0,   /* mean |a| - 1 g, mg */
+	ACT_F_MAG_STD,        /* mg */
+	ACT_F_STD_X,          /* per-axis standard deviation, mg */
+	ACT_F_STD_Y,
+	ACT_F_STD_Z,
+	ACT_F_GRAV_X,         /* per-axis mean (wrist orientation), mg */
+	ACT_F_GRAV_Y,
+	ACT_F_GRAV_Z,
+	ACT_F_GYRO,           /* mean |w|, dps */
+	ACT_F_CADENCE,        /* upward |a| crossings of its running mean, per min */
+	ACT_F_STEPS,          /* pedometer steps per min */
+	ACT_F_HR,             /* bpm, 0 = no recent estimate */
+	ACT_N_FEAT,
+};
+
+#define ACT_XING_HYST_MG  40
+
+struct act_feat_acc {
+	uint32_t n;
+	int64_t  sum[3];
+	int64_t  sumsq[3];
+	int64_t  sum_mag;
+	int64_t  sumsq_mag;
+	int64_t  sum_gyro_mdps;
+	struct dsp_ema mag_avg;   /* crossing reference, persists across windows */
+	bool     above;
+	uint32_t xings;
+};
+
+void act_feat_init(struct act_feat_acc *f);
+
+/* Start a new window (keeps the crossing reference) */
+void act_feat_reset(struct act_feat_acc *f);
+
+void act_feat_push(struct act_feat_acc *f, const int32_t a_mg[3], const int32_t g_mdps[3]);
+
+/* Features of the window so far; false if it holds too few samples */
+bool act_feat_get(const struct act_feat_acc *f, uint32_t win_ms, uint32_t steps,
+		  uint16_t hr_bpm, int32_t out[ACT_N_FEAT]);
@@ -0,0 +1,94 @@
+/* Generated by act_model_gen.py from synthetic.npz, do not edit
+ * Placeholder: act_model_synth.py --seed 42, synthetic per-class features.
+ */
+#include "activity_model.h"
+
+static const int8_t w0[288] = {
+	12, 10, 14, 68, 1, -1, -13, -102, 39, -20, 27, 6, -22, 10, 11, 52,
+	20, 3, -4, -8, 51, -3, 5, -87, 7, 10, 44, -36, -34, 9, 36, 34,
+	1, 40, -56, 4, 25, -21, 24, 1, -36, 20, 13, 60, 13, 44, 67, -3,
+	26, -13, -17, -40, -58, -89, -8, -14, 19, 26, 17, 2, 6, 45, -26, 27,
+	-40, -42, 39, -10, -20, -3, 9, 8, 54, 23, -4, -7, 27, -11, 6, -13,
+	50, -4, -80, 29, 13, -96, -76, -24, -32, 0, -26, 7, -20, -27, -13, -21,
+	-33, 48, -17, -2, 6, 8, 14, 10, 20, -7, -34, 119, -10, -39, -22, -8,
+	-8, 15, 16, -50, 40, -14, -62, 36, 3, -69, -55, -50, -75, 15, 34, -7,
+	-17, -40, 5, 24, 21, 22, -18, -15, 1, 11, 24, -92, -12, 40, -65, -14,
+	4, -13, -46, -31, 20, -36, -127, -20, -33, 38, 20, 24, 32, -31, -18, 32,
+	20, -48, 37, 59, 16, -15, 1, 52, 28, 11, -13, 0, 8, 16, 60, -60,
+	8, -7, -48, 33, 20, -22, 27, 7, -26, 79, -10, 10, 0, -4, 43, -31,
+	-34, 31, -19, 1, -33, -16, -19, -13, -23, -6, 14, 56, -42, -41, -6, 36,
+	23, 11, -20, 61, -44, 40, -10, 4, 26, -11, 20, 26, 45, 28, 26, 1,
+	34, 85, 13, -16, -13, 12, -14, -20, -53, 3, 17, 18, -15, -54, 46, -34,
+	13, 28, 19, 23, 4, 15, -41, 24, 53, 1, 44, 4, -18, 60, -5, -3,
+	-41, 23, 44, 50, -14, 10, 5, 18, -39, -27, -34, -61, -24, 3, -29, 3,
+	-53, -74, -22, -14, 30, 23, 39, 31, 42, 20, -29, -19, 6, 19, 39, 9,
+};
+
+static const int32_t b0[24] = {
+	2008, 3851, 3188, 9265, -5748, -1584, 6305, -11483,
+	6661, -570, -10105, -3381, -3813, 3361, 228, 4836,
+	639, 3300, 7311, -5354, 3812, 3115, -12733, 6025,
+};
+
+static const int8_t w1[384] = {
+	1, -36, -26, 8, 17, 36, -62, 18, 24, 33, 22, 32, 36, 21, 13, 12,
+	-29, -10, 6, 37, -14, 24, 46, -35, 6, -46, -25, 21, 18, 4, -35, 38,
+	-22, -8, 48, -4, 14, -8, 24, 37, -13, -12, -10, 1, -10, 27, 34, 2,
+	-12, -4, -55, 23, 27, 9, -18, 10, 12, -44, 13, -22, 34, 9, -6, 52,
+	25, 33, -15, 10, -37, 21, 1, -10, -12, 14, 1, -77, -6, -28, 28, 20,
+	-13, -5, -5, 9, -33, -11, -10, -23, 7, 28, -15, 3, 11, 20, 23, -21,
+	17, 47, -14, 19, -5, 14, 29, -51, 50, -66, 2, -16, 19, 8, -11, 30,
+	27, -23, 46, 23, -4, 9, -49, 38, -6, 24, 31, -33, -43, 6, 122, -7,
+	59, 37, -26, 4, -50, -22, 3, -18, 22, 16, 6, -3, 28, -2, 10, -19,
+	4, 38, 6, 13, 3, 6, -3, -24, 73, -21, -6, -23, 12, -16, 26, 15,
+	22, -5, 49, 0, 19, 16, -10, 57, -16, 7, 27, 5, 38, -45, -1, 6,
+	-67, 23, 27, -38, 5, -27, -16, -19, 27, 35, 9, -20, 8, -39, 16, 27,
+	-7, 27, 51, -7, 3, -29, 61, -1, 31, 15, -19, 12, -32, -8, -27, -32,
+	43, 33, -9, -43, -2, -15, 18, 20, 5, 1, 11, 9, 15, 3, -2, -19,
+	23, -22, 12, -5, 12, 7, -14, -3, -24, -39, 29, 12, 35, 49, -1, 50,
+	17, -58, -21, 1, 27, 21, -32, 14, -79, 7, 58, 34, -6, 11, 6, 21,
+	3, -69, -14, 19, -28, 47, 21, 8, 84, 78, 3, 25, 4, 15, 99, -42,
+	33, 30, -82, 17, 42, 13, 26, 53, 7, 15, -15, -39, -54, -4, -43, -12,
+	29, 62, 41, 28, 14, -24, 85, -31, 52, 29, -14, -10, 15, -36, -19, 18,
+	16, 22, 10, -51, -9, -31, -24, 28, 20, 0, -68, -11, 5, -9, 2, -2,
+	-9, -13, -10, 27, 16, 17, -30, -22, 5, -32, 36, 29, 42, 43, 29, 34,
+	-18, 56, -3, -48, 19, -37, 17, 5, -57, -13, -41, 31, -18, -127, -13, 28,
+	-46, 20, 13, 18, 56, 16, 8, 13, 4, -71, -13, 10, 29, 25, -72, 52,
+	-55, 13, 64, 18, 6, 17, -8, -23, -2, 11, 1, 18, -47, 20, 32, 14,
+};
+
+static const int32_t b1[16] = {
+	21472, 9718, 7120, -11792, 17877, 18732, 31940, -3100,
+	11354, 17591, -64, 33696, 27257, 11998, -15051, 4491,
+};
+
+static const int8_t w2[80] = {
+	-58, -11, 31, -16, 5, -11, 4, 9, -3, -31, 10, 41, 30, -16, -12, -27,
+	-21, -25, -12, 3, 8, -12, 32, -4, 3, 27, -6, 7, 8, 24, 13, -14,
+	1, -24, -10, -14, -61, 26, -18, -21, 23, -20, -88, 45, 22, 4, 37, -80,
+	-1, -7, -28, 13, 10, -1, -26, 21, 22, -22, -22, 36, 13, -28, 6, -2,
+	28, 25, 28, -13, -11, -17, -12, 6, -30, -9, 40, -127, -65, 8, -14, 16,
+};
+
+static const int32_t b2[5] = {
+	-6857, 3877, -22666, -1961, -18993,
+};
+
+static const struct mlp_layer layers[] = {
+	{ .n_in = 12, .n_out = 24, .w = w0, .bias = b0,
+	  .out_zp = -128, .mult_q31 = 1367344264, .shift = 6, .relu = 1 },
+	{ .n_in = 24, .n_out = 16, .w = w1, .bias = b1,
+	  .out_zp = -128, .mult_q31 = 1647475384, .shift = 7, .relu = 1 },
+	{ .n_in = 16, .n_out = 5, .w = w2, .bias = b2,
+	  .out_zp = 59, .mult_q31 = 1825454071, .shift = 8, .relu = 0 },
+};
+
+const struct act_model act_model = {
+	.id = 1,
+	.n_layers = DSP_ARRAY_LEN(layers),
+	.layers = layers,
+	.in_mean = { 49, 197, 171, 171, 170, 41, -363, -427, 67, 64, 55, 85 },
+	.in_mult_q16 = { 34666, 10243, 11602, 11521, 11675, 7110, 5610, 5496, 30332, 42068, 39218, 54199 },
+	.in_zp = -29,
+	.out_scale_q16 = 76086,
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+#include "activity_features.h"
+#include "mlp_int8.h"
+
+/* Activity classifier model. The feature vector (activity_features.h) is
+ * normalised and quantised per feature,
+ *   q = round((f - in_mean) * in_mult_q16 / 2^16) + in_zp
+ * where in_mult = 1 / (std * input scale), then run through an int8 MLP
+ * whose last layer has one logit per class in enum act_class order.
+ * Models are generated by act_model_gen.py; the firmware links exactly one
+ * definition of act_model.
+ */
+enum act_class {
+	ACT_WALK = 0,
+	ACT_RUN,
+	ACT_CYCLE,
+	ACT_SIT,
+	ACT_SLEEP,
+	ACT_N_CLASSES,
+};
+
+struct act_model {
+	uint8_t  id;                        /* reported in REC_ACTIVITY */
+	uint8_t  n_layers;
+	const struct mlp_layer *layers;
+	int32_t  in_mean[ACT_N_FEAT];       /* feature units */
+	int32_t  in_mult_q16[ACT_N_FEAT];
+	int8_t   in_zp;
+	int32_t  out_scale_q16;             /* logit per output LSB, for the softmax */
+};
+
+extern const struct act_model act_model;
@@ -0,0 +1,201 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "acq_batch.h"
+#include "activity_features.h"
+#include "activity_model.h"
+#include "activity_task.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "dsp_cycles.h"
+#include "mlp_int8.h"
+#include "sensor_records.h"
+
+LOG_MODULE_REGISTER(activity, LOG_LEVEL_INF);
+
+#define ACT_HR_MAX_AGE_MS  10000
+#define ACT_LOG2E_Q16      94548
+#define ACT_CPU_MHZ        64
+
+static const char *const class_name[ACT_N_CLASSES] = {
+	"walk", "run", "cycle", "sit", "sleep",
+};
+
+static struct act_feat_acc acc;
+static uint32_t steps_now;
+static uint16_t hr_bpm_x10;
+static uint32_t hr_ms;
+static struct k_spinlock lock;
+
+/* Inference working memory: quantised input + activation ping-pong */
+static int8_t act_in[ACT_N_FEAT];
+static int8_t act_arena[MLP_ARENA_SIZE];
+
+void activity_post_imu(const int32_t a_mg[3], const int32_t g_mdps[3])
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	act_feat_push(&acc, a_mg, g_mdps);
+	k_spin_unlock(&lock, key);
+}
+
+void activity_post_steps(uint32_t steps_total)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	steps_now = steps_total;
+	k_spin_unlock(&lock, key);
+}
+
+void activity_post_hr(uint16_t bpm_x10)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	hr_bpm_x10 = bpm_x10;
+	hr_ms = k_uptime_get_32();
+	k_spin_unlock(&lock, key);
+}
+
+static void quantise(const int32_t f[ACT_N_FEAT], int8_t q[ACT_N_FEAT])
+{
+	for (int i = 0; i < ACT_N_FEAT; i++) {
+		int64_t v = (int64_t)(f[i] - act_model.in_mean[i]) * act_model.in_mult_q16[i];
+		int32_t y = (int32_t)((v + 0x8000) >> 16) + act_model.in_zp;
+
+		q[i] = (int8_t)CLAMP(y, INT8_MIN, INT8_MAX);
+	}
+}
+
+/* e^-x for x >= 0, Q16 in and out: 2^-(x log2 e), least-squares cubic for the fraction */
+static uint32_t exp_neg_q16(uint32_t x)
+{
+	uint64_t y = ((uint64_t)x * ACT_LOG2E_Q16) >> 16;
+	uint32_t k = (uint32_t)(y >> 16);
+	int64_t f = (int64_t)(y & 0xFFFF);
+
+	if (k >= 17) {
+		return 0;
+	}
+
+	int64_t p = 65536 - ((45340 * f) >> 16) + ((15212 * f * f) >> 32) -
+		    ((2647 * f * f * f) >> 48);
+
+	return (uint32_t)(p >> k);
+}
+
+/* Arg-max class and its softmax probability in % */
+static uint8_t classify(const int8_t *logit, uint8_t *conf)
+{
+	uint8_t best = 0;
+
+	for (uint8_t c = 1; c < ACT_N_CLASSES; c++) {
+		if (logit[c] > logit[best]) {
+			best = c;
+		}
+	}
+
+	uint32_t sum = 0;
+
+	for (uint8_t c = 0; c < ACT_N_CLASSES; c++) {
+		uint32_t d = (uint32_t)(logit[best] - logit[c]);
+
+		sum += exp_neg_q16(d * (uint32_t)act_model.out_scale_q16);
+	}
+	*conf = (uint8_t)((100u * 65536u) / sum);
+	return best;
+}
+
+static void activity_thread(void *a, void *b, void *c)
+{
+	ARG_UNUSED(a);
+	ARG_UNUSED(b);
+	ARG_UNUSED(c);
+
+	uint16_t arena_b = sizeof(act_in) + sizeof(act_arena);
+	uint16_t flash_b = (uint16_t)MIN(mlp_int8_size(act_model.layers, act_model.n_layers) +
+					 sizeof(act_model), UINT16_MAX);
+	uint32_t steps_prev = 0;
+	uint32_t t_prev = k_uptime_get_32();
+
+	LOG_INF("Activity model %u: %u layers, %u B weights, %u B arena",
+		act_model.id, act_model.n_layers, flash_b, arena_b);
+
+	while (1) {
+		acq_batch_sleep(ACT_WIN_MS / ACQ_BATCH_MS);
+
+		struct act_feat_acc win;
+		uint32_t now = k_uptime_get_32();
+		k_spinlock_key_t key = k_spin_lock(&lock);
+
+		win = acc;
+		act_feat_reset(&acc);
+		uint32_t steps = steps_now;
+		uint16_t hr = ((now - hr_ms) <= ACT_HR_MAX_AGE_MS) ? hr_bpm_x10 / 10 : 0;
+
+		k_spin_unlock(&lock, key);
+
+		uint32_t c0 = dsp_cyc_now();
+		int32_t feat[ACT_N_FEAT];
+		bool ok = act_feat_get(&win, now - t_prev, steps - steps_prev, hr, feat);
+
+		t_prev = now;
+		steps_prev = steps;
+		if (!ok || !chan_sub_wanted(CHAN_ACTIVITY)) {
+			continue;
+		}
+
+		quantise(feat, act_in);
+
+		const int8_t *logit = mlp_int8_run(act_model.layers, act_model.n_layers,
+						   act_in, act_arena);
+		if (!logit) {
+			LOG_ERR("Model %u does not fit the kernel", act_model.id);
+			return;
+		}
+
+		uint8_t conf;
+		uint8_t cls = classify(logit, &conf);
+		uint32_t cyc = dsp_cyc_now() - c0;
+
+		struct rec_activity rec = {
+			.cls = cls,
+			.conf = conf,
+			.model = act_model.id,
+			.infer_cyc = (uint16_t)MIN(cyc, UINT16_MAX),
+			.arena_b = arena_b,
+			.flash_b = flash_b,
+		};
+		(void)ble_rec_send(REC_ACTIVITY, &rec, sizeof(rec));
+
+		LOG_INF("ACT %s conf=%u%% | %u cyc (%u us) | mag=%d sd=%d gyro=%d cad=%d steps=%d hr=%d",
+			class_name[cls], conf, cyc, cyc / ACT_CPU_MHZ,
+			feat[ACT_F_MAG_MEAN], feat[ACT_F_MAG_STD], feat[ACT_F_GYRO],
+			feat[ACT_F_CADENCE], feat[ACT_F_STEPS], feat[ACT_F_HR]);
+	}
+}
+
+/* thread objects */
+#define ACTIVITY_STACK_SIZE 1536
+#define ACTIVITY_PRIORITY   6
+
+K_THREAD_STACK_DEFINE(activity_stack, ACTIVITY_STACK_SIZE);
+static struct k_thread activity_tcb;
+static bool started;
+
+void activity_task_start(void)
+{
+	if (started) {
+		return;
+	}
+	started = true;
+
+	act_feat_init(&acc);
+	dsp_cyc_init();
+
+	k_thread_create(&activity_tcb, activity_stack, K_THREAD_STACK_SIZEOF(activity_stack),
+			activity_thread, NULL, NULL, NULL,
+			ACTIVITY_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(&activity_tcb, "activity_task");
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+/* Activity recognition: features over ACT_WIN_MS windows of the IMU stream,
+ * classified by the int8 model in activity_model.c, one REC_ACTIVITY per
+ * window.
+ */
+#define ACT_WIN_MS  5000
+
+void activity_task_start(void);
+
+/* Inputs from the sensor tasks (any thread) */
+void activity_post_imu(const int32_t a_mg[3], const int32_t g_mdps[3]);
+void activity_post_steps(uint32_t steps_total);
+void activity_post_hr(uint16_t bpm_x10);
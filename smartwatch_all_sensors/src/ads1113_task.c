@@ -4,6 +4,17 @@
 #include <zephyr/logging/log.h>
 #include <stdint.h>
 
+#include "acq_batch.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "dsp_fixed.h"
+#include "ads1113_task.h"
+#include "eda_engine.h"
+#include "offwrist_task.h"
+#include "sensor_records.h"
+#include "slow_report.h"
+#include "stress_task.h"
+
 LOG_MODULE_REGISTER(eda_raw, LOG_LEVEL_INF);
 
 /* Use software I2C bus on P0.07/P0.08 */
@@ -13,19 +24,54 @@ LOG_MODULE_REGISTER(eda_raw, LOG_LEVEL_INF);
 #define REG_CONV        0x00
 #define REG_CONFIG      0x01
 
-#define FS_HZ           4
+#define FS_HZ           EDA_FS_HZ
 #define SAMPLE_MS       (1000 / FS_HZ)
+#define SAMPLE_BATCHES  (SAMPLE_MS / ACQ_BATCH_MS)
+
+/* PGA +/-4.096 V => 125 uV/LSB */
+#define ADS_MV_PER_LSB_Q16  DSP_Q16(0.125)
+#define ADS_UV_PER_LSB      125
 
 #define FLAT_DELTA_RAW_TH   1
 #define FLAT_TIME_SEC       5
 #define FLAT_N_SAMPLES      (FS_HZ * FLAT_TIME_SEC)
 
+#define EDA_SUMMARY_MS      10000
+
+/* Low rate (off wrist): one single-shot conversion every EDA_LOW_BATCHES,
+ * the ADC powered down in between; EDA_LOW_CONTACT_N steps in a row
+ * between them are contact, so one noise step does not flip the state.
+ * Each wakeup reads the previous conversion and starts the next one.
+ */
+#define EDA_LOW_BATCHES     2
+#define EDA_LOW_CONTACT_N   4
+
+static atomic_t low_req;
+static atomic_t eda_on = ATOMIC_INIT(1);
+static K_SEM_DEFINE(on_sem, 0, 1);
+
+static const struct eda_frontend eda_fe = EDA_FRONTEND_DEFAULT;
+static struct eda_engine eda;
+
 static int ads_set_continuous(const struct device *i2c)
 {
 	uint8_t cfg[3] = { REG_CONFIG, 0xC2, 0x83 };
 	return i2c_write(i2c, cfg, sizeof(cfg), ADS1113_ADDR);
 }
 
+static int ads_single_shot(const struct device *i2c)
+{
+	uint8_t cfg[3] = { REG_CONFIG, 0xC3, 0x83 };
+	return i2c_write(i2c, cfg, sizeof(cfg), ADS1113_ADDR);
+}
+
+/* Single-shot mode without a conversion: powered down */
+static int ads_power_down(const struct device *i2c)
+{
+	uint8_t cfg[3] = { REG_CONFIG, 0x43, 0x83 };
+	return i2c_write(i2c, cfg, sizeof(cfg), ADS1113_ADDR);
+}
+
 static int ads_read_raw(const struct device *i2c, int16_t *raw)
 {
 	uint8_t reg = REG_CONV;
@@ -40,8 +86,41 @@ static int ads_read_raw(const struct device *i2c, int16_t *raw)
 
 static int32_t raw_to_mV(int16_t raw)
 {
-	int32_t uv = (int32_t)raw * 125;
-	return uv / 1000;
+	return dsp_scale_q16(raw, ADS_MV_PER_LSB_Q16);
+}
+
+static void scr_publish(const struct eda_scr *scr)
+{
+	struct rec_scr rec = {
+		.onset_ms = scr->onset_ms,
+		.rise_ms = scr->rise_ms,
+		.amp_ns = scr->amp_ns,
+		.tonic_ns = (uint16_t)MIN(scr->tonic_ns, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_SCR, &rec, sizeof(rec));
+	stress_post_scr();
+
+	LOG_INF("SCR onset=%u rise=%ums amp=%u nS tonic=%u nS",
+		scr->onset_ms, scr->rise_ms, scr->amp_ns, scr->tonic_ns);
+}
+
+static void eda_summary(bool contact)
+{
+	uint32_t tonic = eda_engine_tonic_ns(&eda);
+	int32_t phasic = eda_engine_phasic_ns(&eda);
+	uint8_t rate = eda_engine_scr_per_min(&eda, k_uptime_get_32());
+
+	struct rec_eda rec = {
+		.tonic_ns = (uint16_t)MIN(tonic, UINT16_MAX),
+		.phasic_ns = (int16_t)CLAMP(phasic, INT16_MIN, INT16_MAX),
+		.scr_per_min = rate,
+		.contact = contact,
+	};
+	(void)ble_rec_send(REC_EDA, &rec, sizeof(rec));
+	stress_post_eda(contact);
+
+	LOG_INF("EDA tonic=%u nS phasic=%d nS scr/min=%u%s",
+		tonic, phasic, rate, contact ? "" : " (no contact)");
 }
 
 static void ads1113_thread(void *a, void *b, void *c)
@@ -65,16 +144,67 @@ static void ads1113_thread(void *a, void *b, void *c)
 
 	int16_t prev_raw = 0;
 	bool have_prev = false;
+	bool shot = false;
+	bool resume = false;
 	int flat_cnt = 0;
+	int step_cnt = 0;
+	bool feat_prev = true;
+
+	eda_engine_init(&eda, &eda_fe);
 
 	int64_t t0 = k_uptime_get();
+	int64_t next_summary = t0 + EDA_SUMMARY_MS;
 
 	while (1) {
 		int16_t raw = 0;
+
+		if (!atomic_get(&eda_on)) {
+			(void)ads_power_down(i2c);
+			LOG_INF("EDA off: no subscriber");
+			while (!atomic_get(&eda_on)) {
+				(void)k_sem_take(&on_sem, K_FOREVER);
+			}
+			shot = false;
+			resume = true;
+		}
+		if (resume && !atomic_get(&low_req)) {
+			LOG_INF("EDA back to continuous");
+			(void)ads_set_continuous(i2c);
+			slow_report_restart(SLOW_CH_EDA);
+			resume = false;
+			shot = false;
+			have_prev = false;
+			flat_cnt = 0;
+			step_cnt = 0;
+			eda_engine_restart(&eda);
+			next_summary = k_uptime_get() + EDA_SUMMARY_MS;
+			acq_batch_sleep(SAMPLE_BATCHES);
+			continue;
+		}
+
+		if (atomic_get(&low_req)) {
+			/* contact check only; the engine restarts with the stream */
+			ret = shot ? ads_read_raw(i2c, &raw) : -EAGAIN;
+			if (!ret) {
+				int16_t d = raw - prev_raw;
+				bool step = have_prev &&
+					    (d > FLAT_DELTA_RAW_TH || d < -FLAT_DELTA_RAW_TH);
+
+				step_cnt = step ? MIN(step_cnt + 1, EDA_LOW_CONTACT_N) : 0;
+				offwrist_post_eda(step_cnt >= EDA_LOW_CONTACT_N);
+				prev_raw = raw;
+				have_prev = true;
+			}
+			shot = ads_single_shot(i2c) == 0;
+			resume = true;
+			acq_batch_sleep(EDA_LOW_BATCHES);
+			continue;
+		}
+
 		ret = ads_read_raw(i2c, &raw);
 		if (ret) {
 			LOG_ERR("ADS read failed (%d)", ret);
-			k_sleep(K_MSEC(SAMPLE_MS));
+			acq_batch_sleep(SAMPLE_BATCHES);
 			continue;
 		}
 
@@ -94,13 +224,43 @@ static void ads1113_thread(void *a, void *b, void *c)
 		}
 
 		int64_t t_ms = k_uptime_get() - t0;
+		bool contact = flat_cnt < FLAT_N_SAMPLES;
 
-		LOG_INF("t=%lldms raw=%d mv=%ld dRaw=%d flat_cnt=%d%s",
+		offwrist_post_eda(contact);
+		slow_report_push(SLOW_CH_EDA, (int32_t)raw * ADS_UV_PER_LSB);
+
+		LOG_DBG("t=%lldms raw=%d mv=%ld dRaw=%d flat_cnt=%d%s",
 			t_ms, raw, (long)mv, d, flat_cnt,
-			(flat_cnt >= FLAT_N_SAMPLES) ? " FLATLINE" : "");
+			contact ? "" : " FLATLINE");
+
+		if (flat_cnt == FLAT_N_SAMPLES) {
+			LOG_INF("EDA FLATLINE: contact lost");
+			eda_engine_restart(&eda);
+		}
+
+		struct eda_scr scr;
+		bool feat = chan_sub_wanted(CHAN_EDA);
+
+		/* resubscribed: history from before the gap would fake an SCR */
+		if (feat && !feat_prev) {
+			eda_engine_restart(&eda);
+		}
+		feat_prev = feat;
+
+		if (contact && feat &&
+		    eda_engine_push(&eda, (int32_t)raw * ADS_UV_PER_LSB, k_uptime_get_32(), &scr)) {
+			scr_publish(&scr);
+		}
+
+		if (k_uptime_get() >= next_summary) {
+			next_summary += chan_sub_period_ms(CHAN_EDA, EDA_SUMMARY_MS);
+			if (feat) {
+				eda_summary(contact);
+			}
+		}
 
 		prev_raw = raw;
-		k_sleep(K_MSEC(SAMPLE_MS));
+		acq_batch_sleep(SAMPLE_BATCHES);
 	}
 }
 
@@ -111,6 +271,23 @@ K_THREAD_STACK_DEFINE(ads1113_stack, ADS1113_STACK_SIZE);
 static struct k_thread ads1113_tcb;
 static bool started;
 
+void ads1113_set_low_rate(uint8_t owner, bool on)
+{
+	atomic_val_t was = on ? atomic_or(&low_req, owner) :
+				atomic_and(&low_req, ~(atomic_val_t)owner);
+
+	if (was && !atomic_get(&low_req)) {
+		k_wakeup(&ads1113_tcb);
+	}
+}
+
+void ads1113_set_enabled(bool on)
+{
+	if (atomic_set(&eda_on, on) != on && on) {
+		k_sem_give(&on_sem);
+	}
+}
+
 void ads1113_task_start(void)
 {
 	if (started) return;
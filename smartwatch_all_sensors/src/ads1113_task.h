@@ -1,3 +1,15 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acq_policy.h"
 
 void ads1113_task_start(void);
+
+/* Low rate: a single-shot conversion every 500 ms for contact only, no
+ * EDA features. Held while any acq_policy.h owner asks for it.
+ */
+void ads1113_set_low_rate(uint8_t owner, bool on);
+
+/* Off: ADC powered down, nothing subscribes to an EDA channel (chan_sub.h) */
+void ads1113_set_enabled(bool on);
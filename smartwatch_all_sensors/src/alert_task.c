@@ -0,0 +1,163 @@
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "alert_task.h"
+#include "ble_log_service.h"
+#include "sensor_records.h"
+
+LOG_MODULE_REGISTER(alert, LOG_LEVEL_INF);
+
+#define ALERT_TX_WAIT_MS  500     /* give up on the TX-complete report */
+#define ALERT_BUSY_MS     2       /* TX slots all taken: retry quickly */
+
+struct alert {
+	uint8_t  type;
+	uint8_t  len;
+	uint8_t  payload[ALERT_PAYLOAD_MAX];
+	uint32_t raised_cyc;
+};
+
+static struct alert pending;
+static bool have_pending;
+static struct k_spinlock lock;
+
+static K_SEM_DEFINE(alert_sem, 0, 1);
+static K_SEM_DEFINE(tx_sem, 0, 1);
+static volatile uint32_t tx_cyc;
+
+static uint32_t cyc_to_ms(uint32_t cyc)
+{
+	return (uint32_t)k_cyc_to_ms_floor64(cyc);
+}
+
+static uint16_t ms_u16(uint32_t ms)
+{
+	return (uint16_t)((ms > 0xFFFE) ? 0xFFFE : ms);
+}
+
+int alert_raise(uint8_t type, const void *payload, size_t len)
+{
+	if (len > ALERT_PAYLOAD_MAX) {
+		return -EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	pending.type = type;
+	pending.len = (uint8_t)len;
+	memcpy(pending.payload, payload, len);
+	pending.raised_cyc = k_cycle_get_32();
+	have_pending = true;
+	k_spin_unlock(&lock, key);
+
+	/* hold the streams now, not when the alert thread gets to run */
+	ble_alert_hold(true);
+	k_sem_give(&alert_sem);
+	return 0;
+}
+
+/* BT stack context */
+static void alert_sent(void)
+{
+	tx_cyc = k_cycle_get_32();
+	k_sem_give(&tx_sem);
+}
+
+static bool take_pending(struct alert *a)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	bool have = have_pending;
+
+	if (have) {
+		*a = pending;
+		have_pending = false;
+	}
+	k_spin_unlock(&lock, key);
+	return have;
+}
+
+static void alert_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	struct alert a;
+
+	while (1) {
+		k_sem_take(&alert_sem, K_FOREVER);
+
+		while (take_pending(&a)) {
+			uint8_t tries = 0;
+			int err;
+
+			ble_alert_hold(true);
+			k_sem_reset(&tx_sem);
+			while (1) {
+				err = ble_alert_send(a.type, a.payload, a.len, alert_sent);
+				if (tries < UINT8_MAX) {
+					tries++;
+				}
+				if (err != -ENOMEM && err != -ENOTCONN) {
+					break;
+				}
+				/* not connected: release the streams until we are */
+				ble_alert_hold(err == -ENOMEM);
+				k_msleep((err == -ENOMEM) ? ALERT_BUSY_MS : ALERT_RETRY_MS);
+
+				struct alert newer;
+
+				if (take_pending(&newer)) {
+					a = newer;
+				}
+				ble_alert_hold(true);
+			}
+
+			uint32_t queued = k_cycle_get_32();
+			struct rec_alert_tx rep = {
+				.type = a.type,
+				.tries = tries,
+				.queue_ms = ms_u16(cyc_to_ms(queued - a.raised_cyc)),
+				.tx_ms = 0xFFFF,
+			};
+
+			if (err == 0 && k_sem_take(&tx_sem, K_MSEC(ALERT_TX_WAIT_MS)) == 0) {
+				rep.tx_ms = ms_u16(cyc_to_ms(tx_cyc - a.raised_cyc));
+			}
+			ble_alert_hold(false);
+
+			if (err) {
+				LOG_ERR("alert 0x%02X dropped (%d)", a.type, err);
+				continue;
+			}
+			(void)ble_rec_send(REC_ALERT_TX, &rep, sizeof(rep));
+			LOG_INF("ALERT 0x%02X | tries=%u queue=%u ms tx=%u ms",
+				a.type, tries, rep.queue_ms, rep.tx_ms);
+		}
+	}
+}
+
+/* thread objects: cooperative, so the send is never preempted by a stream */
+#define ALERT_STACK_SIZE 1024
+#define ALERT_PRIORITY   K_PRIO_COOP(2)
+
+K_THREAD_STACK_DEFINE(alert_stack, ALERT_STACK_SIZE);
+static struct k_thread alert_tcb;
+static bool started;
+
+void alert_task_start(void)
+{
+	if (started) {
+		return;
+	}
+	started = true;
+
+	k_thread_create(&alert_tcb, alert_stack, K_THREAD_STACK_SIZEOF(alert_stack),
+			alert_thread, NULL, NULL, NULL,
+			ALERT_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(&alert_tcb, "alert_task");
+}
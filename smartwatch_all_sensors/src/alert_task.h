@@ -0,0 +1,17 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* High-priority record path for events that must not wait behind the
+ * sensor streams (falls). The alert is sent from a cooperative thread the
+ * moment it is raised; stream senders are held off until the controller
+ * reports it sent. Each alert is followed by a REC_ALERT_TX latency report.
+ * While disconnected the alert is kept and retried every ALERT_RETRY_MS.
+ */
+#define ALERT_PAYLOAD_MAX 14
+#define ALERT_RETRY_MS    1000
+
+void alert_task_start(void);
+
+/* Any thread; a newer alert replaces one not yet sent. -EINVAL if too long */
+int alert_raise(uint8_t type, const void *payload, size_t len);
@@ -1,33 +1,196 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include "acq_batch.h"
+#include "as6221_task.h"
+#include "ble_log_service.h"
+#include "dsp_fixed.h"
+#include "offwrist_task.h"
+#include "sensor_records.h"
+#include "slow_report.h"
+#include "stress_task.h"
 
 LOG_MODULE_REGISTER(as6221_demo, LOG_LEVEL_INF);
 
+#define GPIO0_NODE DT_NODELABEL(gpio0)
+#define AS6221_ALERT_PIN  30   /* P0.30 -> AS6221 ALERT (open drain, active low) */
+
 #define AS6221_ADDR     0x48
-#define REG_TEMP_MSB    0x00
+#define REG_TVAL        0x00
+#define REG_CONFIG      0x01
+#define REG_TLOW        0x02
+#define REG_THIGH       0x03
+
+/* CONFIG: sleep mode, ALERT in interrupt mode (active low, one fault).
+ * Writing SS while asleep runs one conversion; ALERT then asserts once
+ * when TVAL rises above THIGH and once when it falls back below TLOW,
+ * and is released by the next register read.
+ */
+#define CFG_SS          0x8000
+#define CFG_IM          0x0200
+#define CFG_SM          0x0100
+#define CFG_SLEEP       (CFG_SM | CFG_IM)
+
+/* 1 LSB = 1/128 C = 7.8125 mC (exact in Q16) */
+#define AS6221_MC_PER_LSB_Q16  DSP_Q16(7.8125)
+#define AS6221_TEMP_ERR        INT32_MIN
+
+#define AS6221_LOW_S_MIN       10     /* off wrist: at least this interval */
+
+static atomic_t low_req;
+static atomic_t temp_on = ATOMIC_INIT(1);
 
 static const struct device *i2c_dev;
+static const struct device *gpio0;
+static struct gpio_callback alert_cb;
+
+/* ALERT edge or a low-rate change; alert_hit tells which */
+static K_SEM_DEFINE(wake_sem, 0, 1);
+static atomic_t alert_hit;
+
+static struct k_spinlock cfg_lock;
+static struct as6221_cfg cfg_new;
+static bool cfg_pending;
+static struct as6221_cfg cfg = AS6221_CFG_DEFAULT;
 
-/* ---------- your existing logic unchanged ---------- */
-static float as6221_read_temp(void)
+/* 0.1 C to the 1/128 C register format, rounded */
+static int16_t c10_to_raw(int16_t c10)
+{
+	int32_t v = (int32_t)c10 * 64;
+
+	return (int16_t)((v + ((v < 0) ? -2 : 2)) / 5);
+}
+
+static int reg_write(uint8_t reg, uint16_t val)
+{
+	uint8_t buf[3] = { reg };
+
+	sys_put_be16(val, &buf[1]);
+	return i2c_write(i2c_dev, buf, sizeof(buf), AS6221_ADDR);
+}
+
+/* Returns temperature in milli-degC (fixed point, no soft-float) */
+static int32_t as6221_read_temp(void)
 {
 	uint8_t data[2];
-	int ret = i2c_burst_read(i2c_dev, AS6221_ADDR, REG_TEMP_MSB, data, 2);
+	int ret = i2c_burst_read(i2c_dev, AS6221_ADDR, REG_TVAL, data, 2);
 
 	if (ret < 0) {
 		LOG_ERR("I2C read failed (%d)", ret);
-		return -1000.0f;
+		return AS6221_TEMP_ERR;
 	}
 
-	uint16_t raw = (data[0] << 8) | data[1];
-	float temperature = raw / 100.0f;
+	int16_t raw = (int16_t)sys_get_be16(data);
+
+	return dsp_scale_q16(raw, AS6221_MC_PER_LSB_Q16);
+}
+
+static int as6221_configure(void)
+{
+	int ret = reg_write(REG_TLOW, (uint16_t)c10_to_raw(cfg.low_c10));
+
+	ret |= reg_write(REG_THIGH, (uint16_t)c10_to_raw(cfg.high_c10));
+	ret |= reg_write(REG_CONFIG, CFG_SLEEP);
+	return ret;
+}
+
+static int as6221_trigger(void)
+{
+	return reg_write(REG_CONFIG, CFG_SLEEP | CFG_SS);
+}
 
-	LOG_INF("[AS6221] t=%.2f C | raw=%u | uptime=%lld ms",
-		temperature, raw, k_uptime_get());
+static void alert_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
 
-	return temperature;
+	atomic_set(&alert_hit, 1);
+	k_sem_give(&wake_sem);
+}
+
+static void temp_ctrl(const uint8_t *d, size_t len)
+{
+	if (len < 7) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&cfg_lock);
+
+	cfg_new = (struct as6221_cfg){
+		.interval_s = sys_get_le16(&d[1]),
+		.low_c10 = (int16_t)sys_get_le16(&d[3]),
+		.high_c10 = (int16_t)sys_get_le16(&d[5]),
+	};
+	cfg_pending = true;
+	k_spin_unlock(&cfg_lock, key);
+}
+
+static void cfg_take(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&cfg_lock);
+	bool take = cfg_pending;
+	struct as6221_cfg c = cfg_new;
+
+	cfg_pending = false;
+	k_spin_unlock(&cfg_lock, key);
+
+	if (!take) {
+		return;
+	}
+	c.interval_s = CLAMP(c.interval_s, 1, AS6221_INTERVAL_MAX_S);
+	if (c.high_c10 <= c.low_c10) {
+		LOG_WRN("Temp thresholds need low < high (%d, %d)", c.low_c10, c.high_c10);
+		return;
+	}
+	cfg = c;
+	(void)as6221_configure();
+	LOG_INF("Temp every %us, alert above %d.%d C until below %d.%d C", cfg.interval_s,
+		cfg.high_c10 / 10, dsp_abs32(cfg.high_c10 % 10),
+		cfg.low_c10 / 10, dsp_abs32(cfg.low_c10 % 10));
+}
+
+/* The conversion that fired ALERT is still in TVAL; reading it releases ALERT */
+static void alert_service(void)
+{
+	int32_t t_mc = as6221_read_temp();
+
+	if (t_mc == AS6221_TEMP_ERR) {
+		return;
+	}
+
+	int16_t t_c10 = (int16_t)(t_mc / 100);
+	bool high = 2 * t_c10 >= cfg.low_c10 + cfg.high_c10;
+	struct rec_temp_alert rec = {
+		.evt = high ? TEMP_ALERT_HIGH : TEMP_ALERT_CLEAR,
+		.temp_c10 = t_c10,
+		.thresh_c10 = high ? cfg.high_c10 : cfg.low_c10,
+	};
+	(void)ble_rec_send(REC_TEMP_ALERT, &rec, sizeof(rec));
+	LOG_INF("[AS6221] %s: t=%ld mC", high ? "above high threshold" : "back below low threshold",
+		(long)t_mc);
+}
+
+static int alert_init(void)
+{
+	gpio0 = DEVICE_DT_GET(GPIO0_NODE);
+	if (!device_is_ready(gpio0)) {
+		return -ENODEV;
+	}
+
+	int ret = gpio_pin_configure(gpio0, AS6221_ALERT_PIN, GPIO_INPUT | GPIO_PULL_UP);
+
+	if (ret) {
+		return ret;
+	}
+	gpio_init_callback(&alert_cb, alert_isr, BIT(AS6221_ALERT_PIN));
+	(void)gpio_add_callback(gpio0, &alert_cb);
+	return gpio_pin_interrupt_configure(gpio0, AS6221_ALERT_PIN, GPIO_INT_EDGE_FALLING);
 }
 
 /* ---------- thread wrapper ---------- */
@@ -47,9 +210,53 @@ static void as6221_thread(void *a, void *b, void *c)
 
 	LOG_INF("I2C0 ready, addr=0x48");
 
+	if (as6221_configure()) {
+		LOG_ERR("AS6221 config write failed");
+		return;
+	}
+	if (alert_init()) {
+		LOG_WRN("AS6221 ALERT pin not available: no threshold events");
+	}
+	(void)ble_ctrl_register(CTRL_TEMP_CFG, CTRL_TEMP_CFG, temp_ctrl);
+
+	/* first result one interval after this conversion */
+	bool shot = as6221_trigger() == 0;
+
 	while (1) {
-		as6221_read_temp();
-		k_msleep(1000);
+		uint32_t s = cfg.interval_s;
+
+		if (!atomic_get(&temp_on)) {
+			/* asleep between single shots: no trigger, no conversion */
+			while (!atomic_get(&temp_on)) {
+				(void)k_sem_take(&wake_sem, K_FOREVER);
+				if (atomic_set(&alert_hit, 0)) {
+					alert_service();
+				}
+			}
+			slow_report_restart(SLOW_CH_TEMP);
+			shot = as6221_trigger() == 0;
+			continue;
+		}
+
+		if (atomic_get(&low_req)) {
+			s = MAX(s, AS6221_LOW_S_MIN);
+		}
+		if (k_sem_take(&wake_sem, acq_batch_timeout(s * 1000 / ACQ_BATCH_MS)) == 0 &&
+		    atomic_set(&alert_hit, 0)) {
+			alert_service();
+			continue;
+		}
+
+		cfg_take();
+
+		int32_t t_mc = shot ? as6221_read_temp() : AS6221_TEMP_ERR;
+
+		if (t_mc != AS6221_TEMP_ERR) {
+			slow_report_push(SLOW_CH_TEMP, t_mc);
+			stress_post_temp(t_mc);
+			offwrist_post_temp(t_mc);
+		}
+		shot = as6221_trigger() == 0;
 	}
 }
 
@@ -61,6 +268,23 @@ K_THREAD_STACK_DEFINE(as6221_stack, AS6221_STACK_SIZE);
 static struct k_thread as6221_tcb;
 static bool started;
 
+void as6221_set_low_rate(uint8_t owner, bool on)
+{
+	atomic_val_t was = on ? atomic_or(&low_req, owner) :
+				atomic_and(&low_req, ~(atomic_val_t)owner);
+
+	if (was && !atomic_get(&low_req)) {
+		k_sem_give(&wake_sem);
+	}
+}
+
+void as6221_set_enabled(bool on)
+{
+	if (atomic_set(&temp_on, on) != on) {
+		k_sem_give(&wake_sem);
+	}
+}
+
 void as6221_task_start(void)
 {
 	if (started) {
@@ -1,3 +1,30 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acq_policy.h"
+
+/* Skin temperature: the AS6221 sleeps between single-shot conversions
+ * every interval_s. ALERT (interrupt mode) raises REC_TEMP_ALERT when a
+ * conversion rises above high_c10, then again once it falls below low_c10.
+ * CTRL_TEMP_CFG changes all three.
+ */
+#define AS6221_INTERVAL_MAX_S  600
+
+struct as6221_cfg {
+	uint16_t interval_s;
+	int16_t  low_c10;      /* 0.1 C */
+	int16_t  high_c10;
+};
+
+#define AS6221_CFG_DEFAULT { .interval_s = 1, .low_c10 = 375, .high_c10 = 380 }
 
 void as6221_task_start(void);
+
+/* Low rate: skin temperature at most every 10 s. Held while any
+ * acq_policy.h owner asks for it.
+ */
+void as6221_set_low_rate(uint8_t owner, bool on);
+
+/* Off: no conversions, nothing subscribes to a temperature channel (chan_sub.h) */
+void as6221_set_enabled(bool on);
@@ -1,10 +1,13 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
 
 #include "ble_log_service.h"
+#include "chan_sub.h"
+#include "sensor_records.h"
 
 /* 128-bit UUIDs */
 #define BT_UUID_LOG_SERVICE_VAL \
@@ -13,15 +16,60 @@
 #define BT_UUID_LOG_STREAM_VAL \
 	BT_UUID_128_ENCODE(0x9f7b0001, 0x6c35, 0x4d2c, 0x9c85, 0x4a8c1a2b3c4d)
 
+#define BT_UUID_REC_STREAM_VAL \
+	BT_UUID_128_ENCODE(0x9f7b0002, 0x6c35, 0x4d2c, 0x9c85, 0x4a8c1a2b3c4d)
+
+#define BT_UUID_CTRL_VAL \
+	BT_UUID_128_ENCODE(0x9f7b0003, 0x6c35, 0x4d2c, 0x9c85, 0x4a8c1a2b3c4d)
+
 static struct bt_uuid_128 log_svc_uuid = BT_UUID_INIT_128(BT_UUID_LOG_SERVICE_VAL);
 static struct bt_uuid_128 log_chr_uuid = BT_UUID_INIT_128(BT_UUID_LOG_STREAM_VAL);
+static struct bt_uuid_128 rec_chr_uuid = BT_UUID_INIT_128(BT_UUID_REC_STREAM_VAL);
+static struct bt_uuid_128 ctrl_chr_uuid = BT_UUID_INIT_128(BT_UUID_CTRL_VAL);
 
 static struct bt_conn *g_conn;
 static volatile bool g_notify_enabled;
+static volatile bool g_rec_notify_enabled;
 
 static uint8_t g_last[200];
 static size_t  g_last_len;
 
+#define CTRL_HANDLERS_MAX 8
+
+/* Stream traffic may hold at most TX_STREAM_MAX of the CONFIG_BT_CONN_TX_MAX
+ * (10) notification slots, so an alert never waits for a free buffer and
+ * queues behind at most TX_STREAM_MAX packets. While an alert is pending,
+ * stream senders hold off completely.
+ */
+#define TX_STREAM_MAX     4
+#define TX_RETRY_MS       5
+#define TX_RETRIES        10
+
+static atomic_t g_tx_stream;
+static atomic_t g_alert_hold;
+static ble_alert_done_t g_alert_done;
+
+static struct {
+	uint8_t first, last;
+	ble_ctrl_cb_t cb;
+} g_ctrl[CTRL_HANDLERS_MAX];
+
+/* Low-power radio (watch off the wrist): 1 s advertising, and a 200..250 ms
+ * connection interval with peripheral latency 3, so an idle link wakes the
+ * radio about once a second. Normal is the fast advertising set and the
+ * peripheral preferred 30..50 ms.
+ */
+#define ADV_PARAM_LOW \
+	BT_LE_ADV_PARAM(BT_LE_ADV_OPT_CONN | BT_LE_ADV_OPT_USE_NAME, \
+			BT_GAP_ADV_SLOW_INT_MIN, BT_GAP_ADV_SLOW_INT_MAX, NULL)
+#define CONN_PARAM_LOW      BT_LE_CONN_PARAM(160, 200, 3, 600)
+#define CONN_PARAM_NORMAL   BT_LE_CONN_PARAM(24, 40, 0, 400)
+#define ADV_RETRY_MS        100
+
+static atomic_t g_low_power;
+static void radio_apply(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(g_radio_work, radio_apply);
+
 static ssize_t log_read(struct bt_conn *conn,
 			const struct bt_gatt_attr *attr,
 			void *buf, uint16_t len, uint16_t offset)
@@ -34,6 +82,41 @@ static void ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 {
 	ARG_UNUSED(attr);
 	g_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+	chan_sub_set(SUB_BLE, CHAN_LOG, g_notify_enabled, 0);
+}
+
+static void rec_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ARG_UNUSED(attr);
+	g_rec_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+	/* a central that only enables records gets every channel, as before */
+	chan_sub_set_mask(SUB_BLE, BIT_MASK(CHAN_COUNT) & ~BIT(CHAN_LOG), g_rec_notify_enabled);
+}
+
+static ssize_t ctrl_write(struct bt_conn *conn,
+			  const struct bt_gatt_attr *attr,
+			  const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	ARG_UNUSED(conn);
+	ARG_UNUSED(attr);
+	ARG_UNUSED(flags);
+
+	const uint8_t *p = buf;
+
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+	if (len == 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+
+	for (int i = 0; i < CTRL_HANDLERS_MAX; i++) {
+		if (g_ctrl[i].cb && p[0] >= g_ctrl[i].first && p[0] <= g_ctrl[i].last) {
+			g_ctrl[i].cb(p, len);
+			return len;
+		}
+	}
+	return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
 }
 
 /* attrs index:
@@ -41,6 +124,11 @@ static void ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
  * 1 = chr declaration
  * 2 = chr value (notify this)
  * 3 = ccc
+ * 4 = record chr declaration
+ * 5 = record chr value (binary records)
+ * 6 = record ccc
+ * 7 = control chr declaration
+ * 8 = control chr value (host writes, see sensor_records.h)
  */
 BT_GATT_SERVICE_DEFINE(log_svc,
 	BT_GATT_PRIMARY_SERVICE(&log_svc_uuid),
@@ -48,20 +136,85 @@ BT_GATT_SERVICE_DEFINE(log_svc,
 			       BT_GATT_CHRC_NOTIFY | BT_GATT_CHRC_READ,
 			       BT_GATT_PERM_READ,
 			       log_read, NULL, NULL),
-	BT_GATT_CCC(ccc_cfg_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE)
+	BT_GATT_CCC(ccc_cfg_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+	BT_GATT_CHARACTERISTIC(&rec_chr_uuid.uuid,
+			       BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE,
+			       NULL, NULL, NULL),
+	BT_GATT_CCC(rec_ccc_cfg_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+	BT_GATT_CHARACTERISTIC(&ctrl_chr_uuid.uuid,
+			       BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+			       BT_GATT_PERM_WRITE,
+			       NULL, ctrl_write, NULL)
 );
 
+static void stream_tx_done(struct bt_conn *conn, void *user_data)
+{
+	ARG_UNUSED(conn);
+	ARG_UNUSED(user_data);
+
+	if (atomic_get(&g_tx_stream) > 0) {
+		atomic_dec(&g_tx_stream);
+	}
+}
+
+static void alert_tx_done(struct bt_conn *conn, void *user_data)
+{
+	ARG_UNUSED(conn);
+	ARG_UNUSED(user_data);
+
+	if (g_alert_done) {
+		g_alert_done();
+	}
+}
+
+/* Normal-priority notification: bounded share of the TX slots, retried
+ * for up to TX_RETRIES * TX_RETRY_MS, then dropped.
+ */
+static int notify_stream(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			 const void *data, uint16_t len)
+{
+	struct bt_gatt_notify_params params = {
+		.attr = attr,
+		.data = data,
+		.len = len,
+		.func = stream_tx_done,
+	};
+	int err = -ENOMEM;
+
+	for (int tries = 0; tries < TX_RETRIES; tries++) {
+		if (!atomic_get(&g_alert_hold) && atomic_get(&g_tx_stream) < TX_STREAM_MAX) {
+			atomic_inc(&g_tx_stream);
+			err = bt_gatt_notify_cb(conn, &params);
+			if (err == 0) {
+				return 0;
+			}
+			atomic_dec(&g_tx_stream);
+			if (err != -ENOMEM) {
+				return err;
+			}
+		}
+		k_msleep(TX_RETRY_MS);
+	}
+	return err;
+}
+
 static void connected(struct bt_conn *conn, uint8_t err)
 {
 	if (err) {
 		return;
 	}
+	atomic_set(&g_tx_stream, 0);
 
 	if (g_conn) {
 		bt_conn_unref(g_conn);
 		g_conn = NULL;
 	}
 	g_conn = bt_conn_ref(conn);
+
+	if (atomic_get(&g_low_power)) {
+		k_work_reschedule(&g_radio_work, K_NO_WAIT);
+	}
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -74,6 +227,34 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		g_conn = NULL;
 	}
 	g_notify_enabled = false;
+	g_rec_notify_enabled = false;
+	chan_sub_set_mask(SUB_BLE, BIT_MASK(CHAN_COUNT), false);
+
+	/* advertising resumes with the parameters it was started with */
+	k_work_reschedule(&g_radio_work, K_MSEC(ADV_RETRY_MS));
+}
+
+/* System workqueue: bring the link or the advertiser in line with g_low_power */
+static void radio_apply(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	bool low = atomic_get(&g_low_power) != 0;
+	struct bt_conn *conn = g_conn;
+
+	if (conn) {
+		(void)bt_conn_le_param_update(conn, low ? CONN_PARAM_LOW : CONN_PARAM_NORMAL);
+		return;
+	}
+
+	(void)bt_le_adv_stop();
+
+	int err = bt_le_adv_start(low ? ADV_PARAM_LOW : BT_LE_ADV_CONN_NAME, NULL, 0, NULL, 0);
+
+	if (err && err != -EALREADY) {
+		/* connection object not released yet */
+		k_work_reschedule(&g_radio_work, K_MSEC(ADV_RETRY_MS));
+	}
 }
 
 BT_CONN_CB_DEFINE(conn_cb) = {
@@ -92,6 +273,19 @@ int ble_log_service_init(void)
 	return bt_le_adv_start(BT_LE_ADV_CONN_NAME, NULL, 0, NULL, 0);
 }
 
+int ble_ctrl_register(uint8_t first, uint8_t last, ble_ctrl_cb_t cb)
+{
+	for (int i = 0; i < CTRL_HANDLERS_MAX; i++) {
+		if (!g_ctrl[i].cb) {
+			g_ctrl[i].first = first;
+			g_ctrl[i].last = last;
+			g_ctrl[i].cb = cb;
+			return 0;
+		}
+	}
+	return -ENOMEM;
+}
+
 int ble_log_send_as(const uint8_t *data, size_t len)
 {
 	if (!data || len == 0) {
@@ -114,15 +308,7 @@ int ble_log_send_as(const uint8_t *data, size_t len)
 	while (off < len) {
 		uint16_t chunk = (uint16_t)MIN((size_t)max_payload, len - off);
 
-		int tries = 0;
-		int err;
-		do {
-			err = bt_gatt_notify(conn, &log_svc.attrs[2], data + off, chunk);
-			if (err == -ENOMEM) {
-				k_msleep(5);
-			}
-			tries++;
-		} while (err == -ENOMEM && tries < 10);
+		int err = notify_stream(conn, &log_svc.attrs[2], data + off, chunk);
 
 		if (err) {
 			return err;
@@ -134,3 +320,84 @@ int ble_log_send_as(const uint8_t *data, size_t len)
 
 	return (int)len;
 }
+
+/* Header + payload into buf; records are never fragmented, so the whole
+ * record has to fit one notification. Returns the total length.
+ */
+static int rec_build(struct bt_conn *conn, uint8_t *buf, size_t size,
+		     uint8_t type, const void *payload, size_t len)
+{
+	uint16_t mtu = bt_gatt_get_mtu(conn);
+	size_t total = REC_HDR_LEN + len;
+
+	if (len > size - REC_HDR_LEN || total > (size_t)((mtu > 3) ? (mtu - 3) : 20)) {
+		return -EMSGSIZE;
+	}
+
+	buf[0] = type;
+	buf[1] = (uint8_t)len;
+	sys_put_le32(k_uptime_get_32(), &buf[2]);
+	memcpy(&buf[REC_HDR_LEN], payload, len);
+	return (int)total;
+}
+
+int ble_rec_send(uint8_t type, const void *payload, size_t len)
+{
+	struct bt_conn *conn = g_conn;
+	if (!conn || !g_rec_notify_enabled) {
+		return 0;
+	}
+
+	uint8_t buf[REC_HDR_LEN + 64];
+	int total = rec_build(conn, buf, sizeof(buf), type, payload, len);
+
+	if (total < 0) {
+		return total;
+	}
+
+	int err = notify_stream(conn, &log_svc.attrs[5], buf, (uint16_t)total);
+
+	return err ? err : total;
+}
+
+void ble_set_low_power(bool on)
+{
+	if (atomic_set(&g_low_power, on) != on) {
+		k_work_reschedule(&g_radio_work, K_NO_WAIT);
+	}
+}
+
+bool ble_is_low_power(void)
+{
+	return atomic_get(&g_low_power) != 0;
+}
+
+void ble_alert_hold(bool on)
+{
+	atomic_set(&g_alert_hold, on);
+}
+
+int ble_alert_send(uint8_t type, const void *payload, size_t len, ble_alert_done_t done)
+{
+	struct bt_conn *conn = g_conn;
+	if (!conn || !g_rec_notify_enabled) {
+		return -ENOTCONN;
+	}
+
+	uint8_t buf[REC_HDR_LEN + 64];
+	int total = rec_build(conn, buf, sizeof(buf), type, payload, len);
+
+	if (total < 0) {
+		return total;
+	}
+
+	struct bt_gatt_notify_params params = {
+		.attr = &log_svc.attrs[5],
+		.data = buf,
+		.len = (uint16_t)total,
+		.func = alert_tx_done,
+	};
+
+	g_alert_done = done;
+	return bt_gatt_notify_cb(conn, &params);
+}
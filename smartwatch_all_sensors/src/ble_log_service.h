@@ -1,4 +1,5 @@
 #pragma once
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -6,3 +7,31 @@ int ble_log_service_init(void);
 
 /* Send log bytes to notify characteristic (UTF-8 text) */
 int ble_log_send_as(const uint8_t *data, size_t len);
+
+/* Send one binary record (see sensor_records.h) on the record characteristic */
+int ble_rec_send(uint8_t type, const void *payload, size_t len);
+
+/* Low-power radio while nobody wears the watch (offwrist_task.c): slow
+ * advertising, a long connection interval with peripheral latency, and only
+ * warnings and errors on the log stream. Safe from any thread.
+ */
+void ble_set_low_power(bool on);
+bool ble_is_low_power(void);
+
+/* High-priority record path (alert_task.c). While held, stream senders
+ * back off so the alert gets the next TX slot; ble_alert_send() never
+ * waits and returns -ENOMEM / -ENOTCONN for the caller to retry. done()
+ * runs from the BT stack once the controller has sent the packet.
+ */
+typedef void (*ble_alert_done_t)(void);
+
+void ble_alert_hold(bool on);
+int ble_alert_send(uint8_t type, const void *payload, size_t len, ble_alert_done_t done);
+
+/* Host writes on the control characteristic (9f7b0003-...): the first byte
+ * selects the handler registered for its range. Handlers run in the BT RX
+ * thread, so they copy what they need and defer slow work.
+ */
+typedef void (*ble_ctrl_cb_t)(const uint8_t *data, size_t len);
+
+int ble_ctrl_register(uint8_t first, uint8_t last, ble_ctrl_cb_t cb);
@@ -0,0 +1,55 @@
+#include "chan_deps.h"
+
+#define CHAN_BIT(c)  (1u << (c))
+
+/* Inputs of each channel's computation */
+static const uint32_t chan_in[CHAN_COUNT] = {
+	[CHAN_SPO2] = CHAN_BIT(CHAN_HR),
+	[CHAN_HRV] = CHAN_BIT(CHAN_HR),
+	[CHAN_RESP] = CHAN_BIT(CHAN_HR),
+	[CHAN_STRESS] = CHAN_BIT(CHAN_HR) | CHAN_BIT(CHAN_HRV) | CHAN_BIT(CHAN_EDA) |
+			CHAN_BIT(CHAN_TEMP),
+};
+
+/* Sensors each channel reads directly; HR takes accel for the motion canceller */
+static const uint8_t chan_sens[CHAN_COUNT] = {
+	[CHAN_HR] = CHAN_SENS_PPG | CHAN_SENS_IMU,
+	[CHAN_SPO2] = CHAN_SENS_PPG,
+	[CHAN_PPG_DIAG] = CHAN_SENS_PPG,
+	[CHAN_EDA] = CHAN_SENS_EDA,
+	[CHAN_TEMP] = CHAN_SENS_TEMP,
+	[CHAN_IMU_EVT] = CHAN_SENS_IMU,
+	[CHAN_QUAT] = CHAN_SENS_IMU,
+	[CHAN_TREMOR] = CHAN_SENS_IMU,
+	[CHAN_FALL] = CHAN_SENS_IMU,
+	[CHAN_ACTIVITY] = CHAN_SENS_IMU,
+	[CHAN_SLEEP] = CHAN_SENS_IMU,
+	[CHAN_WEAR] = CHAN_SENS_IMU | CHAN_SENS_EDA | CHAN_SENS_TEMP,
+};
+
+uint32_t chan_deps_closure(uint32_t chans)
+{
+	uint32_t w = chans, prev;
+
+	do {
+		prev = w;
+		for (int c = 0; c < CHAN_COUNT; c++) {
+			if (w & CHAN_BIT(c)) {
+				w |= chan_in[c];
+			}
+		}
+	} while (w != prev);
+	return w;
+}
+
+uint8_t chan_deps_sensors(uint32_t wanted)
+{
+	uint8_t s = 0;
+
+	for (int c = 0; c < CHAN_COUNT; c++) {
+		if (wanted & CHAN_BIT(c)) {
+			s |= chan_sens[c];
+		}
+	}
+	return s;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+#include "sensor_records.h"
+
+/* What computing a channel takes (chan_sub.h): its input channels, and the
+ * sensors it reads directly. Sleep only reads the IMU; its HR/HRV staging
+ * inputs are subscribed by sleep_task for the night, not listed here.
+ */
+
+/* The channels in chans plus their inputs, transitively */
+uint32_t chan_deps_closure(uint32_t chans);
+
+/* CHAN_SENS_* read by the channels in wanted */
+uint8_t chan_deps_sensors(uint32_t wanted);
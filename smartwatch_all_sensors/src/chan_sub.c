@@ -0,0 +1,156 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#include "ads1113_task.h"
+#include "as6221_task.h"
+#include "ble_log_service.h"
+#include "chan_deps.h"
+#include "chan_sub.h"
+#include "lsm6dso_task.h"
+#include "max30101_task.h"
+
+LOG_MODULE_REGISTER(chan_sub, LOG_LEVEL_INF);
+
+/* default ATT MTU 23: 20-byte notifications */
+BUILD_ASSERT(REC_HDR_LEN + sizeof(struct rec_subs) <= 20);
+
+static struct k_spinlock lock;
+static uint32_t subs[SUB_COUNT];
+static uint16_t period[SUB_COUNT][CHAN_COUNT];
+
+static atomic_t wanted;
+static atomic_t sensors;
+
+static void apply_work_fn(struct k_work *work);
+static K_WORK_DEFINE(apply_work, apply_work_fn);
+
+static void subs_publish(void)
+{
+	uint32_t s[SUB_COUNT];
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	memcpy(s, subs, sizeof(s));
+	k_spin_unlock(&lock, key);
+
+	for (uint8_t i = 0; i < SUB_COUNT; i++) {
+		struct rec_subs rec = {
+			.sub = i,
+			.sensors = (uint8_t)atomic_get(&sensors),
+			.wanted = (uint32_t)atomic_get(&wanted),
+			.chans = s[i],
+		};
+		int err = ble_rec_send(REC_SUBS, &rec, sizeof(rec));
+
+		if (err < 0) {
+			LOG_WRN("SUBS record not sent (%d)", err);
+			return;
+		}
+	}
+}
+
+static void apply_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	uint8_t s = (uint8_t)atomic_get(&sensors);
+
+	max30101_set_enabled(s & CHAN_SENS_PPG);
+	lsm6dso_set_enabled(s & CHAN_SENS_IMU);
+	ads1113_set_enabled(s & CHAN_SENS_EDA);
+	as6221_set_enabled(s & CHAN_SENS_TEMP);
+
+	LOG_INF("Channels 0x%05X, sensors 0x%X", (unsigned)atomic_get(&wanted), s);
+	subs_publish();
+}
+
+/* Subscribed channels plus their inputs; lock held */
+static void recompute(void)
+{
+	uint32_t w = 0;
+
+	for (int i = 0; i < SUB_COUNT; i++) {
+		w |= subs[i];
+	}
+	w = chan_deps_closure(w);
+
+	atomic_set(&wanted, w);
+	atomic_set(&sensors, chan_deps_sensors(w));
+}
+
+void chan_sub_set(uint8_t sub, uint8_t chan, bool on, uint16_t period_ms)
+{
+	if (sub >= SUB_COUNT || chan >= CHAN_COUNT) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (on) {
+		subs[sub] |= BIT(chan);
+	} else {
+		subs[sub] &= ~BIT(chan);
+	}
+	period[sub][chan] = on ? period_ms : 0;
+	recompute();
+	k_spin_unlock(&lock, key);
+
+	/* a mask of changes folds into one pending submit */
+	k_work_submit(&apply_work);
+}
+
+void chan_sub_set_mask(uint8_t sub, uint32_t chans, bool on)
+{
+	for (uint8_t c = 0; c < CHAN_COUNT; c++) {
+		if (chans & BIT(c)) {
+			chan_sub_set(sub, c, on, 0);
+		}
+	}
+}
+
+bool chan_sub_wanted(uint8_t chan)
+{
+	return (atomic_get(&wanted) & BIT(chan)) != 0;
+}
+
+uint32_t chan_sub_period_ms(uint8_t chan, uint32_t dflt)
+{
+	uint32_t p = 0;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	for (int i = 0; i < SUB_COUNT; i++) {
+		if (period[i][chan] && (p == 0 || period[i][chan] < p)) {
+			p = period[i][chan];
+		}
+	}
+	k_spin_unlock(&lock, key);
+	return p ? p : dflt;
+}
+
+static void sub_ctrl(const uint8_t *d, size_t len)
+{
+	if (d[0] == CTRL_SUBS_QUERY) {
+		/* sensor states are re-applied as they are */
+		k_work_submit(&apply_work);
+		return;
+	}
+	if (len < 5) {
+		return;
+	}
+
+	/* the on-device subscribers are the host's to drop as well */
+	uint8_t sub = (len >= 6) ? d[5] : SUB_BLE;
+
+	if (d[1] == CHAN_ALL) {
+		chan_sub_set_mask(sub, BIT_MASK(CHAN_COUNT), d[2] != 0);
+	} else {
+		chan_sub_set(sub, d[1], d[2] != 0, sys_get_le16(&d[3]));
+	}
+}
+
+void chan_sub_init(void)
+{
+	(void)ble_ctrl_register(CTRL_SUBSCRIBE, CTRL_SUBS_QUERY, sub_ctrl);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sensor_records.h"
+
+/* Channel subscriptions. Consumers (SUB_*) subscribe to channels (CHAN_*)
+ * at a period of their choice; a channel is computed only while it is
+ * subscribed or is an input of a computed channel (stress needs HR, HRV,
+ * EDA and skin temperature), and a sensor is powered only while a
+ * computed channel reads it. The central's set follows its notifications
+ * (all record channels with the record CCC, CHAN_LOG with the log CCC);
+ * CTRL_SUBSCRIBE narrows or widens it, or any other subscriber's set, and
+ * REC_SUBS reports the result.
+ */
+void chan_sub_init(void);
+
+void chan_sub_set(uint8_t sub, uint8_t chan, bool on, uint16_t period_ms);
+
+/* Several channels at their default period */
+void chan_sub_set_mask(uint8_t sub, uint32_t chans, bool on);
+
+/* Whether anything consumes chan: skip producing it otherwise */
+bool chan_sub_wanted(uint8_t chan);
+
+/* Shortest period any subscriber asked for, dflt if none did */
+uint32_t chan_sub_period_ms(uint8_t chan, uint32_t dflt);
@@ -0,0 +1,127 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <arm_math.h>
+
+#include "dsp_fixed.h"
+#include "dsp_cycles.h"
+#include "dsp_bench.h"
+
+LOG_MODULE_REGISTER(dsp_bench, LOG_LEVEL_INF);
+
+/* Compares dsp_fixed.h against CMSIS-DSP on the same data (one-shot at boot) */
+
+#define BENCH_N 256
+
+/* 2nd-order Butterworth band-pass 0.5..4 Hz @ 100 Hz (PPG pulse band) */
+static const struct dsp_biquad_coef bp_coef[] = {
+	DSP_BIQUAD(0.0104324134, 0.0208648267, 0.0104324134, -1.7178445866, 0.7634885626),
+	DSP_BIQUAD(1.0, -2.0, 1.0, -1.9585309427, 0.9597079331),
+};
+
+/* 16-tap low-pass, fc = 5 Hz @ 100 Hz */
+static const int16_t lp_taps[] = {
+	DSP_Q15(0.0034089478), DSP_Q15(0.0074202563), DSP_Q15(0.0188462928), DSP_Q15(0.039467152),
+	DSP_Q15(0.0676640772), DSP_Q15(0.0984333687), DSP_Q15(0.1247749368), DSP_Q15(0.1399849684),
+	DSP_Q15(0.1399849684), DSP_Q15(0.1247749368), DSP_Q15(0.0984333687), DSP_Q15(0.0676640772),
+	DSP_Q15(0.039467152),  DSP_Q15(0.0188462928), DSP_Q15(0.0074202563), DSP_Q15(0.0034089478),
+};
+
+static int32_t in[BENCH_N];
+static int32_t out_ref[BENCH_N];
+static int32_t out_dsp[BENCH_N];
+
+static void make_input(void)
+{
+	/* 18-bit PPG-like ramp + square wave, scaled like the HR front end */
+	for (int i = 0; i < BENCH_N; i++) {
+		int32_t v = 100000 + (i * 37) + (((i / 40) & 1) ? 2000 : -2000);
+		in[i] = v << 4;
+	}
+}
+
+static int32_t max_abs_diff(void)
+{
+	int32_t m = 0;
+
+	for (int i = 0; i < BENCH_N; i++) {
+		int32_t d = dsp_abs32(out_ref[i] - out_dsp[i]);
+		if (d > m) {
+			m = d;
+		}
+	}
+	return m;
+}
+
+static void bench_biquad(void)
+{
+	static q31_t cm_coef[5 * ARRAY_SIZE(bp_coef)];
+	static q31_t cm_state[4 * ARRAY_SIZE(bp_coef)];
+	arm_biquad_casd_df1_inst_q31 cm;
+
+	/* CMSIS uses y = ... + a1*y1 + a2*y2, so feedback terms are negated */
+	for (size_t s = 0; s < ARRAY_SIZE(bp_coef); s++) {
+		cm_coef[5 * s + 0] = bp_coef[s].b0;
+		cm_coef[5 * s + 1] = bp_coef[s].b1;
+		cm_coef[5 * s + 2] = bp_coef[s].b2;
+		cm_coef[5 * s + 3] = -bp_coef[s].a1;
+		cm_coef[5 * s + 4] = -bp_coef[s].a2;
+	}
+	arm_biquad_cascade_df1_init_q31(&cm, ARRAY_SIZE(bp_coef), cm_coef, cm_state, 1);
+
+	uint32_t t0 = dsp_cyc_now();
+	arm_biquad_cascade_df1_q31(&cm, in, out_ref, BENCH_N);
+	uint32_t cyc_cmsis = dsp_cyc_now() - t0;
+
+	struct dsp_biquad_state st[ARRAY_SIZE(bp_coef)] = { 0 };
+
+	t0 = dsp_cyc_now();
+	for (int i = 0; i < BENCH_N; i++) {
+		out_dsp[i] = dsp_biquad_cascade_step(bp_coef, st, ARRAY_SIZE(bp_coef), in[i]);
+	}
+	uint32_t cyc_dsp = dsp_cyc_now() - t0;
+
+	LOG_INF("biquad x%u: dsp=%u cyc (%u/smp) cmsis=%u cyc (%u/smp) maxdiff=%d",
+		(unsigned)ARRAY_SIZE(bp_coef), cyc_dsp, cyc_dsp / BENCH_N,
+		cyc_cmsis, cyc_cmsis / BENCH_N, max_abs_diff());
+}
+
+static void bench_fir(void)
+{
+	static q31_t cm_taps[ARRAY_SIZE(lp_taps)];
+	static q31_t cm_state[ARRAY_SIZE(lp_taps) + BENCH_N - 1];
+	static int32_t delay[2 * ARRAY_SIZE(lp_taps)];
+	arm_fir_instance_q31 cm;
+
+	for (size_t k = 0; k < ARRAY_SIZE(lp_taps); k++) {
+		cm_taps[k] = (q31_t)lp_taps[k] << 16;
+	}
+	arm_fir_init_q31(&cm, ARRAY_SIZE(lp_taps), cm_taps, cm_state, BENCH_N);
+
+	uint32_t t0 = dsp_cyc_now();
+	arm_fir_q31(&cm, in, out_ref, BENCH_N);
+	uint32_t cyc_cmsis = dsp_cyc_now() - t0;
+
+	struct dsp_fir fir = DSP_FIR_INIT(lp_taps, delay);
+
+	t0 = dsp_cyc_now();
+	for (int i = 0; i < BENCH_N; i++) {
+		out_dsp[i] = dsp_fir_step(&fir, in[i]);
+	}
+	uint32_t cyc_dsp = dsp_cyc_now() - t0;
+
+	/* arm_fir_q31 truncates (>>31) where dsp_fir_step rounds: allow 1 LSB */
+	LOG_INF("fir %u taps: dsp=%u cyc (%u/smp) cmsis=%u cyc (%u/smp) maxdiff=%d",
+		(unsigned)ARRAY_SIZE(lp_taps), cyc_dsp, cyc_dsp / BENCH_N,
+		cyc_cmsis, cyc_cmsis / BENCH_N, max_abs_diff());
+}
+
+void dsp_bench_run(void)
+{
+	dsp_cyc_init();
+	make_input();
+
+	unsigned int key = irq_lock();
+	bench_biquad();
+	bench_fir();
+	irq_unlock(key);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+/* One-shot dsp_fixed.h vs CMSIS-DSP cycle comparison (CONFIG_CMSIS_DSP_FILTERING) */
+void dsp_bench_run(void);
@@ -0,0 +1,45 @@
+#pragma once
+/* DWT cycle counter (Cortex-M4) for per-sample cost measurements */
+#include <stdint.h>
+#include <cmsis_core.h>
+
+static inline void dsp_cyc_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t dsp_cyc_now(void)
+{
+	return DWT->CYCCNT;
+}
+
+/* Running average of a cycle cost; call add() per item, take() once per report */
+struct dsp_cyc_stat {
+	uint32_t sum;
+	uint32_t n;
+	uint32_t max;
+};
+
+static inline void dsp_cyc_add(struct dsp_cyc_stat *s, uint32_t cyc)
+{
+	s->sum += cyc;
+	s->n++;
+	if (cyc > s->max) {
+		s->max = cyc;
+	}
+}
+
+static inline uint32_t dsp_cyc_take(struct dsp_cyc_stat *s, uint32_t *max)
+{
+	uint32_t avg = s->n ? s->sum / s->n : 0;
+
+	if (max) {
+		*max = s->max;
+	}
+	s->sum = 0;
+	s->n = 0;
+	s->max = 0;
+	return avg;
+}
@@ -0,0 +1,345 @@
+#pragma once
+/*
+ * Fixed-point DSP building blocks (header-only, no heap, no runtime float).
+ *
+ * Samples are int32_t in the sensor's native integer units (keep them
+ * within +/-2^27 so the 64-bit accumulators cannot overflow).
+ * Coefficients are written with DSP_Q30()/DSP_Q15()/DSP_Q16() inside
+ * static const initializers: the compiler folds them to integers at build
+ * time, so the filter topology and taps are fixed at compile time and the
+ * step functions inline into straight-line MAC code when the stage/tap
+ * count is a constant.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ========= Compile-time Q conversion ========= */
+#define DSP_RND_(v)     ((v) >= 0 ? (v) + 0.5 : (v) - 0.5)
+
+#define DSP_Q15(x)      ((int16_t)((x) >= 1.0 ? 32767 : \
+			 (x) <= -1.0 ? -32768 : DSP_RND_((x) * 32768.0)))
+#define DSP_Q16(x)      ((int32_t)DSP_RND_((x) * 65536.0))
+#define DSP_Q30(x)      ((int32_t)DSP_RND_((x) * 1073741824.0))
+
+#define DSP_ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/* ========= Scalar helpers ========= */
+static inline int32_t dsp_sat32(int64_t v)
+{
+	if (v > INT32_MAX) {
+		return INT32_MAX;
+	}
+	if (v < INT32_MIN) {
+		return INT32_MIN;
+	}
+	return (int32_t)v;
+}
+
+static inline int16_t dsp_sat16(int32_t v)
+{
+	if (v > INT16_MAX) {
+		return INT16_MAX;
+	}
+	if (v < INT16_MIN) {
+		return INT16_MIN;
+	}
+	return (int16_t)v;
+}
+
+static inline int32_t dsp_mul_q15(int32_t a, int16_t b)
+{
+	return (int32_t)(((int64_t)a * b + (1 << 14)) >> 15);
+}
+
+static inline int32_t dsp_mul_q30(int32_t a, int32_t b)
+{
+	return dsp_sat32(((int64_t)a * b + (1 << 29)) >> 30);
+}
+
+/* x * k where k is a Q16 gain built with DSP_Q16() (unit conversions) */
+static inline int32_t dsp_scale_q16(int32_t x, int32_t k)
+{
+	return dsp_sat32(((int64_t)x * k + 0x8000) >> 16);
+}
+
+/* |v|, saturated: INT32_MIN gives INT32_MAX */
+static inline int32_t dsp_abs32(int32_t v)
+{
+	return (v >= 0) ? v : (v == INT32_MIN) ? INT32_MAX : -v;
+}
+
+static inline uint32_t dsp_isqrt64(uint64_t v)
+{
+	uint64_t r = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > v) {
+		bit >>= 2;
+	}
+	while (bit) {
+		if (v >= r + bit) {
+			v -= r + bit;
+			r = (r >> 1) + bit;
+		} else {
+			r >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)r;
+}
+
+/* ========= One-pole low-pass (EMA), alpha = 2^-shift ========= */
+struct dsp_ema {
+	int64_t acc;    /* value << shift */
+	uint8_t shift;
+	bool init;
+};
+
+#define DSP_EMA_INIT(sh) { .acc = 0, .shift = (sh), .init = false }
+
+static inline int32_t dsp_ema_step(struct dsp_ema *e, int32_t x)
+{
+	if (!e->init) {
+		e->acc = (int64_t)x << e->shift;
+		e->init = true;
+	} else {
+		e->acc += (int64_t)x - (e->acc >> e->shift);
+	}
+	return (int32_t)(e->acc >> e->shift);
+}
+
+static inline int32_t dsp_ema_get(const struct dsp_ema *e)
+{
+	return (int32_t)(e->acc >> e->shift);
+}
+
+/* ========= Biquad cascade (direct form I, Q30 coefficients) =========
+ * y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2   (a0 normalised to 1)
+ */
+struct dsp_biquad_coef {
+	int32_t b0, b1, b2, a1, a2;
+};
+
+#define DSP_BIQUAD(b0, b1, b2, a1, a2) \
+	{ DSP_Q30(b0), DSP_Q30(b1), DSP_Q30(b2), DSP_Q30(a1), DSP_Q30(a2) }
+
+struct dsp_biquad_state {
+	int32_t x1, x2, y1, y2;
+};
+
+static inline int32_t dsp_biquad_step(const struct dsp_biquad_coef *c,
+				      struct dsp_biquad_state *s, int32_t x)
+{
+	int64_t acc = (int64_t)c->b0 * x
+		    + (int64_t)c->b1 * s->x1
+		    + (int64_t)c->b2 * s->x2
+		    - (int64_t)c->a1 * s->y1
+		    - (int64_t)c->a2 * s->y2;
+	int32_t y = dsp_sat32((acc + (1 << 29)) >> 30);
+
+	s->x2 = s->x1;
+	s->x1 = x;
+	s->y2 = s->y1;
+	s->y1 = y;
+	return y;
+}
+
+/* n_stages should be a compile-time constant so the loop unrolls */
+static inline int32_t dsp_biquad_cascade_step(const struct dsp_biquad_coef *c,
+					      struct dsp_biquad_state *s,
+					      size_t n_stages, int32_t x)
+{
+	for (size_t i = 0; i < n_stages; i++) {
+		x = dsp_biquad_step(&c[i], &s[i], x);
+	}
+	return x;
+}
+
+/* ========= FIR (Q15 taps) =========
+ * delay[] must hold 2*n samples: each input is written twice so the taps
+ * always see a contiguous window and the inner loop has no wrap check.
+ */
+struct dsp_fir {
+	const int16_t *h;
+	int32_t *delay;
+	uint16_t n;
+	uint16_t pos;
+};
+
+#define DSP_FIR_INIT(taps, delay_buf) \
+	{ .h = (taps), .delay = (delay_buf), .n = DSP_ARRAY_LEN(taps), .pos = 0 }
+
+static inline int32_t dsp_fir_step(struct dsp_fir *f, int32_t x)
+{
+	f->pos = (f->pos == 0) ? (uint16_t)(f->n - 1) : (uint16_t)(f->pos - 1);
+	f->delay[f->pos] = x;
+	f->delay[f->pos + f->n] = x;
+
+	const int32_t *d = &f->delay[f->pos];
+	int64_t acc = 0;
+
+	for (uint16_t k = 0; k < f->n; k++) {
+		acc += (int64_t)f->h[k] * d[k];
+	}
+	return dsp_sat32((acc + (1 << 14)) >> 15);
+}
+
+/* ========= Moving window statistics ========= */
+struct dsp_movstat {
+	int32_t *buf;
+	uint16_t n;
+	uint16_t pos;
+	uint16_t count;
+	int64_t sum;
+	int64_t sumsq;
+};
+
+#define DSP_MOVSTAT_INIT(buf_) \
+	{ .buf = (buf_), .n = DSP_ARRAY_LEN(buf_), .pos = 0, .count = 0, .sum = 0, .sumsq = 0 }
+
+static inline void dsp_movstat_reset(struct dsp_movstat *m)
+{
+	m->pos = 0;
+	m->count = 0;
+	m->sum = 0;
+	m->sumsq = 0;
+}
+
+static inline void dsp_movstat_push(struct dsp_movstat *m, int32_t x)
+{
+	if (m->count == m->n) {
+		int32_t old = m->buf[m->pos];
+
+		m->sum -= old;
+		m->sumsq -= (int64_t)old * old;
+	} else {
+		m->count++;
+	}
+
+	m->buf[m->pos] = x;
+	m->sum += x;
+	m->sumsq += (int64_t)x * x;
+
+	if (++m->pos == m->n) {
+		m->pos = 0;
+	}
+}
+
+static inline bool dsp_movstat_full(const struct dsp_movstat *m)
+{
+	return m->count == m->n;
+}
+
+static inline int32_t dsp_movstat_mean(const struct dsp_movstat *m)
+{
+	return m->count ? (int32_t)(m->sum / m->count) : 0;
+}
+
+/* population variance; caller keeps |x| * sqrt(n) well below 2^31 */
+static inline uint32_t dsp_movstat_var(const struct dsp_movstat *m)
+{
+	if (m->count == 0) {
+		return 0;
+	}
+	int64_t v = (m->sumsq - (m->sum * m->sum) / m->count) / m->count;
+
+	return (v > 0) ? (v > UINT32_MAX ? UINT32_MAX : (uint32_t)v) : 0;
+}
+
+static inline uint32_t dsp_movstat_std(const struct dsp_movstat *m)
+{
+	return dsp_isqrt64(dsp_movstat_var(m));
+}
+
+/* ========= Boxcar decimator (pair with an anti-alias biquad) ========= */
+struct dsp_decim {
+	int64_t acc;
+	uint16_t factor;
+	uint16_t cnt;
+};
+
+#define DSP_DECIM_INIT(r) { .acc = 0, .factor = (r), .cnt = 0 }
+
+static inline bool dsp_decim_push(struct dsp_decim *d, int32_t x, int32_t *out)
+{
+	d->acc += x;
+	if (++d->cnt < d->factor) {
+		return false;
+	}
+	*out = (int32_t)(d->acc / d->factor);
+	d->acc = 0;
+	d->cnt = 0;
+	return true;
+}
+
+/* ========= Adaptive-threshold peak detector =========
+ * A peak is a local maximum above the running threshold, at least
+ * 'refractory' samples after the previous one. On each peak the threshold
+ * jumps to peak * track_q8 / 256 and then decays by thr >> decay_shift per
+ * sample, never below thr_min. The three samples around the peak are
+ * returned for sub-sample (parabolic) interpolation.
+ */
+struct dsp_peak {
+	int32_t x1, x2;
+	int32_t thr;
+	int32_t thr_min;
+	uint16_t refractory;
+	uint16_t since;
+	uint8_t decay_shift;
+	uint8_t track_q8;
+};
+
+#define DSP_PEAK_INIT(refr, decay, track, tmin) \
+	{ .x1 = 0, .x2 = 0, .thr = (tmin), .thr_min = (tmin), .refractory = (refr), \
+	  .since = 0, .decay_shift = (decay), .track_q8 = (track) }
+
+static inline bool dsp_peak_push(struct dsp_peak *p, int32_t x, int32_t nb[3])
+{
+	bool hit = false;
+
+	if (p->since < UINT16_MAX) {
+		p->since++;
+	}
+
+	if (p->x1 > p->x2 && p->x1 >= x && p->x1 > p->thr && p->since > p->refractory) {
+		if (nb) {
+			nb[0] = p->x2;
+			nb[1] = p->x1;
+			nb[2] = x;
+		}
+		p->thr = (int32_t)(((int64_t)p->x1 * p->track_q8) >> 8);
+		p->since = 1; /* the peak was one sample ago */
+		hit = true;
+	} else {
+		p->thr -= p->thr >> p->decay_shift;
+	}
+
+	if (p->thr < p->thr_min) {
+		p->thr = p->thr_min;
+	}
+
+	p->x2 = p->x1;
+	p->x1 = x;
+	return hit;
+}
+
+/* Vertex offset of the parabola through nb[0..2], in Q8 samples (-128..128)
+ * relative to nb[1].
+ */
+static inline int32_t dsp_parabolic_q8(const int32_t nb[3])
+{
+	int64_t den = (int64_t)nb[0] - 2 * (int64_t)nb[1] + nb[2];
+
+	if (den == 0) {
+		return 0;
+	}
+	int64_t off = (((int64_t)nb[0] - nb[2]) * 128) / den;
+
+	if (off > 128) {
+		off = 128;
+	} else if (off < -128) {
+		off = -128;
+	}
+	return (int32_t)off;
+}
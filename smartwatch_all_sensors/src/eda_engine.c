@@ -0,0 +1,166 @@
+#include <string.h>
+
+#include "eda_engine.h"
+
+/* 2nd-order Butterworth low-pass 1 Hz @ 4 Hz */
+static const struct dsp_biquad_coef eda_lowpass[1] = {
+	DSP_BIQUAD(0.2928932188, 0.5857864376, 0.2928932188, 0.0, 0.1715728753),
+};
+
+#define EDA_TS_MS           (1000 / EDA_FS_HZ)
+#define EDA_SETTLE_SAMPLES  (2 * EDA_FS_HZ)
+#define EDA_TONIC_FRAC      8       /* tonic kept in nS << 8 */
+#define EDA_TONIC_UP_SHIFT  7       /* rises follow in ~32 s, falls at once */
+#define EDA_ONSET_NS_PER_S  20      /* slope that starts an SCR */
+#define EDA_SCR_MIN_NS      30      /* 0.03 uS, usual amplitude criterion */
+#define EDA_RISE_MIN_MS     500
+#define EDA_RISE_MAX_MS     5000
+#define EDA_G_MAX_NS        100000  /* 100 uS: treat as shorted */
+
+uint32_t eda_uv_to_ns(const struct eda_frontend *fe, int32_t uv)
+{
+	if (uv <= 0) {
+		return 0;
+	}
+	if ((uint32_t)uv >= fe->vexc_uv) {
+		return EDA_G_MAX_NS;
+	}
+
+	uint64_t g = (1000000000ULL * (uint32_t)uv) /
+		     ((uint64_t)fe->rref_ohm * (fe->vexc_uv - (uint32_t)uv));
+
+	return (g > EDA_G_MAX_NS) ? EDA_G_MAX_NS : (uint32_t)g;
+}
+
+void eda_engine_restart(struct eda_engine *e)
+{
+	memset(e->lp, 0, sizeof(e->lp));
+	e->n_samples = 0;
+	e->hist_pos = 0;
+	e->state = EDA_IDLE;
+}
+
+void eda_engine_init(struct eda_engine *e, const struct eda_frontend *fe)
+{
+	memset(e, 0, sizeof(*e));
+	e->fe = *fe;
+}
+
+static void scr_add(struct eda_engine *e, uint32_t onset_ms)
+{
+	e->scr_t[e->scr_pos] = onset_ms;
+	e->scr_pos = (e->scr_pos + 1) % EDA_SCR_HIST;
+	if (e->scr_n < EDA_SCR_HIST) {
+		e->scr_n++;
+	}
+}
+
+bool eda_engine_push(struct eda_engine *e, int32_t uv, uint32_t t_ms, struct eda_scr *scr)
+{
+	int32_t g = (int32_t)eda_uv_to_ns(&e->fe, uv);
+
+	if (e->n_samples == 0) {
+		/* start the filter and tonic at the first value instead of from 0 */
+		for (int i = 0; i < EDA_FS_HZ; i++) {
+			e->hist[i] = g;
+		}
+		e->lp[0] = (struct dsp_biquad_state){ .x1 = g, .x2 = g, .y1 = g, .y2 = g };
+		e->tonic = g << EDA_TONIC_FRAC;
+	}
+
+	int32_t y = dsp_biquad_cascade_step(eda_lowpass, e->lp, 1, g);
+	int32_t slope = y - e->hist[e->hist_pos];      /* nS over the last second */
+	int32_t y_1s = e->hist[e->hist_pos];
+
+	e->hist[e->hist_pos] = y;
+	e->hist_pos = (e->hist_pos + 1) % EDA_FS_HZ;
+	e->g_ns = y;
+
+	/* Tonic: lower envelope, follows falls at once and rises slowly */
+	int32_t yq = y << EDA_TONIC_FRAC;
+
+	if (yq < e->tonic) {
+		e->tonic = yq;
+	} else if (e->state == EDA_IDLE) {
+		e->tonic += (yq - e->tonic) >> EDA_TONIC_UP_SHIFT;
+	}
+
+	if (++e->n_samples < EDA_SETTLE_SAMPLES) {
+		return false;
+	}
+
+	switch (e->state) {
+	case EDA_IDLE:
+		if (slope >= EDA_ONSET_NS_PER_S) {
+			e->state = EDA_RISING;
+			e->onset_ms = t_ms - 1000;
+			e->onset_ns = y_1s;
+			e->onset_tonic = e->tonic >> EDA_TONIC_FRAC;
+			e->peak_ns = y;
+			e->peak_ms = t_ms;
+		}
+		return false;
+
+	case EDA_RISING:
+		if (y > e->peak_ns) {
+			e->peak_ns = y;
+			e->peak_ms = t_ms;
+		}
+		if ((uint32_t)(t_ms - e->onset_ms) > EDA_RISE_MAX_MS + 1000) {
+			e->state = EDA_SETTLE;      /* slow drift, not a response */
+			return false;
+		}
+		if (slope > 0) {
+			return false;
+		}
+		break;
+
+	case EDA_SETTLE:
+	default:
+		if (slope < EDA_ONSET_NS_PER_S / 2) {
+			e->state = EDA_IDLE;
+		}
+		return false;
+	}
+
+	/* Slope turned: the peak is in */
+	e->state = EDA_SETTLE;
+
+	uint32_t rise = e->peak_ms - e->onset_ms;
+	int32_t amp = e->peak_ns - e->onset_ns;
+
+	if (amp < EDA_SCR_MIN_NS || rise < EDA_RISE_MIN_MS || rise > EDA_RISE_MAX_MS) {
+		return false;
+	}
+
+	scr_add(e, e->onset_ms);
+	if (scr) {
+		scr->onset_ms = e->onset_ms;
+		scr->rise_ms = (uint16_t)rise;
+		scr->amp_ns = (uint16_t)((amp > UINT16_MAX) ? UINT16_MAX : amp);
+		scr->tonic_ns = (uint32_t)e->onset_tonic;
+	}
+	return true;
+}
+
+uint32_t eda_engine_tonic_ns(const struct eda_engine *e)
+{
+	return (uint32_t)(e->tonic >> EDA_TONIC_FRAC);
+}
+
+int32_t eda_engine_phasic_ns(const struct eda_engine *e)
+{
+	return e->g_ns - (int32_t)(e->tonic >> EDA_TONIC_FRAC);
+}
+
+uint8_t eda_engine_scr_per_min(const struct eda_engine *e, uint32_t now_ms)
+{
+	uint8_t n = 0;
+
+	for (uint8_t i = 0; i < e->scr_n; i++) {
+		if ((now_ms - e->scr_t[i]) <= 60000) {
+			n++;
+		}
+	}
+	return n;
+}
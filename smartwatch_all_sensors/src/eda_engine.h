@@ -0,0 +1,74 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Streaming EDA: skin conductance, tonic/phasic split and SCR detection.
+ * Fixed at the ADS1113 task rate (EDA_FS_HZ).
+ *
+ * Front end: skin between V_exc and the ADC input, R_ref from the input to
+ * ground, so G_skin = V / (R_ref * (V_exc - V)).
+ */
+#define EDA_FS_HZ       4
+#define EDA_SCR_HIST    16      /* SCR onsets kept for the rate */
+
+struct eda_frontend {
+	uint32_t vexc_uv;
+	uint32_t rref_ohm;
+};
+
+/* 3.3 V excitation, 1 MOhm reference: mid-scale at 1 uS; adjust to the board */
+#define EDA_FRONTEND_DEFAULT { .vexc_uv = 3300000, .rref_ohm = 1000000 }
+
+enum eda_scr_state {
+	EDA_IDLE = 0,
+	EDA_RISING,
+	EDA_SETTLE,     /* wait for the slope to drop before re-arming */
+};
+
+struct eda_scr {
+	uint32_t onset_ms;
+	uint16_t rise_ms;
+	uint16_t amp_ns;
+	uint32_t tonic_ns;      /* tonic level at onset */
+};
+
+struct eda_engine {
+	struct eda_frontend fe;
+	struct dsp_biquad_state lp[1];
+	int32_t  hist[EDA_FS_HZ];   /* last second of smoothed G, for the slope */
+	uint8_t  hist_pos;
+	uint32_t n_samples;
+
+	int32_t  tonic;             /* nS << EDA_TONIC_FRAC */
+	int32_t  g_ns;              /* latest smoothed conductance */
+
+	enum eda_scr_state state;
+	uint32_t onset_ms;
+	int32_t  onset_ns;
+	int32_t  onset_tonic;
+	int32_t  peak_ns;
+	uint32_t peak_ms;
+
+	uint32_t scr_t[EDA_SCR_HIST];
+	uint8_t  scr_n;
+	uint8_t  scr_pos;
+};
+
+void eda_engine_init(struct eda_engine *e, const struct eda_frontend *fe);
+
+/* Contact lost or signal invalid: forget the filters and any SCR in progress */
+void eda_engine_restart(struct eda_engine *e);
+
+/* ADC input voltage to conductance in nS (0 if open circuit, clamps at short) */
+uint32_t eda_uv_to_ns(const struct eda_frontend *fe, int32_t uv);
+
+/* One sample at t_ms. Returns true when an SCR completed (fills *scr). */
+bool eda_engine_push(struct eda_engine *e, int32_t uv, uint32_t t_ms, struct eda_scr *scr);
+
+uint32_t eda_engine_tonic_ns(const struct eda_engine *e);
+int32_t eda_engine_phasic_ns(const struct eda_engine *e);
+
+/* SCRs with onset in the last 60 s */
+uint8_t eda_engine_scr_per_min(const struct eda_engine *e, uint32_t now_ms);
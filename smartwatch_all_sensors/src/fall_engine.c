@@ -0,0 +1,131 @@
+#include <string.h>
+
+#include "fall_engine.h"
+
+#define FALL_REF_SHIFT  6       /* ~0.6 s at 104 Hz */
+
+void fall_engine_init(struct fall_engine *f, const struct fall_cfg *cfg)
+{
+	memset(f, 0, sizeof(*f));
+	f->cfg = *cfg;
+	for (int i = 0; i < 3; i++) {
+		f->ref[i] = (struct dsp_ema)DSP_EMA_INIT(FALL_REF_SHIFT);
+	}
+}
+
+static uint32_t norm3(const int32_t v[3])
+{
+	return dsp_isqrt64((int64_t)v[0] * v[0] + (int64_t)v[1] * v[1] + (int64_t)v[2] * v[2]);
+}
+
+static int8_t cos_x100(const int32_t a[3], const int32_t b[3])
+{
+	int64_t dot = (int64_t)a[0] * b[0] + (int64_t)a[1] * b[1] + (int64_t)a[2] * b[2];
+	int64_t den = (int64_t)norm3(a) * norm3(b);
+
+	return den ? (int8_t)((dot * 100) / den) : 100;
+}
+
+static bool still(const struct fall_engine *f, uint32_t a_norm, const int32_t g[3])
+{
+	int64_t lim = (int64_t)f->cfg.inact_dps * 1000;
+	int64_t g2 = (int64_t)g[0] * g[0] + (int64_t)g[1] * g[1] + (int64_t)g[2] * g[2];
+
+	return g2 < lim * lim && dsp_abs32((int32_t)a_norm - 1000) < f->cfg.inact_mg;
+}
+
+static void track_freefall(struct fall_engine *f, uint32_t a_norm, uint32_t t_ms)
+{
+	if (a_norm < f->cfg.freefall_mg) {
+		if (!f->in_ff) {
+			f->in_ff = true;
+			f->ff_start_ms = t_ms;
+		}
+		return;
+	}
+	if (f->in_ff) {
+		f->in_ff = false;
+		f->ff_end_ms = t_ms;
+		f->ff_ms = (uint16_t)(t_ms - f->ff_start_ms);
+	}
+}
+
+enum fall_evt fall_engine_push(struct fall_engine *f, const int32_t a_mg[3],
+			       const int32_t g_mdps[3], uint32_t t_ms, struct fall_info *info)
+{
+	uint32_t a_norm = norm3(a_mg);
+
+	switch (f->state) {
+	case FALL_IDLE:
+		track_freefall(f, a_norm, t_ms);
+
+		if (a_norm < f->cfg.impact_mg) {
+			/* pre-fall orientation only from non-free-fall samples */
+			if (!f->in_ff) {
+				for (int i = 0; i < 3; i++) {
+					(void)dsp_ema_step(&f->ref[i], a_mg[i]);
+				}
+			}
+			return FALL_NONE;
+		}
+
+		memset(&f->info, 0, sizeof(f->info));
+		f->info.impact_ms = t_ms;
+		f->info.peak_mg = (uint16_t)a_norm;
+		if (f->ff_ms >= f->cfg.freefall_min_ms &&
+		    (uint32_t)(t_ms - f->ff_end_ms) <= f->cfg.window_ms) {
+			f->info.freefall_ms = f->ff_ms;
+		}
+		for (int i = 0; i < 3; i++) {
+			f->ref_at[i] = dsp_ema_get(&f->ref[i]);
+		}
+		f->in_ff = false;
+		f->ff_ms = 0;
+		f->state = FALL_SETTLE;
+		f->t0_ms = t_ms;
+		return FALL_NONE;
+
+	case FALL_SETTLE:
+		if (a_norm > f->info.peak_mg) {
+			f->info.peak_mg = (uint16_t)((a_norm > UINT16_MAX) ? UINT16_MAX : a_norm);
+		}
+		if ((uint32_t)(t_ms - f->t0_ms) >= f->cfg.settle_ms) {
+			memset(f->sum, 0, sizeof(f->sum));
+			f->n = 0;
+			f->state = FALL_INACT;
+			f->t0_ms = t_ms;
+		}
+		return FALL_NONE;
+
+	case FALL_INACT:
+		if (!still(f, a_norm, g_mdps)) {
+			break;
+		}
+		for (int i = 0; i < 3; i++) {
+			f->sum[i] += a_mg[i];
+		}
+		f->n++;
+		if ((uint32_t)(t_ms - f->t0_ms) < f->cfg.inact_ms) {
+			return FALL_NONE;
+		}
+
+		int32_t rest[3] = { f->sum[0] / f->n, f->sum[1] / f->n, f->sum[2] / f->n };
+
+		f->info.cos_x100 = cos_x100(f->ref_at, rest);
+		f->state = FALL_IDLE;
+		*info = f->info;
+
+		bool hard = f->info.freefall_ms || f->info.peak_mg >= f->cfg.impact_hard_mg;
+
+		if (hard && f->info.cos_x100 < f->cfg.tilt_cos_x100) {
+			return FALL_DETECTED;
+		}
+		return FALL_REJECTED;
+	}
+
+	/* moved during the inactivity check: not a fall, back to watching */
+	f->info.cos_x100 = 100;
+	f->state = FALL_IDLE;
+	*info = f->info;
+	return FALL_REJECTED;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Fall detection on the 104 Hz accel/gyro stream:
+ *   free fall   |a| below freefall_mg (optional, raises confidence)
+ *   impact      |a| above impact_mg within window_ms of the free fall
+ *   settle      settle_ms for the bounce to end
+ *   inactivity  inact_ms with |w| < inact_dps and ||a| - 1 g| < inact_mg
+ *   orientation the resting gravity vector differs from the one before the
+ *               impact by more than acos(tilt_cos_x100 / 100)
+ * An impact without free fall must reach impact_hard_mg. At 2 g full scale
+ * a hard impact saturates, so the norm tops out near 3.4 g.
+ */
+struct fall_cfg {
+	uint16_t freefall_mg;
+	uint16_t freefall_min_ms;
+	uint16_t impact_mg;
+	uint16_t impact_hard_mg;
+	uint16_t window_ms;
+	uint16_t settle_ms;
+	uint16_t inact_ms;
+	uint16_t inact_dps;
+	uint16_t inact_mg;
+	int8_t   tilt_cos_x100;
+};
+
+#define FALL_CFG_DEFAULT { \
+	.freefall_mg = 400, .freefall_min_ms = 80, \
+	.impact_mg = 1800, .impact_hard_mg = 2500, .window_ms = 1000, \
+	.settle_ms = 1000, .inact_ms = 2000, .inact_dps = 30, .inact_mg = 120, \
+	.tilt_cos_x100 = 70 }
+
+enum fall_state {
+	FALL_IDLE = 0,
+	FALL_SETTLE,
+	FALL_INACT,
+};
+
+enum fall_evt {
+	FALL_NONE = 0,
+	FALL_DETECTED,
+	FALL_REJECTED,      /* impact, but motion resumed or no orientation change */
+};
+
+struct fall_info {
+	uint32_t impact_ms;
+	uint16_t peak_mg;
+	uint16_t freefall_ms;   /* 0 when none preceded the impact */
+	int8_t   cos_x100;      /* resting vs pre-fall gravity */
+};
+
+struct fall_engine {
+	struct fall_cfg cfg;
+	enum fall_state state;
+
+	struct dsp_ema ref[3];  /* gravity before the event */
+	int32_t  ref_at[3];
+
+	bool     in_ff;
+	uint32_t ff_start_ms;
+	uint32_t ff_end_ms;
+	uint16_t ff_ms;
+
+	uint32_t t0_ms;         /* start of the current state */
+	int32_t  sum[3];
+	uint16_t n;
+	struct fall_info info;
+};
+
+void fall_engine_init(struct fall_engine *f, const struct fall_cfg *cfg);
+
+/* One paired sample; info is filled for FALL_DETECTED / FALL_REJECTED */
+enum fall_evt fall_engine_push(struct fall_engine *f, const int32_t a_mg[3],
+			       const int32_t g_mdps[3], uint32_t t_ms, struct fall_info *info);
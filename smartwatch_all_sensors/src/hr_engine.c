@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "hr_engine.h"
+
+/* 2nd-order Butterworth band-pass 0.5..4 Hz @ 100 Hz (30..240 bpm) */
+const struct dsp_biquad_coef hr_bandpass[HR_BP_STAGES] = {
+	DSP_BIQUAD(0.0104324134, 0.0208648267, 0.0104324134, -1.7178445866, 0.7634885626),
+	DSP_BIQUAD(1.0, -2.0, 1.0, -1.9585309427, 0.9597079331),
+};
+
+#define HR_SETTLE_SAMPLES (2 * HR_FS_HZ)
+#define HR_REFRACTORY     (300 / HR_TS_MS)   /* 200 bpm max */
+#define HR_IBI_MIN_MS     300
+#define HR_IBI_MAX_MS     2000
+#define HR_IBI_TOL_PCT    30      /* vs. running median */
+#define HR_STALE_MS       3000    /* no beat for this long => no estimate */
+#define HR_REJ_RESET      4       /* consecutive rejects => rhythm changed, relearn */
+
+void hr_engine_init(struct hr_engine *hr)
+{
+	memset(hr, 0, sizeof(*hr));
+	hr->peak = (struct dsp_peak)DSP_PEAK_INIT(HR_REFRACTORY, 7, 160, 64);
+}
+
+void hr_engine_restart(struct hr_engine *hr)
+{
+	memset(hr->bp, 0, sizeof(hr->bp));
+	hr->peak = (struct dsp_peak)DSP_PEAK_INIT(HR_REFRACTORY, 7, 160, 64);
+	hr->n_samples = 0;
+	hr->have_last = false;
+}
+
+static uint16_t ibi_median(const struct hr_engine *hr)
+{
+	uint16_t s[HR_IBI_HIST];
+	uint8_t n = hr->ibi_n;
+
+	memcpy(s, hr->ibi, n * sizeof(s[0]));
+	for (uint8_t i = 1; i < n; i++) {
+		uint16_t v = s[i];
+		int j = i - 1;
+
+		while (j >= 0 && s[j] > v) {
+			s[j + 1] = s[j];
+			j--;
+		}
+		s[j + 1] = v;
+	}
+	return n ? s[n / 2] : 0;
+}
+
+static void ibi_add(struct hr_engine *hr, uint16_t ibi)
+{
+	hr->ibi[hr->ibi_pos] = ibi;
+	hr->ibi_pos = (hr->ibi_pos + 1) % HR_IBI_HIST;
+	if (hr->ibi_n < HR_IBI_HIST) {
+		hr->ibi_n++;
+	}
+}
+
+static bool ibi_plausible(const struct hr_engine *hr, uint16_t ibi)
+{
+	if (ibi < HR_IBI_MIN_MS || ibi > HR_IBI_MAX_MS) {
+		return false;
+	}
+	if (hr->ibi_n < 3) {
+		return true;
+	}
+
+	uint32_t med = ibi_median(hr);
+	uint32_t tol = med * HR_IBI_TOL_PCT / 100;
+
+	return (ibi + tol >= med) && (ibi <= med + tol);
+}
+
+bool hr_engine_push(struct hr_engine *hr, uint32_t green, uint32_t t_ms,
+		    struct hr_beat *beat)
+{
+	int32_t bp = dsp_biquad_cascade_step(hr_bandpass, hr->bp, HR_BP_STAGES,
+					     (int32_t)green << HR_IN_SHIFT);
+
+	return hr_engine_push_filtered(hr, bp, t_ms, beat);
+}
+
+bool hr_engine_push_filtered(struct hr_engine *hr, int32_t bp, uint32_t t_ms,
+			     struct hr_beat *beat)
+{
+	/* Pulse = more absorption = less light: invert so systole is a maximum */
+	int32_t y = -bp;
+	int32_t nb[3];
+
+	hr->n_samples++;
+	if (!dsp_peak_push(&hr->peak, y, nb) || hr->n_samples < HR_SETTLE_SAMPLES) {
+		return false;
+	}
+
+	/* Peak sample is one period back; refine with the parabola vertex */
+	uint32_t t_peak = t_ms - HR_TS_MS +
+			  (uint32_t)((dsp_parabolic_q8(nb) * HR_TS_MS) / 256);
+	uint32_t dt = t_peak - hr->last_beat_ms;
+	uint16_t ibi = 0;
+
+	if (hr->have_last && dt <= HR_IBI_MAX_MS) {
+		if (!ibi_plausible(hr, (uint16_t)dt)) {
+			if (hr->rej_cnt < UINT8_MAX) {
+				hr->rej_cnt++;
+			}
+			if (++hr->rej_run >= HR_REJ_RESET) {
+				hr->ibi_n = 0;
+				hr->ibi_pos = 0;
+				hr->rej_run = 0;
+			}
+			/* Only re-anchor on a clearly late beat, so a spurious early
+			 * peak does not cut the next genuine interval short.
+			 */
+			if (dt > ibi_median(hr)) {
+				hr->last_beat_ms = t_peak;
+			}
+			return false;
+		}
+		ibi = (uint16_t)dt;
+		ibi_add(hr, ibi);
+	}
+	hr->rej_run = 0;
+
+	hr->last_beat_ms = t_peak;
+	hr->have_last = true;
+	if (hr->acc_cnt < UINT8_MAX) {
+		hr->acc_cnt++;
+	}
+
+	if (beat) {
+		beat->t_ms = t_peak;
+		beat->ibi_ms = ibi;
+		beat->amp = nb[1];
+	}
+	return true;
+}
+
+void hr_engine_result(struct hr_engine *hr, uint32_t now_ms, struct hr_result *out)
+{
+	memset(out, 0, sizeof(*out));
+	out->n_beats = hr->acc_cnt;
+
+	bool stale = !hr->have_last || (now_ms - hr->last_beat_ms) > HR_STALE_MS;
+
+	if (stale) {
+		hr->ibi_n = 0;
+		hr->ibi_pos = 0;
+	}
+
+	if (hr->ibi_n >= 2) {
+		uint32_t sum = 0;
+		uint64_t sumsq = 0;
+
+		for (uint8_t i = 0; i < hr->ibi_n; i++) {
+			sum += hr->ibi[i];
+			sumsq += (uint32_t)hr->ibi[i] * hr->ibi[i];
+		}
+
+		uint32_t mean = sum / hr->ibi_n;
+		uint64_t var = sumsq / hr->ibi_n - (uint64_t)mean * mean;
+		uint32_t cv_q8 = (dsp_isqrt64(var) << 8) / mean;
+
+		out->bpm_x10 = (uint16_t)(600000 / mean);
+
+		/* Confidence: share of accepted peaks, penalised by IBI spread */
+		uint32_t total = hr->acc_cnt + hr->rej_cnt;
+		uint32_t ratio = total ? (100 * hr->acc_cnt) / total : 100;
+		uint32_t spread = (cv_q8 * 2 > 256) ? 256 : cv_q8 * 2;
+
+		out->conf = (uint8_t)(ratio * (256 - spread) / 256);
+	}
+
+	hr->acc_cnt = 0;
+	hr->rej_cnt = 0;
+}
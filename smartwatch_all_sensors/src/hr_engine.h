@@ -0,0 +1,66 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Streaming heart-rate estimator for the MAX30101 green channel.
+ * Fixed at 100 sps (SPO2_CONFIG SR bits), band-pass 0.5..4 Hz.
+ */
+#define HR_FS_HZ        100
+#define HR_TS_MS        (1000 / HR_FS_HZ)
+#define HR_IBI_HIST     8
+#define HR_BP_STAGES    2
+#define HR_IN_SHIFT     4       /* extra headroom bits for the IIR */
+
+/* Pulse band-pass shared by the PPG engines */
+extern const struct dsp_biquad_coef hr_bandpass[HR_BP_STAGES];
+
+struct hr_beat {
+	uint32_t t_ms;      /* interpolated peak time */
+	uint16_t ibi_ms;    /* 0 for the first beat after a gap */
+	int32_t  amp;       /* band-passed peak amplitude */
+};
+
+struct hr_result {
+	uint16_t bpm_x10;
+	uint8_t  conf;      /* 0..100 */
+	uint8_t  n_beats;   /* accepted beats since the previous result */
+};
+
+struct hr_engine {
+	struct dsp_biquad_state bp[HR_BP_STAGES];
+	struct dsp_peak peak;
+	uint32_t n_samples;
+
+	uint32_t last_beat_ms;
+	bool     have_last;
+
+	uint16_t ibi[HR_IBI_HIST];
+	uint8_t  ibi_n;
+	uint8_t  ibi_pos;
+
+	uint8_t  rej_run;   /* consecutive rejected peaks */
+	uint8_t  acc_cnt;   /* per-result-period counters */
+	uint8_t  rej_cnt;
+};
+
+void hr_engine_init(struct hr_engine *hr);
+
+/* Input changed (other wavelength / gap): re-settle the filter, keep IBI history */
+void hr_engine_restart(struct hr_engine *hr);
+
+/* Feed one raw 18-bit green sample taken at t_ms.
+ * Returns true when a beat was accepted (and fills *beat if non-NULL).
+ */
+bool hr_engine_push(struct hr_engine *hr, uint32_t green, uint32_t t_ms,
+		    struct hr_beat *beat);
+
+/* Same, for a sample already band-passed with hr_bandpass (raw << HR_IN_SHIFT),
+ * e.g. the output of the motion-artifact canceller.
+ */
+bool hr_engine_push_filtered(struct hr_engine *hr, int32_t bp, uint32_t t_ms,
+			     struct hr_beat *beat);
+
+/* Snapshot the estimate and start a new counting period (call at 1 Hz) */
+void hr_engine_result(struct hr_engine *hr, uint32_t now_ms, struct hr_result *out);
@@ -0,0 +1,229 @@
+#include <string.h>
+
+#include "hrv_engine.h"
+
+#define HRV_TS_MS         (1000 / HRV_RESAMPLE_HZ)
+#define HRV_NN50_MS       50
+#define HRV_TD_MIN_IBI    10
+#define HRV_FD_COVER_PCT  75      /* resampled points backed by beats */
+#define HRV_IN_SHIFT      4       /* Goertzel input headroom */
+#define HRV_GAP           INT16_MIN
+
+#define HRV_TWO_PI_Q30    6746518852LL
+
+static uint16_t clamp_u16(uint64_t v)
+{
+	return (uint16_t)((v > UINT16_MAX) ? UINT16_MAX : v);
+}
+
+/* 2 cos(2 pi k / N) for the bins k_lo..k_hi, by the Chebyshev recurrence
+ * seeded with a Taylor cos of the (small) bin spacing.
+ */
+static void goertzel_setup(struct hrv_engine *h)
+{
+	uint32_t w = h->cfg.fd_win_s;
+	int64_t x = HRV_TWO_PI_Q30 / (w * HRV_RESAMPLE_HZ);
+	int64_t x2 = (x * x) >> 30;
+	int64_t c1 = (1LL << 30) - x2 / 2 + ((x2 * x2) >> 30) / 24;
+	int64_t cm1 = 1LL << 30, c = c1;
+
+	/* bins at k / w Hz */
+	h->k_lo = (uint16_t)((4 * w + 99) / 100);       /* 0.04 Hz */
+	h->k_hf = (uint16_t)((15 * w + 99) / 100);      /* 0.15 Hz */
+	h->k_hi = (uint16_t)((40 * w) / 100);           /* 0.40 Hz */
+
+	for (uint16_t k = 1; k <= h->k_hi; k++) {
+		if (k >= h->k_lo) {
+			h->coef_q30[k - h->k_lo] = dsp_sat32(2 * c);
+		}
+
+		int64_t next = ((2 * c1 * c) >> 30) - cm1;
+
+		cm1 = c;
+		c = next;
+	}
+}
+
+void hrv_engine_init(struct hrv_engine *h, const struct hrv_cfg *cfg)
+{
+	memset(h, 0, sizeof(*h));
+	h->cfg = *cfg;
+	if (h->cfg.fd_win_s < HRV_FD_WIN_MIN_S) {
+		h->cfg.fd_win_s = HRV_FD_WIN_MIN_S;
+	}
+	if (h->cfg.fd_win_s > HRV_FD_WIN_MAX_S) {
+		h->cfg.fd_win_s = HRV_FD_WIN_MAX_S;
+	}
+	goertzel_setup(h);
+}
+
+void hrv_engine_beat(struct hrv_engine *h, uint32_t t_ms, uint16_t ibi_ms)
+{
+	h->t_ms[h->head] = t_ms;
+	h->ibi[h->head] = ibi_ms;
+	h->head = (h->head + 1) % HRV_RING;
+	if (h->n < HRV_RING) {
+		h->n++;
+	}
+}
+
+static uint16_t ring_idx(const struct hrv_engine *h, uint16_t i)
+{
+	/* i = 0 is the oldest beat */
+	return (h->head + HRV_RING - h->n + i) % HRV_RING;
+}
+
+static void time_domain(const struct hrv_engine *h, uint32_t now_ms, struct hrv_result *out)
+{
+	uint32_t from = now_ms - (uint32_t)h->cfg.td_win_s * 1000;
+	uint64_t sum = 0, sumsq = 0, sumd2 = 0;
+	uint32_t n = 0, nd = 0, nn50 = 0;
+	uint16_t prev = 0;
+
+	for (uint16_t i = 0; i < h->n; i++) {
+		uint16_t j = ring_idx(h, i);
+		uint16_t ibi = h->ibi[j];
+
+		if ((int32_t)(h->t_ms[j] - from) < 0) {
+			continue;
+		}
+		if (ibi) {
+			sum += ibi;
+			sumsq += (uint32_t)ibi * ibi;
+			n++;
+			if (prev) {
+				int32_t d = (int32_t)ibi - prev;
+
+				sumd2 += (uint64_t)((int64_t)d * d);
+				nd++;
+				nn50 += (d > HRV_NN50_MS || d < -HRV_NN50_MS);
+			}
+		}
+		prev = ibi;
+	}
+
+	out->n_ibi = clamp_u16(n);
+	if (n < HRV_TD_MIN_IBI || nd == 0) {
+		return;
+	}
+
+	/* x100 under the root gives x10 ms; no truncated mean in the variance */
+	uint64_t var_x100 = ((sumsq * n - sum * sum) * 100) / ((uint64_t)n * n);
+
+	out->sdnn_x10 = clamp_u16(dsp_isqrt64(var_x100));
+	out->rmssd_x10 = clamp_u16(dsp_isqrt64((sumd2 * 100) / nd));
+	out->pnn50 = (uint8_t)((nn50 * 100) / nd);
+	out->td_ok = true;
+}
+
+/* Resample the IBI series onto the HRV_RESAMPLE_HZ grid ending at now_ms,
+ * linear between beats; returns the number of grid points backed by beats.
+ */
+static uint32_t resample(struct hrv_engine *h, uint32_t now_ms, uint32_t len)
+{
+	uint32_t tg = now_ms - len * HRV_TS_MS;
+	uint32_t g = 0, covered = 0;
+	uint32_t pt = 0;
+	int32_t pv = 0;
+	bool have_prev = false;
+
+	for (uint16_t i = 0; i < h->n && g < len; i++) {
+		uint16_t j = ring_idx(h, i);
+		uint32_t t = h->t_ms[j];
+		int32_t v = h->ibi[j];
+
+		if (v == 0) {
+			have_prev = false;
+			continue;
+		}
+
+		while (g < len && (int32_t)(tg - t) < 0) {
+			if (have_prev && (int32_t)(tg - pt) >= 0) {
+				h->buf[g] = (int16_t)(pv + (v - pv) * (int32_t)(tg - pt) /
+						      (int32_t)(t - pt));
+				covered++;
+			} else {
+				h->buf[g] = HRV_GAP;
+			}
+			g++;
+			tg += HRV_TS_MS;
+		}
+
+		pt = t;
+		pv = v;
+		have_prev = true;
+	}
+
+	/* after the last beat: not covered */
+	for (; g < len; g++) {
+		h->buf[g] = HRV_GAP;
+	}
+	return covered;
+}
+
+static int64_t goertzel_pow(const int16_t *x, uint32_t len, int32_t coef)
+{
+	int64_t s1 = 0, s2 = 0;
+
+	for (uint32_t i = 0; i < len; i++) {
+		int64_t s0 = ((int64_t)x[i] << HRV_IN_SHIFT) + ((coef * s1) >> 30) - s2;
+
+		s2 = s1;
+		s1 = s0;
+	}
+	return s1 * s1 + s2 * s2 - ((coef * s1) >> 30) * s2;
+}
+
+static void freq_domain(struct hrv_engine *h, uint32_t now_ms, struct hrv_result *out)
+{
+	uint32_t len = (uint32_t)h->cfg.fd_win_s * HRV_RESAMPLE_HZ;
+	uint32_t covered = resample(h, now_ms, len);
+
+	if (covered * 100 < len * HRV_FD_COVER_PCT) {
+		return;
+	}
+
+	int64_t sum = 0;
+
+	for (uint32_t i = 0; i < len; i++) {
+		if (h->buf[i] != HRV_GAP) {
+			sum += h->buf[i];
+		}
+	}
+
+	int32_t mean = (int32_t)(sum / covered);
+
+	for (uint32_t i = 0; i < len; i++) {
+		h->buf[i] = (h->buf[i] == HRV_GAP) ? 0 : (int16_t)(h->buf[i] - mean);
+	}
+
+	int64_t lf = 0, hf = 0;
+
+	for (uint16_t k = h->k_lo; k <= h->k_hi; k++) {
+		int64_t p = goertzel_pow(h->buf, len, h->coef_q30[k - h->k_lo]);
+
+		if (k < h->k_hf) {
+			lf += p;
+		} else {
+			hf += p;
+		}
+	}
+
+	/* one-sided band power: 2 |X|^2 / N^2, minus the input headroom */
+	int64_t norm = (int64_t)len * len << (2 * HRV_IN_SHIFT - 1);
+
+	lf = (lf > 0) ? lf / norm : 0;
+	hf = (hf > 0) ? hf / norm : 0;
+
+	out->lf_ms2 = clamp_u16((uint64_t)lf);
+	out->hf_ms2 = clamp_u16((uint64_t)hf);
+	out->lf_hf_x100 = hf ? clamp_u16((uint64_t)((lf * 100) / hf)) : 0;
+	out->fd_ok = hf > 0;
+}
+
+void hrv_engine_result(struct hrv_engine *h, uint32_t now_ms, struct hrv_result *out)
+{
+	memset(out, 0, sizeof(*out));
+	time_domain(h, now_ms, out);
+	freq_domain(h, now_ms, out);
+}
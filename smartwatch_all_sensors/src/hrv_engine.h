@@ -0,0 +1,59 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Heart-rate variability from the beat series hr_engine produces.
+ * Time domain (RMSSD, SDNN, pNN50) over the last td_win_s seconds.
+ * Frequency domain over the last fd_win_s seconds: the IBI series is
+ * resampled to HRV_RESAMPLE_HZ, mean-removed, and LF (0.04..0.15 Hz) / HF
+ * (0.15..0.4 Hz) power is summed from Goertzel bins at 1/fd_win_s spacing.
+ */
+#define HRV_RING          384     /* beats kept: 180 s at 128 bpm */
+#define HRV_RESAMPLE_HZ   4
+#define HRV_FD_WIN_MIN_S  60
+#define HRV_FD_WIN_MAX_S  180
+#define HRV_FD_LEN_MAX    (HRV_FD_WIN_MAX_S * HRV_RESAMPLE_HZ)
+#define HRV_BINS_MAX      ((HRV_FD_WIN_MAX_S * 36) / 100 + 2)
+
+struct hrv_cfg {
+	uint16_t td_win_s;
+	uint16_t fd_win_s;    /* clamped to HRV_FD_WIN_MIN_S..HRV_FD_WIN_MAX_S */
+};
+
+#define HRV_CFG_DEFAULT { .td_win_s = 60, .fd_win_s = 120 }
+
+struct hrv_result {
+	uint16_t rmssd_x10;   /* ms */
+	uint16_t sdnn_x10;    /* ms */
+	uint8_t  pnn50;       /* % */
+	uint16_t n_ibi;       /* IBIs in the time-domain window */
+	uint16_t lf_ms2;
+	uint16_t hf_ms2;
+	uint16_t lf_hf_x100;  /* 0 when the spectrum is not available */
+	bool     td_ok;
+	bool     fd_ok;
+};
+
+struct hrv_engine {
+	struct hrv_cfg cfg;
+
+	uint32_t t_ms[HRV_RING];
+	uint16_t ibi[HRV_RING];       /* 0 = gap before this beat */
+	uint16_t head;
+	uint16_t n;
+
+	/* Goertzel bins covering LF..HF for cfg.fd_win_s */
+	int32_t  coef_q30[HRV_BINS_MAX];  /* 2 cos(2 pi k / N) */
+	uint16_t k_lo, k_hf, k_hi;        /* first LF, first HF, last HF bin */
+	int16_t  buf[HRV_FD_LEN_MAX];
+};
+
+void hrv_engine_init(struct hrv_engine *h, const struct hrv_cfg *cfg);
+
+/* One accepted beat; ibi_ms == 0 for the first beat after a gap */
+void hrv_engine_beat(struct hrv_engine *h, uint32_t t_ms, uint16_t ibi_ms);
+
+/* Compute both domains over the windows ending at now_ms */
+void hrv_engine_result(struct hrv_engine *h, uint32_t now_ms, struct hrv_result *out);
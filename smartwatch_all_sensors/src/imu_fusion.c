@@ -0,0 +1,132 @@
+#include <string.h>
+
+#include "imu_fusion.h"
+
+#define FUS_ONE           (1 << 30)
+#define FUS_MDPS_TO_Q24   19190098LL      /* pi / 180000 * 2^40, >> 16 */
+
+static int32_t mul30(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+static void gravity(struct imu_fusion *f)
+{
+	const int32_t *q = f->q;
+
+	f->grav[0] = (int32_t)((2 * ((int64_t)q[1] * q[3] - (int64_t)q[0] * q[2])) >> 30);
+	f->grav[1] = (int32_t)((2 * ((int64_t)q[0] * q[1] + (int64_t)q[2] * q[3])) >> 30);
+	f->grav[2] = (int32_t)(((int64_t)q[0] * q[0] - (int64_t)q[1] * q[1] -
+				(int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> 30);
+}
+
+void imu_fusion_init(struct imu_fusion *f, const struct imu_fusion_cfg *cfg)
+{
+	memset(f, 0, sizeof(*f));
+	f->cfg = *cfg;
+	f->q[0] = FUS_ONE;
+	gravity(f);
+}
+
+/* Proportional + integral feedback from the accel/gravity cross product */
+static void accel_feedback(struct imu_fusion *f, const int32_t a_mg[3],
+			   uint32_t dt_us, int32_t w[3])
+{
+	uint32_t norm = dsp_isqrt64((int64_t)a_mg[0] * a_mg[0] +
+				    (int64_t)a_mg[1] * a_mg[1] +
+				    (int64_t)a_mg[2] * a_mg[2]);
+
+	if (norm == 0 || dsp_abs32((int32_t)norm - 1000) > f->cfg.acc_gate_mg) {
+		return;
+	}
+
+	int32_t inv = FUS_ONE / (int32_t)norm;
+	int32_t a[3], e[3];
+
+	for (int i = 0; i < 3; i++) {
+		a[i] = a_mg[i] * inv;
+	}
+
+	/* e = a x g, ~sin of the tilt error */
+	e[0] = mul30(a[1], f->grav[2]) - mul30(a[2], f->grav[1]);
+	e[1] = mul30(a[2], f->grav[0]) - mul30(a[0], f->grav[2]);
+	e[2] = mul30(a[0], f->grav[1]) - mul30(a[1], f->grav[0]);
+
+	int64_t kp = f->cfg.kp_x1000;
+
+	if (f->age_ms < f->cfg.settle_ms) {
+		kp *= IMU_FUSION_SETTLE_GAIN;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		/* Q30 -> Q24, gains x1000, dt in us */
+		f->bias[i] += (int32_t)(((int64_t)e[i] * f->cfg.ki_x1000 * dt_us / 1000000000) >> 6);
+		w[i] += (int32_t)(((int64_t)e[i] * kp / 1000) >> 6) + f->bias[i];
+	}
+}
+
+void imu_fusion_update(struct imu_fusion *f, const int32_t g_mdps[3],
+		       const int32_t a_mg[3], uint32_t dt_us)
+{
+	if (dt_us == 0 || dt_us > IMU_FUSION_MAX_DT_US) {
+		return;
+	}
+
+	int32_t w[3], h[3];
+
+	for (int i = 0; i < 3; i++) {
+		w[i] = (int32_t)(((int64_t)g_mdps[i] * FUS_MDPS_TO_Q24) >> 16);
+	}
+	accel_feedback(f, a_mg, dt_us, w);
+
+	/* half rotation angle this step, Q30 rad */
+	for (int i = 0; i < 3; i++) {
+		h[i] = (int32_t)(((int64_t)w[i] * 64 * dt_us) / 2000000);
+	}
+
+	/* q += q (x) (0, h) */
+	int32_t *q = f->q;
+	int64_t dw = -(int64_t)q[1] * h[0] - (int64_t)q[2] * h[1] - (int64_t)q[3] * h[2];
+	int64_t dx =  (int64_t)q[0] * h[0] + (int64_t)q[2] * h[2] - (int64_t)q[3] * h[1];
+	int64_t dy =  (int64_t)q[0] * h[1] - (int64_t)q[1] * h[2] + (int64_t)q[3] * h[0];
+	int64_t dz =  (int64_t)q[0] * h[2] + (int64_t)q[1] * h[1] - (int64_t)q[2] * h[0];
+
+	q[0] += (int32_t)(dw >> 30);
+	q[1] += (int32_t)(dx >> 30);
+	q[2] += (int32_t)(dy >> 30);
+	q[3] += (int32_t)(dz >> 30);
+
+	/* |q| stays within O(h^2) of 1: one Newton step for 1/|q| suffices */
+	int64_t n2 = 0;
+
+	for (int i = 0; i < 4; i++) {
+		n2 += (int64_t)q[i] * q[i];
+	}
+	int32_t inv = (int32_t)((3LL * FUS_ONE - (n2 >> 30)) / 2);
+
+	for (int i = 0; i < 4; i++) {
+		q[i] = mul30(q[i], inv);
+	}
+
+	gravity(f);
+	f->age_ms += dt_us / 1000;
+	if (f->age_ms > f->cfg.settle_ms) {
+		f->age_ms = f->cfg.settle_ms;
+	}
+}
+
+void imu_fusion_linear_mg(const struct imu_fusion *f, const int32_t a_mg[3], int32_t lin[3])
+{
+	for (int i = 0; i < 3; i++) {
+		lin[i] = a_mg[i] - (int32_t)(((int64_t)f->grav[i] * 1000) >> 30);
+	}
+}
+
+void imu_fusion_quat_q15(const struct imu_fusion *f, int16_t q[4])
+{
+	int32_t s = (f->q[0] < 0) ? -1 : 1;
+
+	for (int i = 0; i < 4; i++) {
+		q[i] = dsp_sat16(s * (f->q[i] >> 15));
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Mahony complementary filter in fixed point: the gyro is integrated into
+ * a unit quaternion and the accelerometer pulls the estimated gravity back
+ * with proportional + integral (gyro bias) feedback. Accel correction is
+ * skipped while | |a| - 1 g | > acc_gate_mg, i.e. under linear acceleration.
+ * Quaternion and gravity are Q30, angular rates rad/s Q24.
+ */
+struct imu_fusion_cfg {
+	uint16_t kp_x1000;      /* 1/s */
+	uint16_t ki_x1000;      /* 1/s^2 */
+	uint16_t acc_gate_mg;
+	uint16_t settle_ms;     /* kp x IMU_FUSION_SETTLE_GAIN after init */
+};
+
+#define IMU_FUSION_CFG_DEFAULT \
+	{ .kp_x1000 = 1000, .ki_x1000 = 10, .acc_gate_mg = 150, .settle_ms = 2000 }
+
+#define IMU_FUSION_SETTLE_GAIN  10
+#define IMU_FUSION_MAX_DT_US    50000   /* longer gaps are not integrated */
+
+struct imu_fusion {
+	struct imu_fusion_cfg cfg;
+	int32_t  q[4];          /* w x y z */
+	int32_t  bias[3];       /* integral feedback */
+	int32_t  grav[3];       /* gravity direction in the sensor frame */
+	uint32_t age_ms;
+};
+
+void imu_fusion_init(struct imu_fusion *f, const struct imu_fusion_cfg *cfg);
+
+/* One paired gyro (mdps) + accel (mg) sample, dt_us after the previous one */
+void imu_fusion_update(struct imu_fusion *f, const int32_t g_mdps[3],
+		       const int32_t a_mg[3], uint32_t dt_us);
+
+/* a_mg with the current gravity estimate removed */
+void imu_fusion_linear_mg(const struct imu_fusion *f, const int32_t a_mg[3], int32_t lin[3]);
+
+/* Quaternion as Q15 with w >= 0 (q and -q are the same rotation) */
+void imu_fusion_quat_q15(const struct imu_fusion *f, int16_t q[4]);
@@ -1,4 +1,5 @@
 #include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
 #include <zephyr/logging/log_backend.h>
 #include <zephyr/logging/log_output.h>
 #include <zephyr/logging/log_msg.h>
@@ -6,6 +7,7 @@
 #include <string.h>
 
 #include "ble_log_service.h"
+#include "chan_sub.h"
 
 /* IMPORTANT: Do NOT use LOG_INF/LOG_ERR inside a log backend */
 
@@ -27,6 +29,16 @@ static void backend_process(const struct log_backend *const backend,
 
 	struct log_msg *m = (struct log_msg *)&msg->log;
 
+	/* no subscriber: skip the formatting too */
+	if (!chan_sub_wanted(CHAN_LOG)) {
+		return;
+	}
+
+	/* low-power radio: the text stream is most of the traffic */
+	if (ble_is_low_power() && log_msg_get_level(m) > LOG_LEVEL_WRN) {
+		return;
+	}
+
 	/* Format & emit message */
 	log_output_msg_process(&ble_log_output, m, 0U);
 
@@ -0,0 +1,221 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include "ble_log_service.h"
+#include "lsm6dso_fsm.h"
+#include "sensor_records.h"
+#include "w25n01_task.h"
+
+LOG_MODULE_REGISTER(lsm6dso_fsm, LOG_LEVEL_INF);
+
+#define FSM_MAGIC     0x314D5346   /* "FSM1" */
+#define FSM_PAGE      (W25N01_BLOCK_FSM * W25N01_PAGES_PER_BLOCK)
+
+/* NAND page layout: header, then n_ops reg/val pairs */
+struct fsm_hdr {
+	uint32_t magic;
+	uint16_t n_ops;
+	uint16_t crc;          /* CRC-16/CCITT (0xFFFF seed) over the pairs */
+} __packed;
+
+BUILD_ASSERT(sizeof(struct fsm_hdr) + FSM_PROG_MAX_OPS * sizeof(struct fsm_op) <=
+	     W25N01_PAGE_SIZE);
+
+/* Active program, replayed by the IMU thread */
+static K_MUTEX_DEFINE(prog_lock);
+static struct fsm_op prog[FSM_PROG_MAX_OPS];
+static uint16_t prog_n;
+static atomic_t changed;
+
+/* Upload in progress; written by the BT RX thread, consumed by commit_work */
+static struct fsm_op up[FSM_PROG_MAX_OPS];
+static uint16_t up_n, up_got, up_crc;
+static int up_err;
+static bool up_clear;
+static atomic_t busy;
+
+static uint16_t prog_crc(const struct fsm_op *ops, uint16_t n)
+{
+	return crc16_itu_t(0xFFFF, (const uint8_t *)ops, n * sizeof(*ops));
+}
+
+static void ack(uint8_t op, int err, uint16_t arg)
+{
+	struct rec_ctrl_ack rec = {
+		.op = op,
+		.err = (int8_t)err,
+		.arg = arg,
+	};
+	(void)ble_rec_send(REC_CTRL_ACK, &rec, sizeof(rec));
+}
+
+static int store(const struct fsm_op *ops, uint16_t n)
+{
+	static uint8_t page[sizeof(struct fsm_hdr) + sizeof(prog)];
+	struct fsm_hdr h = {
+		.magic = FSM_MAGIC,
+		.n_ops = n,
+		.crc = prog_crc(ops, n),
+	};
+	int ret = w25n01_erase_block(W25N01_BLOCK_FSM);
+
+	if (ret || n == 0) {
+		/* erased block reads back as no program */
+		return ret;
+	}
+	memcpy(page, &h, sizeof(h));
+	memcpy(&page[sizeof(h)], ops, n * sizeof(*ops));
+	return w25n01_write_page(FSM_PAGE, page, sizeof(h) + n * sizeof(*ops));
+}
+
+static void activate(const struct fsm_op *ops, uint16_t n)
+{
+	k_mutex_lock(&prog_lock, K_FOREVER);
+	memcpy(prog, ops, n * sizeof(*ops));
+	prog_n = n;
+	k_mutex_unlock(&prog_lock);
+	atomic_set(&changed, 1);
+}
+
+static void commit_work_fn(struct k_work *w)
+{
+	ARG_UNUSED(w);
+
+	uint8_t op = up_clear ? CTRL_FSM_CLEAR : CTRL_FSM_COMMIT;
+	uint16_t n = up_clear ? 0 : up_n;
+	int err = up_err;
+
+	if (!err && !up_clear) {
+		if (up_got != up_n) {
+			err = -EPROTO;
+		} else if (prog_crc(up, up_n) != up_crc) {
+			err = -EBADMSG;
+		}
+	}
+	if (!err) {
+		err = store(up, n);
+	}
+	if (!err) {
+		activate(up, n);
+		LOG_INF("FSM program %s (%u ops)", n ? "stored" : "cleared", n);
+	} else {
+		LOG_ERR("FSM %s failed (%d)", up_clear ? "clear" : "commit", err);
+	}
+
+	up_n = 0;
+	up_got = 0;
+	atomic_set(&busy, 0);
+	ack(op, err, n);
+}
+
+static K_WORK_DEFINE(commit_work, commit_work_fn);
+
+/* BT RX thread: only bookkeeping here, NAND work goes to the workqueue */
+static void ctrl_cb(const uint8_t *d, size_t len)
+{
+	if (atomic_get(&busy)) {
+		/* commit still running: the host retries after this */
+		ack(d[0], -EBUSY, 0);
+		return;
+	}
+
+	switch (d[0]) {
+	case CTRL_FSM_BEGIN:
+		if (len < 3) {
+			return;
+		}
+		up_n = sys_get_le16(&d[1]);
+		up_got = 0;
+		up_err = (up_n == 0 || up_n > FSM_PROG_MAX_OPS) ? -EFBIG : 0;
+		break;
+	case CTRL_FSM_DATA: {
+		if (len < 3 || up_err) {
+			return;
+		}
+		uint16_t idx = sys_get_le16(&d[1]);
+		uint16_t n = (uint16_t)((len - 3) / sizeof(struct fsm_op));
+
+		/* writes with response arrive in order; anything else breaks the upload */
+		if (idx != up_got || up_got + n > up_n) {
+			up_err = -EPROTO;
+			return;
+		}
+		memcpy(&up[up_got], &d[3], n * sizeof(struct fsm_op));
+		up_got += n;
+		break;
+	}
+	case CTRL_FSM_COMMIT:
+		if (len < 3) {
+			return;
+		}
+		up_crc = sys_get_le16(&d[1]);
+		up_clear = false;
+		atomic_set(&busy, 1);
+		k_work_submit(&commit_work);
+		break;
+	case CTRL_FSM_CLEAR:
+		up_clear = true;
+		atomic_set(&busy, 1);
+		k_work_submit(&commit_work);
+		break;
+	default:
+		break;
+	}
+}
+
+static void load(void)
+{
+	struct fsm_hdr h;
+
+	if (w25n01_read_page(FSM_PAGE, 0, &h, sizeof(h))) {
+		LOG_WRN("NAND not available, no FSM program");
+		return;
+	}
+	if (h.magic != FSM_MAGIC || h.n_ops == 0 || h.n_ops > FSM_PROG_MAX_OPS) {
+		LOG_INF("No stored FSM program");
+		return;
+	}
+	if (w25n01_read_page(FSM_PAGE, sizeof(h), up, h.n_ops * sizeof(struct fsm_op)) ||
+	    prog_crc(up, h.n_ops) != h.crc) {
+		LOG_ERR("Stored FSM program corrupt");
+		return;
+	}
+
+	k_mutex_lock(&prog_lock, K_FOREVER);
+	memcpy(prog, up, h.n_ops * sizeof(struct fsm_op));
+	prog_n = h.n_ops;
+	k_mutex_unlock(&prog_lock);
+	LOG_INF("Loaded FSM program (%u ops)", h.n_ops);
+}
+
+void lsm6dso_fsm_init(void)
+{
+	load();
+	(void)ble_ctrl_register(CTRL_FSM_BEGIN, CTRL_FSM_CLEAR, ctrl_cb);
+}
+
+int lsm6dso_fsm_apply(fsm_write_fn write)
+{
+	int ret = 0;
+
+	k_mutex_lock(&prog_lock, K_FOREVER);
+	for (uint16_t i = 0; i < prog_n && ret == 0; i++) {
+		if (prog[i].reg == FSM_OP_WAIT) {
+			k_msleep(prog[i].val);
+		} else {
+			ret = write(prog[i].reg, prog[i].val);
+		}
+	}
+	if (ret == 0) {
+		ret = prog_n;
+	}
+	k_mutex_unlock(&prog_lock);
+	return ret;
+}
+
+bool lsm6dso_fsm_changed(void)
+{
+	return atomic_cas(&changed, 1, 0);
+}
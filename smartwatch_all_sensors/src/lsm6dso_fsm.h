@@ -0,0 +1,31 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Host-loadable LSM6DSO finite-state-machine programs.
+ * A program is the register write sequence of an ST .ucf file (bank
+ * switches, FSM page writes, enables), generated offline. Entries with
+ * reg == FSM_OP_WAIT sleep for val ms. Programs arrive on the control
+ * characteristic (CTRL_FSM_*), are kept in NAND block W25N01_BLOCK_FSM and
+ * replayed by lsm6dso_task on every sensor configuration.
+ */
+#define FSM_PROG_MAX_OPS  1020     /* one NAND page with the header */
+#define FSM_OP_WAIT       0xFF
+
+struct fsm_op {
+	uint8_t reg;
+	uint8_t val;
+};
+
+typedef int (*fsm_write_fn)(uint8_t reg, uint8_t val);
+
+/* Register the control handler and load the stored program, if any */
+void lsm6dso_fsm_init(void);
+
+/* Replay the active program through write(). Returns ops applied (0 when
+ * there is no program) or the first write error.
+ */
+int lsm6dso_fsm_apply(fsm_write_fn write);
+
+/* True once after a program was committed or cleared from the host */
+bool lsm6dso_fsm_changed(void);
@@ -5,38 +5,186 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
 
+#include "acq_batch.h"
+#include "activity_task.h"
+#include "alert_task.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "dsp_cycles.h"
+#include "dsp_fixed.h"
+#include "fall_engine.h"
+#include "imu_fusion.h"
+#include "lsm6dso_fsm.h"
+#include "motion_shared.h"
+#include "sensor_records.h"
+#include "spectral_engine.h"
+
 LOG_MODULE_REGISTER(lsm6dso_app, LOG_LEVEL_INF);
 
 /* ========= Your Pins (per your mapping) ========= */
 #define GPIO0_NODE DT_NODELABEL(gpio0)
 
 #define LSM6DSO_CS_PIN    4    /* P0.04 -> LSM6DSO_CS (force HIGH for I2C mode) */
-#define LSM6DSO_INT2_PIN  5    /* P0.05 -> LSM6DSO_INT2 (optional) */
+#define LSM6DSO_INT2_PIN  5    /* P0.05 -> LSM6DSO_INT2 (embedded functions + tap) */
 #define LSM6DSO_INT1_PIN  28   /* P0.28 -> LSM6DSO_INT1 (optional) */
 
 /* ========= LSM6DSO Registers ========= */
+#define REG_FUNC_CFG_ACCESS 0x01
 #define REG_WHO_AM_I      0x0F
 #define WHO_AM_I_VAL      0x6C
 
+#define REG_FIFO_CTRL3    0x09
+#define REG_FIFO_CTRL4    0x0A
 #define REG_CTRL1_XL      0x10
 #define REG_CTRL2_G       0x11
 #define REG_CTRL3_C       0x12
+#define REG_CTRL6_C       0x15
+#define REG_CTRL10_C      0x19
+#define REG_WAKE_UP_SRC   0x1B
+#define REG_TAP_SRC       0x1C
+#define REG_FIFO_STATUS1  0x3A
+#define REG_FIFO_STATUS2  0x3B
+#define REG_TAP_CFG0      0x56
+#define REG_TAP_CFG1      0x57
+#define REG_TAP_CFG2      0x58
+#define REG_TAP_THS_6D    0x59
+#define REG_INT_DUR2      0x5A
+#define REG_WAKE_UP_THS   0x5B
+#define REG_WAKE_UP_DUR   0x5C
+#define REG_MD2_CFG       0x5F
+#define REG_FIFO_DATA_OUT_TAG 0x78  /* tag + 6 data bytes; burst reads roll back here */
 
-#define REG_OUTX_L_G      0x22  /* burst from here reads gyro then accel (12 bytes) */
+/* Embedded function bank (FUNC_CFG_ACCESS = 0x80) */
+#define EMB_FUNC_EN_A     0x04
+#define EMB_FUNC_EN_B     0x05
+#define EMB_FSM_INT1_A    0x0B
+#define EMB_FSM_INT1_B    0x0C
+#define EMB_FUNC_INT2     0x0E
+#define EMB_FSM_INT2_A    0x0F
+#define EMB_FSM_INT2_B    0x10
+#define EMB_FUNC_STATUS   0x12
+#define EMB_FSM_STATUS_A  0x13
+#define EMB_PAGE_RW       0x17
+#define EMB_FSM_ENABLE_A  0x46
+#define EMB_FSM_ENABLE_B  0x47
+#define EMB_STEP_COUNTER_L 0x62
+#define EMB_FUNC_SRC      0x64
+#define EMB_FUNC_INIT_A   0x66
 
-#define CTRL1_XL_104HZ_2G     0x40
-#define CTRL2_G_104HZ_250DPS  0x40
+#define CTRL1_XL_2G(odr)      ((odr) << 4)
+#define ODR_OFF               0x0
+#define ODR_26HZ              0x2
+#define ODR_104HZ             0x4
+#define ODR_416HZ             0x6
+#define ODR_833HZ             0x7
+#define ODR_1666HZ            0x8
+#define CTRL2_G_250DPS(odr)   ((odr) << 4)
 #define CTRL3_C_BDU_IFINC     0x44
+#define CTRL3_C_SW_RESET      0x01
+#define CTRL6_C_XL_HM_OFF     0x10  /* accel low-power mode below 208 Hz */
+#define CTRL10_C_TIMESTAMP_EN 0x20
+
+#define FUNC_CFG_ACCESS_EMB   0x80
+
+/* Pedometer, tilt and significant motion: enable, latch (cleared by
+ * reading EMB_FUNC_STATUS), reset the algorithms. Tilt and significant
+ * motion go to INT2; the step counter is read once a second instead of
+ * waking the MCU on every step.
+ */
+#define EMB_FUNC_STEP         0x08
+#define EMB_FUNC_TILT         0x10
+#define EMB_FUNC_SIGMOT       0x20
+#define EMB_FUNC_USED         (EMB_FUNC_STEP | EMB_FUNC_TILT | EMB_FUNC_SIGMOT)
+#define EMB_FUNC_IRQ          (EMB_FUNC_TILT | EMB_FUNC_SIGMOT)
+#define EMB_PAGE_RW_LIR       0x80
+#define EMB_FUNC_SRC_RST_STEP 0x80
+#define EMB_FUNC_EN_B_FSM     0x01
+
+/* Single/double tap on all axes, latched and cleared on TAP_SRC read.
+ * Threshold 9 x FS/32 = 560 mg at 2 g; shock/quiet/dur as ST AN5192.
+ */
+#define TAP_CFG0_XYZ_LIR      0x4F  /* INT_CLR_ON_READ | TAP_X/Y/Z_EN | LIR */
+#define TAP_THS               0x09
+#define TAP_CFG2_INT_EN       0x80
+#define INT_DUR2_TAP          0x7F
+#define WAKE_UP_THS_DTAP      0x80  /* SINGLE_DOUBLE_TAP */
+#define MD2_CFG_EMB_FUNC      0x02
+#define MD2_CFG_DOUBLE_TAP    0x08
+#define MD2_CFG_SINGLE_TAP    0x40
+#define MD2_CFG_WU            0x20
+
+/* Wake-up: slope filter above 2 x FS/64 = 62.5 mg for one sample. Shares
+ * WAKE_UP_THS with the tap mode bit; latched with the taps (LIR) and
+ * cleared by reading WAKE_UP_SRC.
+ */
+#define WAKE_UP_THS_WK        0x02
+#define WAKE_UP_DUR_WK        0x00
+#define WAKE_UP_SRC_WU_IA     0x08
+
+#define TAP_SRC_AXES          0x0F  /* sign | X | Y | Z */
+#define TAP_SRC_DOUBLE        0x10
+#define TAP_SRC_SINGLE        0x20
+
+#define FIFO_CTRL3_BDR(xl, g) (((g) << 4) | (xl))
+#define FIFO_CTRL4_CONT_TS1   0x46  /* DEC_TS_BATCH = every BDR, continuous mode */
+
+#define FIFO_STATUS2_DIFF_MSK 0x03
+#define FIFO_STATUS2_OVR      0x40
+
+#define TAG_GYRO              0x01
+#define TAG_ACCEL             0x02
+#define TAG_TIMESTAMP         0x04
 
-#define ACC_MG_PER_LSB_NUM      61
-#define ACC_MG_PER_LSB_DEN      1000
+#define FIFO_WORD_BYTES   7
+#define FIFO_BURST_WORDS  32
+#define IMU_POLL_BATCHES  1       /* ~80 words at 104 Hz accel+gyro */
+#define IMU_POLL_FAST_MS  50      /* high-ODR capture: ~170 words at 1666 Hz, off the batch clock */
+#define IMU_POLL_LOW_BATCHES 4    /* low rate: ~52 words */
+#define SPEC_PUBLISH_MS   2500
+#define IMU_LOG_MS        1000
+#define TS_US_PER_LSB     25
+#define STEP_REC_MS       10000   /* step count records at most this often */
+#define INT2_SERVICE_MAX  4       /* re-reads while INT2 stays latched high */
+#define FUSION_HZ_DEFAULT 25      /* REC_QUAT rate, CTRL_FUSION_RATE changes it */
+#define FUSION_HZ_MAX     104
 
-#define GYRO_MDPS_PER_LSB_NUM   875
-#define GYRO_MDPS_PER_LSB_DEN   100
+/* Motion-adaptive rate: after IDLE_AFTER_MS without motion the gyro is
+ * switched off and the accel drops to 26 Hz low-power mode; the wake-up
+ * interrupt (routed to INT2 only while idle) brings back 104 Hz accel+gyro.
+ */
+#define IDLE_AFTER_MS     10000
+#define IDLE_ACT_MG       15      /* activity EMA */
+#define IDLE_GYRO_MDPS    15000
+#define IDLE_HOLD         4       /* each 26 Hz sample passed on 4x: 104 Hz downstream */
+#define IDLE_HOLD_TS      385     /* 1 / 104 Hz in 25 us timestamp ticks */
+
+/* Sensitivity at 2g / 250dps (datasheet), Q16 */
+#define ACC_MG_PER_LSB_Q16      DSP_Q16(0.061)
+#define GYRO_MDPS_PER_LSB_Q16   DSP_Q16(8.75)
 
 static const struct device *i2c1;
 static const struct device *gpio0;
 
+/* Activity = EMA (1/128, ~1.2 s @ 104 Hz) of | |a| - baseline |. The
+ * baseline (1/1024, ~10 s) stands in for 1 g: it takes up the sensor's
+ * offset and gain error (10-20 mg, orientation dependent), so a still
+ * wrist reads the noise floor.
+ */
+static struct dsp_ema activity = DSP_EMA_INIT(7);
+static struct dsp_ema a_base = DSP_EMA_INIT(10);
+
+static uint8_t fifo_buf[FIFO_BURST_WORDS * FIFO_WORD_BYTES];
+
+/* INT2: the MCU only hears about gestures and wake-up on an edge */
+static struct gpio_callback int2_cb;
+static uint8_t imu_addr;
+static K_SEM_DEFINE(int2_sem, 0, 1);
+
+/* Step counter: the sensor's 16-bit count, extended across wraps */
+static uint16_t steps_hw;
+static uint32_t steps_total, steps_sent;
+static int64_t next_step_rec;
+
 /* ========= I2C helpers ========= */
 static int reg_read_u8(uint8_t addr, uint8_t reg, uint8_t *val)
 {
@@ -82,12 +230,718 @@ static inline int16_t le16(const uint8_t *p)
 
 static int32_t accel_raw_to_mg(int16_t raw)
 {
-	return ((int32_t)raw * ACC_MG_PER_LSB_NUM) / ACC_MG_PER_LSB_DEN;
+	return dsp_scale_q16(raw, ACC_MG_PER_LSB_Q16);
 }
 
 static int32_t gyro_raw_to_mdps(int16_t raw)
 {
-	return ((int32_t)raw * GYRO_MDPS_PER_LSB_NUM) / GYRO_MDPS_PER_LSB_DEN;
+	return dsp_scale_q16(raw, GYRO_MDPS_PER_LSB_Q16);
+}
+
+/* ========= Orientation ========= */
+static const struct imu_fusion_cfg fusion_cfg = IMU_FUSION_CFG_DEFAULT;
+static struct imu_fusion fusion;
+static struct dsp_cyc_stat fusion_cyc;
+static atomic_t fusion_hz = ATOMIC_INIT(FUSION_HZ_DEFAULT);
+static uint32_t fusion_ts;        /* sensor timestamp of the last update */
+static bool fusion_run;
+static uint32_t next_quat_ms;
+
+static int32_t last_g[3];
+static int32_t last_a[3];
+
+static void fusion_ctrl(const uint8_t *d, size_t len)
+{
+	if (len >= 2) {
+		atomic_set(&fusion_hz, MIN(d[1], FUSION_HZ_MAX));
+	}
+}
+
+static void quat_publish(uint32_t t_ms)
+{
+	int16_t q[4];
+	int32_t lin[3];
+
+	imu_fusion_quat_q15(&fusion, q);
+	imu_fusion_linear_mg(&fusion, last_a, lin);
+
+	struct rec_quat rec = {
+		.qx = q[1],
+		.qy = q[2],
+		.qz = q[3],
+		.lin_x = dsp_sat16(lin[0]),
+		.lin_y = dsp_sat16(lin[1]),
+		.lin_z = dsp_sat16(lin[2]),
+		.age_ms = (uint16_t)MIN(k_uptime_get_32() - t_ms, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_QUAT, &rec, sizeof(rec));
+}
+
+/* Every accel sample, paired with the newest gyro sample (same BDR tick) */
+static void fusion_step(uint32_t t_ms, uint32_t ts)
+{
+	uint32_t hz = (uint32_t)atomic_get(&fusion_hz);
+
+	if (hz == 0 || !chan_sub_wanted(CHAN_QUAT)) {
+		/* nobody reads the orientation: restart from the next sample */
+		fusion_run = false;
+		return;
+	}
+	if (fusion_run) {
+		uint32_t c0 = dsp_cyc_now();
+
+		imu_fusion_update(&fusion, last_g, last_a, (ts - fusion_ts) * TS_US_PER_LSB);
+		dsp_cyc_add(&fusion_cyc, dsp_cyc_now() - c0);
+	}
+	fusion_ts = ts;
+	fusion_run = true;
+
+	if ((int32_t)(t_ms - next_quat_ms) < 0) {
+		return;
+	}
+	/* fixed cadence in sample time; restart it after a stall */
+	next_quat_ms += 1000 / hz;
+	if ((int32_t)(t_ms - next_quat_ms) >= 0) {
+		next_quat_ms = t_ms + 1000 / hz;
+	}
+	quat_publish(t_ms);
+}
+
+/* ========= Spectrum ========= */
+/* High-ODR capture for the spectral engine (CTRL_SPECTRAL). Only the accel
+ * BDR goes up; everything downstream of accel_sample() keeps getting 104 Hz
+ * box-car averages.
+ */
+static const struct {
+	uint16_t hz;
+	uint8_t  odr;
+	uint8_t  decim;
+} spec_modes[] = {
+	[SPEC_MODE_OFF]    = { 104,  ODR_104HZ,  1 },
+	[SPEC_MODE_416HZ]  = { 416,  ODR_416HZ,  4 },
+	[SPEC_MODE_833HZ]  = { 833,  ODR_833HZ,  8 },
+	[SPEC_MODE_1666HZ] = { 1666, ODR_1666HZ, 16 },
+};
+
+/* Low rate (asleep / off wrist): accel at 26 Hz, gyro off, spectral
+ * capture held off. low_req holds one bit per acq_policy.h owner.
+ */
+static atomic_t low_req;
+static bool low_rate;
+static atomic_t imu_on = ATOMIC_INIT(1);
+
+void lsm6dso_set_low_rate(uint8_t owner, bool on)
+{
+	atomic_val_t was = on ? atomic_or(&low_req, owner) :
+				atomic_and(&low_req, ~(atomic_val_t)owner);
+
+	if (was && !atomic_get(&low_req)) {
+		/* back to full rate now, not at the next low-rate batch */
+		k_sem_give(&int2_sem);
+	}
+}
+
+/* Motion-adaptive rate (full rate only: low rate is accel-only already) */
+static bool imu_idle;
+static bool imu_woken;
+static int64_t moved_at;
+static uint8_t rate_sent = 0xFF;
+
+static struct spectral_engine spec;
+static struct dsp_cyc_stat spec_cyc;
+static atomic_t spec_req = ATOMIC_INIT(SPEC_MODE_OFF);
+static uint8_t spec_mode = SPEC_MODE_OFF;
+static int32_t dec_sum[3];
+static uint8_t dec_n;
+
+static void spec_ctrl(const uint8_t *d, size_t len)
+{
+	if (len >= 2 && d[1] < ARRAY_SIZE(spec_modes)) {
+		atomic_set(&spec_req, d[1]);
+	}
+}
+
+static void spec_set(uint8_t mode)
+{
+	spec_mode = mode;
+	dec_n = 0;
+	memset(dec_sum, 0, sizeof(dec_sum));
+	(void)dsp_cyc_take(&spec_cyc, NULL);
+
+	if (mode == SPEC_MODE_OFF) {
+		LOG_INF("Spectral capture off");
+		return;
+	}
+
+	uint16_t fs = spec_modes[mode].hz;
+
+	spectral_engine_init(&spec, fs);
+	LOG_INF("Spectral capture %u Hz: N=%u (%u ms), %u.%02u Hz bins, engine RAM %u B",
+		fs, SPEC_N, SPEC_N * 1000 / fs, fs / SPEC_N, (fs * 100 / SPEC_N) % 100,
+		(unsigned int)sizeof(spec));
+}
+
+static void spec_publish(void)
+{
+	struct spectral_result r;
+	uint32_t cmax, cavg = dsp_cyc_take(&spec_cyc, &cmax);
+
+	spectral_engine_result(&spec, &r);
+	if (r.n_win == 0) {
+		return;
+	}
+
+	struct rec_tremor rec = {
+		.move_x10 = r.move_x10,
+		.tremor_x10 = r.tremor_x10,
+		.high_x10 = r.high_x10,
+		.dom_hz_x10 = r.dom_hz_x10,
+		.entropy = r.entropy,
+		.tremor_pct = r.tremor_pct,
+		.n_win = r.n_win,
+		.kcyc = (uint16_t)MIN(cavg / 1000, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_TREMOR, &rec, sizeof(rec));
+
+	LOG_INF("TREMOR %u.%u mg @%u.%u Hz (%u%%) | move %u.%u high %u.%u mg | H=%u | %u win, cyc/win %u (max %u)",
+		r.tremor_x10 / 10, r.tremor_x10 % 10, r.dom_hz_x10 / 10, r.dom_hz_x10 % 10,
+		r.tremor_pct, r.move_x10 / 10, r.move_x10 % 10, r.high_x10 / 10, r.high_x10 % 10,
+		r.entropy, r.n_win, cavg, cmax);
+}
+
+/* ========= Fall detection ========= */
+static const struct fall_cfg fall_cfg = FALL_CFG_DEFAULT;
+static struct fall_engine fall;
+static uint8_t fall_seq;
+
+static void fall_step(uint32_t t_ms)
+{
+	struct fall_info info;
+	enum fall_evt evt = fall_engine_push(&fall, last_a, last_g, t_ms, &info);
+
+	if (evt == FALL_REJECTED) {
+		LOG_INF("Fall rejected | peak=%u mg ff=%u ms cos=%d",
+			info.peak_mg, info.freefall_ms, info.cos_x100);
+		return;
+	}
+	if (evt != FALL_DETECTED) {
+		return;
+	}
+
+	struct rec_fall rec = {
+		.seq = fall_seq++,
+		.flags = (info.freefall_ms ? FALL_FLAG_FREEFALL : 0) |
+			 (info.peak_mg >= fall_cfg.impact_hard_mg ? FALL_FLAG_HARD : 0),
+		.peak_mg = info.peak_mg,
+		.freefall_ms = info.freefall_ms,
+		.cos_x100 = info.cos_x100,
+		.impact_age_ms = (uint16_t)MIN(k_uptime_get_32() - info.impact_ms, UINT16_MAX),
+	};
+	int err = alert_raise(REC_FALL, &rec, sizeof(rec));
+
+	LOG_WRN("FALL #%u | peak=%u mg ff=%u ms cos=%d (%d)",
+		rec.seq, info.peak_mg, info.freefall_ms, info.cos_x100, err);
+}
+
+/* ========= FIFO ========= */
+/* hist: a real sample for the PPG's accel history, not a 26 Hz repeat */
+static void accel_sample(const int16_t raw[3], uint32_t t_ms, uint32_t ts, bool hist)
+{
+	int16_t mg[3];
+
+	for (int i = 0; i < 3; i++) {
+		last_a[i] = accel_raw_to_mg(raw[i]);
+		mg[i] = (int16_t)last_a[i];
+	}
+	if (hist) {
+		motion_shared_put_accel(t_ms, mg);
+	}
+
+	uint32_t a_mg = dsp_isqrt64((int64_t)last_a[0] * last_a[0] +
+				    (int64_t)last_a[1] * last_a[1] +
+				    (int64_t)last_a[2] * last_a[2]);
+	int32_t base = dsp_ema_step(&a_base, (int32_t)a_mg);
+
+	motion_shared_set((uint32_t)dsp_ema_step(&activity, dsp_abs32((int32_t)a_mg - base)));
+
+	fusion_step(t_ms, ts);
+	if (chan_sub_wanted(CHAN_FALL)) {
+		fall_step(t_ms);
+	}
+	if (chan_sub_wanted(CHAN_ACTIVITY)) {
+		activity_post_imu(last_a, last_g);
+	}
+}
+
+/* Every accel FIFO word: full rate to the spectral engine, 104 Hz onwards;
+ * 26 Hz (idle or low rate) is held 4x so downstream time constants stay put
+ */
+static void accel_word(const int16_t raw[3], uint32_t t_ms, uint32_t ts)
+{
+	if (imu_idle || low_rate) {
+		for (int k = IDLE_HOLD - 1; k >= 0; k--) {
+			uint32_t dts = (uint32_t)k * IDLE_HOLD_TS;
+
+			accel_sample(raw, t_ms - dts * TS_US_PER_LSB / 1000, ts - dts, k == 0);
+		}
+		return;
+	}
+	if (spec_mode == SPEC_MODE_OFF) {
+		accel_sample(raw, t_ms, ts, true);
+		return;
+	}
+
+	uint32_t c0 = dsp_cyc_now();
+
+	if (spectral_engine_push(&spec, raw)) {
+		dsp_cyc_add(&spec_cyc, dsp_cyc_now() - c0);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		dec_sum[i] += raw[i];
+	}
+	if (++dec_n < spec_modes[spec_mode].decim) {
+		return;
+	}
+
+	int16_t avg[3];
+
+	for (int i = 0; i < 3; i++) {
+		avg[i] = (int16_t)(dec_sum[i] / dec_n);
+		dec_sum[i] = 0;
+	}
+	dec_n = 0;
+	accel_sample(avg, t_ms, ts, true);
+}
+
+static void gyro_sample(const int16_t raw[3], uint32_t t_ms)
+{
+	ARG_UNUSED(t_ms);
+
+	for (int i = 0; i < 3; i++) {
+		last_g[i] = gyro_raw_to_mdps(raw[i]);
+	}
+}
+
+/* Sensor timestamp (25 us ticks) of the newest word of the previous drain,
+ * and the uptime at which it was read out
+ */
+static uint32_t anchor_ts, anchor_ms;
+static bool anchored;
+
+/* Read every pending FIFO word. Each sample takes the time of the timestamp
+ * word batched before it, mapped to k_uptime through the anchor. Like the
+ * MAX30101 FIFO, the newest data is taken as sampled at readout time.
+ * Returns words read or <0 on error.
+ */
+static int fifo_drain(uint8_t addr)
+{
+	uint8_t st[2];
+	int ret = burst_read(addr, REG_FIFO_STATUS1, st, sizeof(st));
+
+	if (ret) {
+		LOG_ERR("FIFO status read failed (%d)", ret);
+		return ret;
+	}
+	if (st[1] & FIFO_STATUS2_OVR) {
+		LOG_WRN("FIFO overrun");
+	}
+
+	uint16_t words = st[0] | ((st[1] & FIFO_STATUS2_DIFF_MSK) << 8);
+	uint16_t left = words;
+	uint32_t now = k_uptime_get_32();
+
+	uint32_t ts = anchor_ts;
+	bool have_ts = anchored;
+
+	while (left) {
+		uint16_t n = MIN(left, FIFO_BURST_WORDS);
+
+		ret = burst_read(addr, REG_FIFO_DATA_OUT_TAG, fifo_buf, n * FIFO_WORD_BYTES);
+		if (ret) {
+			LOG_ERR("FIFO read failed (%d)", ret);
+			return ret;
+		}
+
+		for (uint16_t i = 0; i < n; i++) {
+			const uint8_t *w = &fifo_buf[i * FIFO_WORD_BYTES];
+			int16_t v[3] = { le16(&w[1]), le16(&w[3]), le16(&w[5]) };
+
+			switch (w[0] >> 3) {
+			case TAG_TIMESTAMP:
+				ts = (uint32_t)w[1] | ((uint32_t)w[2] << 8) |
+				     ((uint32_t)w[3] << 16) | ((uint32_t)w[4] << 24);
+				if (!have_ts) {
+					/* first drain: no anchor yet, treat as recent */
+					anchor_ts = ts;
+					anchor_ms = now;
+					have_ts = true;
+				}
+				break;
+			case TAG_ACCEL:
+				if (have_ts) {
+					accel_word(v, anchor_ms +
+						     (ts - anchor_ts) * TS_US_PER_LSB / 1000, ts);
+				}
+				break;
+			case TAG_GYRO:
+				if (have_ts) {
+					gyro_sample(v, anchor_ms +
+						    (ts - anchor_ts) * TS_US_PER_LSB / 1000);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		left -= n;
+	}
+
+	/* Re-anchor on the newest timestamp so sensor clock drift never builds up */
+	if (have_ts) {
+		anchor_ts = ts;
+		anchor_ms = now;
+		anchored = true;
+	}
+	return words;
+}
+
+/* ========= Embedded functions ========= */
+static int emb_bank(uint8_t addr, bool on)
+{
+	return reg_write_u8(addr, REG_FUNC_CFG_ACCESS, on ? FUNC_CFG_ACCESS_EMB : 0);
+}
+
+static int emb_config(uint8_t addr)
+{
+	int ret = emb_bank(addr, true);
+
+	if (ret) {
+		return ret;
+	}
+	/* keep what a loaded FSM program enabled; its FSMs interrupt on INT2 */
+	uint8_t en_a = 0, en_b = 0, fsm_en[2] = { 0 };
+
+	ret |= reg_read_u8(addr, EMB_FUNC_EN_A, &en_a);
+	ret |= reg_read_u8(addr, EMB_FUNC_EN_B, &en_b);
+	ret |= burst_read(addr, EMB_FSM_ENABLE_A, fsm_en, sizeof(fsm_en));
+	if (!(en_b & EMB_FUNC_EN_B_FSM)) {
+		fsm_en[0] = fsm_en[1] = 0;
+	}
+	ret |= reg_write_u8(addr, EMB_FUNC_EN_A, en_a | EMB_FUNC_USED);
+	ret |= reg_write_u8(addr, EMB_FUNC_INT2, EMB_FUNC_IRQ);
+	ret |= reg_write_u8(addr, EMB_FSM_INT1_A, 0);
+	ret |= reg_write_u8(addr, EMB_FSM_INT1_B, 0);
+	ret |= reg_write_u8(addr, EMB_FSM_INT2_A, fsm_en[0]);
+	ret |= reg_write_u8(addr, EMB_FSM_INT2_B, fsm_en[1]);
+	ret |= reg_write_u8(addr, EMB_PAGE_RW, EMB_PAGE_RW_LIR);
+	ret |= reg_write_u8(addr, EMB_FUNC_SRC, EMB_FUNC_SRC_RST_STEP);
+	ret |= reg_write_u8(addr, EMB_FUNC_INIT_A, EMB_FUNC_USED);
+	ret |= emb_bank(addr, false);
+
+	ret |= reg_write_u8(addr, REG_TAP_CFG0, TAP_CFG0_XYZ_LIR);
+	ret |= reg_write_u8(addr, REG_TAP_CFG1, TAP_THS);
+	ret |= reg_write_u8(addr, REG_TAP_CFG2, TAP_CFG2_INT_EN | TAP_THS);
+	ret |= reg_write_u8(addr, REG_TAP_THS_6D, TAP_THS);
+	ret |= reg_write_u8(addr, REG_INT_DUR2, INT_DUR2_TAP);
+	ret |= reg_write_u8(addr, REG_WAKE_UP_THS, WAKE_UP_THS_DTAP | WAKE_UP_THS_WK);
+	ret |= reg_write_u8(addr, REG_WAKE_UP_DUR, WAKE_UP_DUR_WK);
+	ret |= reg_write_u8(addr, REG_MD2_CFG,
+			    MD2_CFG_EMB_FUNC | MD2_CFG_SINGLE_TAP | MD2_CFG_DOUBLE_TAP);
+	return ret;
+}
+
+static void int2_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
+
+	k_sem_give(&int2_sem);
+}
+
+static void imu_event(uint8_t evt, uint8_t detail)
+{
+	if (!chan_sub_wanted(CHAN_IMU_EVT)) {
+		return;
+	}
+
+	struct rec_imu_evt rec = {
+		.evt = evt,
+		.detail = detail,
+		.steps = steps_total,
+	};
+	(void)ble_rec_send(REC_IMU_EVT, &rec, sizeof(rec));
+}
+
+/* IMU_EVT_RATE whenever the sample rates change */
+static void rate_event(void)
+{
+	uint8_t mode = low_rate ? IMU_RATE_LOW : (imu_idle ? IMU_RATE_IDLE : IMU_RATE_ACTIVE);
+
+	if (mode != rate_sent) {
+		rate_sent = mode;
+		imu_event(IMU_EVT_RATE, mode);
+	}
+}
+
+static void steps_publish(bool force)
+{
+	int64_t now = k_uptime_get();
+
+	if (steps_total == steps_sent || (!force && now < next_step_rec)) {
+		return;
+	}
+	steps_sent = steps_total;
+	next_step_rec = now + STEP_REC_MS;
+	imu_event(IMU_EVT_STEPS, 0);
+	LOG_INF("[LSM6DSO] steps=%u", steps_total);
+}
+
+/* Polled step counter; steps are not routed to INT2 */
+static int steps_poll(uint8_t addr)
+{
+	uint8_t cnt[2] = { 0 };
+	int ret = emb_bank(addr, true);
+
+	if (ret) {
+		return ret;
+	}
+	ret |= burst_read(addr, EMB_STEP_COUNTER_L, cnt, sizeof(cnt));
+	ret |= emb_bank(addr, false);
+	if (ret) {
+		return ret;
+	}
+
+	uint16_t hw = (uint16_t)(cnt[0] | (cnt[1] << 8));
+
+	if (hw != steps_hw) {
+		steps_total += (uint16_t)(hw - steps_hw);
+		steps_hw = hw;
+		activity_post_steps(steps_total);
+	}
+	return 0;
+}
+
+/* Read and clear the latched sources behind an INT2 edge. Returns <0 on error. */
+static int emb_service(uint8_t addr)
+{
+	uint8_t st = 0, tap = 0, wu = 0, fsm[2] = { 0 };
+	int ret = emb_bank(addr, true);
+
+	if (ret) {
+		return ret;
+	}
+	ret |= reg_read_u8(addr, EMB_FUNC_STATUS, &st);
+	ret |= burst_read(addr, EMB_FSM_STATUS_A, fsm, sizeof(fsm));
+	ret |= emb_bank(addr, false);
+	ret |= reg_read_u8(addr, REG_TAP_SRC, &tap);
+	ret |= reg_read_u8(addr, REG_WAKE_UP_SRC, &wu);
+	if (ret) {
+		LOG_ERR("INT2 source read failed (%d)", ret);
+		return ret;
+	}
+
+	if (st & EMB_FUNC_SIGMOT) {
+		imu_event(IMU_EVT_SIGMOT, 0);
+		LOG_INF("[LSM6DSO] significant motion");
+	}
+	if (st & EMB_FUNC_TILT) {
+		imu_event(IMU_EVT_TILT, 0);
+		LOG_INF("[LSM6DSO] tilt");
+	}
+	for (int i = 0; i < 16; i++) {
+		if (fsm[i / 8] & BIT(i % 8)) {
+			imu_event(IMU_EVT_FSM, (uint8_t)(i + 1));
+			LOG_INF("[LSM6DSO] FSM%d", i + 1);
+		}
+	}
+	if (tap & TAP_SRC_DOUBLE) {
+		imu_event(IMU_EVT_DTAP, tap & TAP_SRC_AXES);
+		LOG_INF("[LSM6DSO] double tap (src 0x%02X)", tap);
+	} else if (tap & TAP_SRC_SINGLE) {
+		imu_event(IMU_EVT_TAP, tap & TAP_SRC_AXES);
+		LOG_INF("[LSM6DSO] tap (src 0x%02X)", tap);
+	}
+	if ((wu & WAKE_UP_SRC_WU_IA) && imu_idle) {
+		imu_woken = true;
+	}
+	return 0;
+}
+
+/* Switch between 104 Hz accel+gyro and 26 Hz low-power accel without a
+ * reset: timestamps, step count and the FSM program carry on. What is in
+ * the FIFO was sampled at the old rate, so it goes first.
+ */
+static int imu_set_idle(uint8_t addr, bool idle)
+{
+	(void)fifo_drain(addr);
+
+	uint8_t xl_odr = idle ? ODR_26HZ : ODR_104HZ;
+	uint8_t g_odr = idle ? ODR_OFF : ODR_104HZ;
+	int ret = reg_write_u8(addr, REG_CTRL6_C, idle ? CTRL6_C_XL_HM_OFF : 0);
+
+	ret |= reg_write_u8(addr, REG_CTRL1_XL, CTRL1_XL_2G(xl_odr));
+	ret |= reg_write_u8(addr, REG_CTRL2_G, CTRL2_G_250DPS(g_odr));
+	ret |= reg_write_u8(addr, REG_FIFO_CTRL3, FIFO_CTRL3_BDR(xl_odr, g_odr));
+	ret |= reg_write_u8(addr, REG_MD2_CFG, MD2_CFG_EMB_FUNC | MD2_CFG_SINGLE_TAP |
+			    MD2_CFG_DOUBLE_TAP | (idle ? MD2_CFG_WU : 0));
+	if (ret) {
+		LOG_ERR("Rate switch failed");
+		return -EIO;
+	}
+
+	imu_idle = idle;
+	imu_woken = false;
+	moved_at = k_uptime_get();
+	if (idle) {
+		memset(last_g, 0, sizeof(last_g));
+	}
+	rate_event();
+	LOG_INF("[LSM6DSO] %s", idle ? "idle: XL 26 Hz low-power, G off, wake-up armed" :
+					"motion: XL+G 104 Hz");
+	return 0;
+}
+
+/* Full-rate motion tracking: still for IDLE_AFTER_MS goes idle; the wake-up
+ * interrupt, or activity seen in the idle stream, comes back.
+ */
+static void imu_adapt(uint8_t addr)
+{
+	int64_t now = k_uptime_get();
+
+	if (low_rate || spec_mode != SPEC_MODE_OFF) {
+		return;
+	}
+
+	bool moving = motion_shared_get() > IDLE_ACT_MG;
+
+	for (int i = 0; i < 3; i++) {
+		moving |= dsp_abs32(last_g[i]) > IDLE_GYRO_MDPS;
+	}
+
+	if (imu_idle) {
+		if (imu_woken || moving) {
+			(void)imu_set_idle(addr, false);
+		}
+		return;
+	}
+	if (moving) {
+		moved_at = now;
+	} else if (now - moved_at >= IDLE_AFTER_MS) {
+		(void)imu_set_idle(addr, true);
+	}
+}
+
+static int fsm_write(uint8_t reg, uint8_t val)
+{
+	return reg_write_u8(imu_addr, reg, val);
+}
+
+/* No subscriber for any IMU channel: a reset leaves accel and gyro
+ * powered down, and the embedded functions stop with them
+ */
+static void imu_power_down(uint8_t addr)
+{
+	(void)gpio_pin_interrupt_configure(gpio0, LSM6DSO_INT2_PIN, GPIO_INT_DISABLE);
+	(void)fifo_drain(addr);
+	(void)reg_write_u8(addr, REG_CTRL3_C, CTRL3_C_SW_RESET);
+	LOG_INF("[LSM6DSO] off: no subscriber");
+}
+
+/* Full (re)configuration from reset: the host FSM program first, then the
+ * settings this task depends on, so a program can add to but not change
+ * ODR, full scale, FIFO or interrupt routing.
+ */
+static int imu_configure(uint8_t addr)
+{
+	int ret;
+
+	(void)gpio_pin_interrupt_configure(gpio0, LSM6DSO_INT2_PIN, GPIO_INT_DISABLE);
+
+	ret = reg_write_u8(addr, REG_CTRL3_C, CTRL3_C_SW_RESET);
+	k_msleep(1);
+
+	/* SW_RESET leaves the embedded functions alone: drop any old program */
+	ret |= emb_bank(addr, true);
+	ret |= reg_write_u8(addr, EMB_FUNC_EN_B, 0);
+	ret |= reg_write_u8(addr, EMB_FSM_ENABLE_A, 0);
+	ret |= reg_write_u8(addr, EMB_FSM_ENABLE_B, 0);
+	ret |= emb_bank(addr, false);
+	if (ret) {
+		LOG_ERR("Reset failed");
+		return -EIO;
+	}
+
+	ret = lsm6dso_fsm_apply(fsm_write);
+	if (ret < 0) {
+		LOG_ERR("FSM program write failed (%d)", ret);
+	} else if (ret > 0) {
+		LOG_INF("FSM program applied (%d ops)", ret);
+	}
+	/* whatever the program did, continue on the main register bank */
+	(void)emb_bank(addr, false);
+
+	ret = reg_write_u8(addr, REG_CTRL3_C, CTRL3_C_BDU_IFINC);
+	if (ret) {
+		LOG_ERR("CTRL3_C write failed (%d)", ret);
+		return ret;
+	}
+
+	uint8_t xl_odr = low_rate ? ODR_26HZ : spec_modes[spec_mode].odr;
+	uint8_t g_odr = low_rate ? ODR_OFF : ODR_104HZ;
+
+	ret = reg_write_u8(addr, REG_CTRL6_C, low_rate ? CTRL6_C_XL_HM_OFF : 0);
+	ret |= reg_write_u8(addr, REG_CTRL1_XL, CTRL1_XL_2G(xl_odr));
+	if (ret) {
+		LOG_ERR("CTRL6_C/CTRL1_XL write failed (%d)", ret);
+		return ret;
+	}
+
+	ret = reg_write_u8(addr, REG_CTRL2_G, CTRL2_G_250DPS(g_odr));
+	if (ret) {
+		LOG_ERR("CTRL2_G write failed (%d)", ret);
+		return ret;
+	}
+
+	ret = reg_write_u8(addr, REG_CTRL10_C, CTRL10_C_TIMESTAMP_EN);
+	ret |= reg_write_u8(addr, REG_FIFO_CTRL3, FIFO_CTRL3_BDR(xl_odr, g_odr));
+	ret |= reg_write_u8(addr, REG_FIFO_CTRL4, FIFO_CTRL4_CONT_TS1);
+	if (ret) {
+		LOG_ERR("FIFO config failed");
+		return -EIO;
+	}
+
+	ret = emb_config(addr);
+	if (ret) {
+		LOG_ERR("Embedded function config failed");
+		return -EIO;
+	}
+
+	/* Timestamp and step counter restarted from zero */
+	anchored = false;
+	fusion_run = false;
+	steps_hw = 0;
+	imu_idle = false;
+	imu_woken = false;
+	moved_at = k_uptime_get();
+	if (low_rate) {
+		memset(last_g, 0, sizeof(last_g));
+	}
+
+	/* Clear anything latched during config, then arm the edge */
+	(void)emb_service(addr);
+	ret = gpio_pin_interrupt_configure(gpio0, LSM6DSO_INT2_PIN, GPIO_INT_EDGE_RISING);
+	if (ret) {
+		LOG_ERR("INT2 interrupt config failed (%d)", ret);
+		return ret;
+	}
+
+	LOG_INF("Configured: XL=%uHz(2g), G=%s(250dps), IF_INC+BDU, FIFO+timestamps",
+		low_rate ? 26 : spec_modes[spec_mode].hz, low_rate ? "off" : "104Hz");
+	LOG_INF("Embedded: pedometer, tilt, significant motion, single/double tap, FSM -> INT2");
+	rate_event();
+	return 0;
 }
 
 /* ========= Thread ========= */
@@ -121,9 +975,10 @@ static void lsm6dso_thread(void *a, void *b, void *c)
 		return;
 	}
 
-	/* Optional INT pins */
 	(void)gpio_pin_configure(gpio0, LSM6DSO_INT1_PIN, GPIO_INPUT);
 	(void)gpio_pin_configure(gpio0, LSM6DSO_INT2_PIN, GPIO_INPUT);
+	gpio_init_callback(&int2_cb, int2_isr, BIT(LSM6DSO_INT2_PIN));
+	(void)gpio_add_callback(gpio0, &int2_cb);
 
 	k_msleep(20);
 
@@ -134,60 +989,99 @@ static void lsm6dso_thread(void *a, void *b, void *c)
 	}
 
 	LOG_INF("Using LSM6DSO I2C address = 0x%02X", addr);
+	imu_addr = addr;
 
-	ret = reg_write_u8(addr, REG_CTRL3_C, CTRL3_C_BDU_IFINC);
-	if (ret) {
-		LOG_ERR("CTRL3_C write failed (%d)", ret);
-		return;
-	}
-
-	ret = reg_write_u8(addr, REG_CTRL1_XL, CTRL1_XL_104HZ_2G);
-	if (ret) {
-		LOG_ERR("CTRL1_XL write failed (%d)", ret);
-		return;
-	}
+	lsm6dso_fsm_init();
+	imu_fusion_init(&fusion, &fusion_cfg);
+	fall_engine_init(&fall, &fall_cfg);
+	dsp_cyc_init();
+	(void)ble_ctrl_register(CTRL_FUSION_RATE, CTRL_FUSION_RATE, fusion_ctrl);
+	(void)ble_ctrl_register(CTRL_SPECTRAL, CTRL_SPECTRAL, spec_ctrl);
 
-	ret = reg_write_u8(addr, REG_CTRL2_G, CTRL2_G_104HZ_250DPS);
+	ret = imu_configure(addr);
 	if (ret) {
-		LOG_ERR("CTRL2_G write failed (%d)", ret);
 		return;
 	}
 
-	LOG_INF("Configured: XL=104Hz(2g), G=104Hz(250dps), IF_INC+BDU enabled");
+	int64_t next_log = k_uptime_get() + IMU_LOG_MS;
+	int64_t next_spec = 0;
+	bool reconfig = false;
 
 	while (1) {
-		uint8_t buf[12];
+		bool low = atomic_get(&low_req) != 0;
+		uint8_t want = (low || !chan_sub_wanted(CHAN_TREMOR)) ? SPEC_MODE_OFF :
+			       (uint8_t)atomic_get(&spec_req);
 
-		ret = burst_read(addr, REG_OUTX_L_G, buf, sizeof(buf));
-		if (ret) {
-			LOG_ERR("Burst read failed (%d)", ret);
+		if (!atomic_get(&imu_on)) {
+			imu_power_down(addr);
+			while (!atomic_get(&imu_on)) {
+				(void)k_sem_take(&int2_sem, K_FOREVER);
+			}
+			reconfig = true;
+		}
+
+		reconfig |= lsm6dso_fsm_changed() || low != low_rate;
+		if (reconfig || want != spec_mode) {
+			/* FIFO contents and timestamps start over with the new program or rate */
+			(void)fifo_drain(addr);
+			if (want != spec_mode) {
+				spec_set(want);
+				next_spec = k_uptime_get() + SPEC_PUBLISH_MS;
+			}
+			low_rate = low;
+			if (imu_configure(addr)) {
+				k_sleep(K_MSEC(500));
+				continue;
+			}
+			reconfig = false;
+		}
+
+		ret = fifo_drain(addr);
+		if (ret < 0) {
 			k_sleep(K_MSEC(500));
 			continue;
 		}
+		imu_adapt(addr);
 
-		int16_t gx = le16(&buf[0]);
-		int16_t gy = le16(&buf[2]);
-		int16_t gz = le16(&buf[4]);
+		if (k_uptime_get() >= next_log) {
+			next_log += IMU_LOG_MS;
 
-		int16_t ax = le16(&buf[6]);
-		int16_t ay = le16(&buf[8]);
-		int16_t az = le16(&buf[10]);
+			LOG_INF("[LSM6DSO] G mdps [%6ld %6ld %6ld]  A mg [%6ld %6ld %6ld] | %d words",
+				(long)last_g[0], (long)last_g[1], (long)last_g[2],
+				(long)last_a[0], (long)last_a[1], (long)last_a[2], ret);
 
-		int32_t gx_mdps = gyro_raw_to_mdps(gx);
-		int32_t gy_mdps = gyro_raw_to_mdps(gy);
-		int32_t gz_mdps = gyro_raw_to_mdps(gz);
+			uint32_t fmax, favg = dsp_cyc_take(&fusion_cyc, &fmax);
+			int16_t q[4];
 
-		int32_t ax_mg = accel_raw_to_mg(ax);
-		int32_t ay_mg = accel_raw_to_mg(ay);
-		int32_t az_mg = accel_raw_to_mg(az);
+			imu_fusion_quat_q15(&fusion, q);
+			LOG_INF("[LSM6DSO] q [%6d %6d %6d %6d] | fusion cyc/upd %u (max %u) @%ldHz",
+				q[0], q[1], q[2], q[3], favg, fmax, (long)atomic_get(&fusion_hz));
 
-		LOG_INF("[LSM6DSO] G RAW [%6d %6d %6d] mdps [%6ld %6ld %6ld]",
-			gx, gy, gz, (long)gx_mdps, (long)gy_mdps, (long)gz_mdps);
+			/* steps are polled here; also sends the last of a walk inside the rate limit */
+			(void)steps_poll(addr);
+			steps_publish(false);
+		}
+
+		if (spec_mode != SPEC_MODE_OFF && k_uptime_get() >= next_spec) {
+			next_spec += SPEC_PUBLISH_MS;
+			spec_publish();
+		}
 
-		LOG_INF("[LSM6DSO] A RAW [%6d %6d %6d]  mg [%6ld %6ld %6ld]",
-			ax, ay, az, (long)ax_mg, (long)ay_mg, (long)az_mg);
+		k_timeout_t poll = (low_rate || imu_idle) ? acq_batch_timeout(IMU_POLL_LOW_BATCHES) :
+				(spec_mode ? K_MSEC(IMU_POLL_FAST_MS) : acq_batch_timeout(IMU_POLL_BATCHES));
 
-		k_sleep(K_MSEC(200));
+		if (k_sem_take(&int2_sem, poll) == 0) {
+			/* latched: a source that fires mid-read keeps INT2 high with no new edge */
+			for (int i = 0; i < INT2_SERVICE_MAX; i++) {
+				if (emb_service(addr) < 0 ||
+				    gpio_pin_get(gpio0, LSM6DSO_INT2_PIN) <= 0) {
+					break;
+				}
+			}
+			if (imu_woken) {
+				(void)imu_set_idle(addr, false);
+			}
+		}
 	}
 }
 
@@ -212,3 +1106,10 @@ void lsm6dso_task_start(void)
 
 	k_thread_name_set(&lsm6dso_tcb, "lsm6dso_task");
 }
+
+void lsm6dso_set_enabled(bool on)
+{
+	if (atomic_set(&imu_on, on) != on) {
+		k_sem_give(&int2_sem);
+	}
+}
@@ -1,3 +1,17 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acq_policy.h"
 
 void lsm6dso_task_start(void);
+
+/* Low rate: accel 26 Hz only, gyro off. Held while any acq_policy.h owner
+ * asks for it (asleep, off wrist).
+ */
+void lsm6dso_set_low_rate(uint8_t owner, bool on);
+
+/* Off: accel and gyro powered down, nothing subscribes to an IMU channel
+ * (chan_sub.h)
+ */
+void lsm6dso_set_enabled(bool on);
@@ -7,6 +7,15 @@
 #include "max30101_task.h"
 #include "ads1113_task.h"   /* <-- add this */
 #include "w25n01_task.h"
+#include "stress_task.h"
+#include "alert_task.h"
+#include "activity_task.h"
+#include "sleep_task.h"
+#include "offwrist_task.h"
+#include "dsp_bench.h"
+#include "acq_batch.h"
+#include "slow_report.h"
+#include "chan_sub.h"
 
 LOG_MODULE_REGISTER(main_all, LOG_LEVEL_INF);
 
@@ -16,18 +25,33 @@ int main(void)
 	if (err) {
 		LOG_ERR("ble_log_service_init failed (%d)", err);
 	}
+	alert_task_start();
+	slow_report_init();
+	chan_sub_init();
+	/* on-device consumers; the central's set follows its CCCs */
+	chan_sub_set_mask(SUB_ALGO, BIT(CHAN_WEAR) | BIT(CHAN_FALL), true);
 
 	k_msleep(500);
 
+#if defined(CONFIG_CMSIS_DSP_FILTERING)
+	dsp_bench_run();
+#endif
+
 	as6221_task_start();
 	lsm6dso_task_start();
 	max30101_task_start();
 	ads1113_task_start();    /* <-- add this */
     w25n01_task_start();
+	stress_task_start();
+	activity_task_start();
+	sleep_task_start();
+	offwrist_task_start();
+	acq_batch_stats_start();
 
 	LOG_INF("All sensor tasks started.");
 
+	/* nothing periodic here: every wakeup belongs to a sensor batch */
 	while (1) {
-		k_sleep(K_SECONDS(1));
+		k_sleep(K_FOREVER);
 	}
 }
@@ -2,9 +2,31 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
 #include <string.h>
 
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "dsp_cycles.h"
+#include "hr_engine.h"
+#include "hrv_engine.h"
+#include "max30101_task.h"
+#include "motion_shared.h"
+#include "offwrist_task.h"
+#include "ppg_agc.h"
+#include "ppg_anc.h"
+#include "ppg_chsel.h"
+#include "ppg_sched.h"
+#include "ppg_sqi.h"
+#include "resp_engine.h"
+#include "sensor_records.h"
+#include "sleep_task.h"
+#include "spo2_engine.h"
+#include "acq_batch.h"
+#include "activity_task.h"
+#include "stress_task.h"
+
 LOG_MODULE_REGISTER(max30101_demo, LOG_LEVEL_INF);
 
 #define MAX30101_I2C_ADDR 0x57
@@ -24,13 +46,119 @@ LOG_MODULE_REGISTER(max30101_demo, LOG_LEVEL_INF);
 #define REG_LED1_PA           0x0C   /* LED1 = RED */
 #define REG_LED2_PA           0x0D   /* LED2 = IR  */
 #define REG_LED3_PA           0x0E   /* LED3 = GREEN */
+#define REG_PILOT_PA          0x10
 #define REG_MULTI_LED_CTRL1   0x11
 #define REG_MULTI_LED_CTRL2   0x12
+#define REG_PROX_INT_THRESH   0x30
 #define REG_REV_ID            0xFE
 #define REG_PART_ID           0xFF
 
+#define INTR_PROX             0x10   /* STATUS_1 / ENABLE_1 */
+#define MODE_MULTI_LED        0x07
+#define MODE_SHDN             0x80
+
+/* FIFO / timing (SPO2_CONFIG 0x27 => 100 sps, 18-bit) */
+#define PPG_FS_HZ        HR_FS_HZ
+#define PPG_TS_MS        HR_TS_MS
+#define PPG_POLL_BATCHES 1          /* 25 frames per drain, FIFO holds 32 */
+#define FIFO_DEPTH       32
+#define SAMPLE_BYTES     3          /* per enabled slot */
+#define FRAME_BYTES_MAX  (PPG_LED_COUNT * SAMPLE_BYTES)
+#define LED_PA_INIT      0x24       /* ~7 mA, AGC starts here */
+#define SPO2_CFG_RGE_INIT 1         /* 4096 nA full scale */
+#define SPO2_CFG_BASE    0x07       /* SR=100 sps, PW=411 us (18-bit) */
+#define SPO2_CFG(rge)    (SPO2_CFG_BASE | ((rge) << 5))
+
+#define HR_PUBLISH_MS    1000
+#define SPO2_PUBLISH_MS  4000
+#define HRV_PUBLISH_MS   30000
+#define RESP_PUBLISH_MS  10000
+
+/* Slot selection; RED+IR are only lit while an SpO2 measurement runs */
+#define PPG_SEL_MODE         PPG_SEL_ADAPTIVE
+
+/* Measurement sessions (ppg_sched.h): continuous HR with a 30 s SpO2
+ * session every 5 min unless the host selects spot checks
+ */
+#define PPG_POLL_SHDN_BATCHES 4
+
+/* Off wrist the LEDs are dark and the part sits in proximity mode: the
+ * pilot LED is pulsed and PROX_INT raised once the ADC passes the
+ * threshold (8 MSBs of the 18-bit count). On the wrist, reflection is the
+ * HR channel's DC clearing the AGC's ambient-only level.
+ */
+#define PPG_POLL_OFF_BATCHES 1
+#define PROX_PILOT_PA    LED_PA_INIT
+#define PROX_THRESH      ((1u << 18) / 50 >> 10)
+#define PPG_SKIN_DC_MIN  ((1u << 18) / 50)
+
+/* Frames wait here until the IMU has delivered accel for their timestamp */
+#define PPG_PEND_LEN     64
+#define PPG_IMU_WAIT_MS  (ACQ_BATCH_MS + 100)  /* then run with the newest accel held */
+
 static const struct device *i2c_dev;
 
+static uint8_t fifo_buf[FIFO_DEPTH * FRAME_BYTES_MAX];
+
+/* FIFO pointers from the last drain (debug line) */
+static uint8_t dbg_wrp, dbg_rdp, dbg_ovf, dbg_avail;
+
+static struct hr_engine hr;
+static struct dsp_cyc_stat hr_cyc;
+static struct ppg_anc anc;
+static struct dsp_cyc_stat anc_cyc;
+
+static const struct hrv_cfg hrv_cfg = HRV_CFG_DEFAULT;
+static struct hrv_engine hrv;
+static struct rec_ibi ibi_rec;
+static uint8_t ibi_n;
+
+static struct resp_engine resp;
+static struct dsp_ema hr_base = DSP_EMA_INIT(5);    /* HR channel baseline for RIIV */
+
+struct ppg_frame {
+	uint32_t x[PPG_LED_COUNT];
+	uint32_t t_ms;
+};
+
+static struct ppg_frame pend[PPG_PEND_LEN];
+static uint8_t pend_rd, pend_n;
+
+static const struct spo2_cal spo2_cal = SPO2_CAL_DEFAULT;
+static struct spo2_engine spo2;
+
+static struct ppg_agc agc;
+
+static struct ppg_chsel chsel;
+static struct ppg_sqi sqi;
+static uint8_t sqi_pass = PPG_LED_ALL;      /* channels the engines may use */
+static uint8_t slot_mask = PPG_LED_ALL;     /* layout of frames in the FIFO */
+static uint8_t hr_src = PPG_LED_GREEN;
+static uint32_t last[PPG_LED_COUNT];        /* newest sample per channel */
+
+static atomic_t spo2_req_s;
+static atomic_t low_rate;
+static atomic_t offwrist_req;
+static bool offwrist;
+static atomic_t ppg_on = ATOMIC_INIT(1);
+static K_SEM_DEFINE(on_sem, 0, 1);
+
+static const struct ppg_sched_cfg sched_cfg = PPG_SCHED_CFG_DEFAULT;
+static struct ppg_sched sched;
+static struct ppg_sched_cfg sched_new;      /* from CTRL_PPG_SCHED */
+static bool sched_pending;
+static struct k_spinlock sched_lock;
+static bool ppg_shdn;
+static uint16_t sess_hr_x10, sess_spo2_x10;
+static uint32_t lit_ms;
+static int64_t lit_since;
+
+static const uint8_t led_pa_reg[PPG_LED_COUNT] = {
+	[PPG_LED_RED]   = REG_LED1_PA,
+	[PPG_LED_IR]    = REG_LED2_PA,
+	[PPG_LED_GREEN] = REG_LED3_PA,
+};
+
 static int wr(uint8_t reg, uint8_t val)
 {
 	return i2c_reg_write_byte(i2c_dev, MAX30101_I2C_ADDR, reg, val);
@@ -41,6 +169,16 @@ static int rd(uint8_t reg, uint8_t *val)
 	return i2c_reg_read_byte(i2c_dev, MAX30101_I2C_ADDR, reg, val);
 }
 
+static int popcount_u8(uint8_t v)
+{
+	int n = 0;
+
+	for (; v; v &= (uint8_t)(v - 1)) {
+		n++;
+	}
+	return n;
+}
+
 static uint32_t parse_sample18(const uint8_t b[3])
 {
 	uint32_t v = ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
@@ -61,6 +199,28 @@ static void dump_regs(void)
 	rd(REG_LED3_PA, &v);          LOG_INF("LED3_PA (GREEN)  (0x0E) = 0x%02X", v);
 }
 
+/* Pack the enabled LEDs into consecutive slots (a disabled slot ends the sequence).
+ * Both control registers go out in one burst so no frame sees a half-written layout.
+ */
+static int slots_write(uint8_t mask)
+{
+	uint8_t code[4] = { 0 };
+	int n = 0;
+
+	for (int led = 0; led < PPG_LED_COUNT; led++) {
+		if (mask & PPG_LED_BIT(led)) {
+			code[n++] = (uint8_t)(led + 1);   /* 1=LED1(RED) 2=LED2(IR) 3=LED3(GREEN) */
+		}
+	}
+
+	uint8_t regs[2] = {
+		(uint8_t)((code[1] << 4) | code[0]),
+		(uint8_t)((code[3] << 4) | code[2]),
+	};
+
+	return i2c_burst_write(i2c_dev, MAX30101_I2C_ADDR, REG_MULTI_LED_CTRL1, regs, sizeof(regs));
+}
+
 static bool max30101_reset_wait(void)
 {
 	/* Reset bit is MODE_CONFIG bit6. We write it then poll until it clears. */
@@ -108,19 +268,18 @@ static void max30101_manual_init(void)
 	wr(REG_FIFO_CONFIG, 0x1F);
 
 	/* Multi-LED mode */
-	wr(REG_MODE_CONFIG, 0x07);
+	wr(REG_MODE_CONFIG, MODE_MULTI_LED);
 
-	/* SPO2 config (keep your working value) */
-	wr(REG_SPO2_CONFIG, 0x27);
+	/* SPO2 config (0x27 = 4096nA, 100sps, 411us); ADC range is then owned by the AGC */
+	wr(REG_SPO2_CONFIG, SPO2_CFG(SPO2_CFG_RGE_INIT));
 
-	/* LED currents (0x24 ~ moderate) */
-	wr(REG_LED1_PA, 0x24);  /* RED */
-	wr(REG_LED2_PA, 0x24);  /* IR  */
-	wr(REG_LED3_PA, 0x24);  /* GREEN */
+	/* LED currents: start moderate, the AGC takes over from here */
+	wr(REG_LED1_PA, LED_PA_INIT);  /* RED */
+	wr(REG_LED2_PA, LED_PA_INIT);  /* IR  */
+	wr(REG_LED3_PA, LED_PA_INIT);  /* GREEN */
 
-	/* Slots: S1=LED1(RED), S2=LED2(IR), S3=LED3(GREEN), S4=NONE */
-	wr(REG_MULTI_LED_CTRL1, 0x21);
-	wr(REG_MULTI_LED_CTRL2, 0x03);
+	/* Slots: S1=LED1(RED), S2=LED2(IR), S3=LED3(GREEN), S4=NONE (0x21/0x03) */
+	slots_write(PPG_LED_ALL);
 
 	/* Clear FIFO pointers */
 	wr(REG_FIFO_WR_PTR,  0x00);
@@ -136,6 +295,637 @@ static void max30101_manual_init(void)
 	dump_regs();
 }
 
+static void hr_publish(void)
+{
+	struct hr_result r;
+	uint32_t cyc_max, anc_max;
+	uint32_t cyc = dsp_cyc_take(&hr_cyc, &cyc_max);
+	uint32_t anc_avg = dsp_cyc_take(&anc_cyc, &anc_max);
+
+	hr_engine_result(&hr, k_uptime_get_32(), &r);
+
+	struct rec_hr rec = {
+		.bpm_x10 = r.bpm_x10,
+		.conf = r.conf,
+		.n_beats = r.n_beats,
+		.cyc_per_smp = (uint16_t)MIN(cyc, UINT16_MAX),
+		.anc_cyc = (uint16_t)MIN(anc_avg, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_HR, &rec, sizeof(rec));
+	if (r.bpm_x10) {
+		sess_hr_x10 = r.bpm_x10;
+		stress_post_hr(r.bpm_x10);
+		activity_post_hr(r.bpm_x10);
+		sleep_post_hr(r.bpm_x10);
+	}
+
+	LOG_INF("HR bpm=%u.%u conf=%u beats=%u | cyc/smp hr=%u (max %u) anc=%u (max %u)",
+		r.bpm_x10 / 10, r.bpm_x10 % 10, r.conf, r.n_beats, cyc, cyc_max,
+		anc_avg, anc_max);
+}
+
+static void ibi_flush(void)
+{
+	if (ibi_n == 0) {
+		return;
+	}
+	if (!chan_sub_wanted(CHAN_HRV)) {
+		ibi_n = 0;
+		return;
+	}
+	(void)ble_rec_send(REC_IBI, &ibi_rec,
+			   sizeof(ibi_rec.t_last_ms) + ibi_n * sizeof(ibi_rec.ibi_ms[0]));
+	ibi_n = 0;
+}
+
+static void ibi_add(const struct hr_beat *b)
+{
+	hrv_engine_beat(&hrv, b->t_ms, b->ibi_ms);
+
+	ibi_rec.ibi_ms[ibi_n++] = b->ibi_ms;
+	ibi_rec.t_last_ms = b->t_ms;
+	if (ibi_n == REC_IBI_MAX) {
+		ibi_flush();
+	}
+}
+
+static void hrv_publish(void)
+{
+	struct hrv_result r;
+	uint32_t c0 = dsp_cyc_now();
+
+	hrv_engine_result(&hrv, k_uptime_get_32(), &r);
+
+	uint32_t cyc = dsp_cyc_now() - c0;
+
+	ibi_flush();
+
+	struct rec_hrv rec = {
+		.rmssd_x10 = r.rmssd_x10,
+		.sdnn_x10 = r.sdnn_x10,
+		.pnn50 = r.pnn50,
+		.n_ibi = (uint8_t)MIN(r.n_ibi, UINT8_MAX),
+		.lf_ms2 = r.lf_ms2,
+		.hf_ms2 = r.hf_ms2,
+		.lf_hf_x100 = r.lf_hf_x100,
+		.kcyc = (uint16_t)MIN(cyc / 1000, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_HRV, &rec, sizeof(rec));
+	if (r.td_ok) {
+		stress_post_hrv(r.rmssd_x10);
+		sleep_post_hrv(r.rmssd_x10);
+	}
+
+	LOG_INF("HRV rmssd=%u.%u sdnn=%u.%u pnn50=%u n=%u | lf=%u hf=%u lf/hf=%u.%02u%s | cyc=%u",
+		r.rmssd_x10 / 10, r.rmssd_x10 % 10, r.sdnn_x10 / 10, r.sdnn_x10 % 10,
+		r.pnn50, r.n_ibi, r.lf_ms2, r.hf_ms2,
+		r.lf_hf_x100 / 100, r.lf_hf_x100 % 100, r.fd_ok ? "" : " (no spectrum)", cyc);
+}
+
+static void resp_publish(void)
+{
+	struct resp_result r;
+
+	resp_engine_result(&resp, k_uptime_get_32(), &r);
+
+	struct rec_resp rec = {
+		.brpm_x10 = r.brpm_x10,
+		.quality = r.quality,
+		.used = r.used,
+		.am_x10 = r.rate_x10[RESP_AM],
+		.bw_x10 = r.rate_x10[RESP_BW],
+		.fm_x10 = r.rate_x10[RESP_FM],
+	};
+	(void)ble_rec_send(REC_RESP, &rec, sizeof(rec));
+
+	LOG_INF("RESP %u.%u/min q=%u used=0x%X | am=%u bw=%u fm=%u",
+		r.brpm_x10 / 10, r.brpm_x10 % 10, r.quality, r.used,
+		rec.am_x10, rec.bw_x10, rec.fm_x10);
+}
+
+static void spo2_publish(void)
+{
+	struct spo2_result r;
+
+	spo2_engine_result(&spo2, &r);
+
+	struct rec_spo2 rec = {
+		.spo2_x10 = r.spo2_x10,
+		.r_x1000 = r.r_x1000,
+		.conf = r.conf,
+		.n_beats = r.n_beats,
+	};
+	(void)ble_rec_send(REC_SPO2, &rec, sizeof(rec));
+	if (r.spo2_x10) {
+		sess_spo2_x10 = r.spo2_x10;
+	}
+
+	LOG_INF("SPO2 %u.%u%% R=%u conf=%u beats=%u%s",
+		r.spo2_x10 / 10, r.spo2_x10 % 10, r.r_x1000, r.conf, r.n_beats,
+		r.spo2_x10 ? "" : " (gated)");
+}
+
+static void ppg_pump(bool flush);
+
+static void agc_apply(void)
+{
+	struct ppg_agc_event ev[PPG_LED_COUNT];
+	int n = ppg_agc_eval(&agc, ev, ARRAY_SIZE(ev));
+
+	for (int i = 0; i < n; i++) {
+		if (ev[i].led == AGC_LED_RANGE) {
+			wr(REG_SPO2_CONFIG, SPO2_CFG(ev[i].to));
+		} else {
+			wr(led_pa_reg[ev[i].led], ev[i].to);
+		}
+
+		struct rec_agc rec = {
+			.led = ev[i].led,
+			.from = ev[i].from,
+			.to = ev[i].to,
+			.reason = ev[i].reason,
+			.dc = ev[i].dc,
+		};
+		if (chan_sub_wanted(CHAN_PPG_DIAG)) {
+			(void)ble_rec_send(REC_AGC, &rec, sizeof(rec));
+		}
+
+		LOG_INF("AGC led=%u 0x%02X->0x%02X why=%u dc=%u",
+			ev[i].led, ev[i].from, ev[i].to, ev[i].reason, ev[i].dc);
+	}
+
+	if (n) {
+		/* DC step would corrupt the ratio for this beat */
+		ppg_pump(true);
+		spo2_engine_discard(&spo2);
+	}
+}
+
+#define SPO2_LEDS  (PPG_LED_BIT(PPG_LED_RED) | PPG_LED_BIT(PPG_LED_IR))
+
+static bool spo2_slots_on(void)
+{
+	return (slot_mask & SPO2_LEDS) == SPO2_LEDS;
+}
+
+static bool hr_gate_open(void)
+{
+	return (sqi_pass & PPG_LED_BIT(hr_src)) != 0;
+}
+
+static bool spo2_gate_open(void)
+{
+	return spo2_slots_on() && (sqi_pass & SPO2_LEDS) == SPO2_LEDS;
+}
+
+/* New SQI windows: hand the scores to chsel and open/close the engine gates */
+static void sqi_update(uint8_t done)
+{
+	bool hr_was = hr_gate_open();
+	bool spo2_was = spo2_gate_open();
+
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if (!(done & PPG_LED_BIT(i))) {
+			continue;
+		}
+
+		const struct ppg_sqi_metrics *m = &sqi.ch[i].m;
+
+		ppg_chsel_set_score(&chsel, i, m->score);
+
+		struct rec_sqi rec = {
+			.led = (uint8_t)i,
+			.score = m->score,
+			.pi_x1e4 = m->pi_x1e4,
+			.periodicity = m->periodicity,
+			.clip_pct = m->clip_pct,
+			.motion_mg = m->motion_mg,
+		};
+		if (chan_sub_wanted(CHAN_PPG_DIAG)) {
+			(void)ble_rec_send(REC_SQI, &rec, sizeof(rec));
+		}
+
+		LOG_DBG("SQI led=%u score=%u pi=%u per=%u clip=%u%% mot=%u",
+			i, m->score, m->pi_x1e4, m->periodicity, m->clip_pct, m->motion_mg);
+	}
+
+	sqi_pass = 0;
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if (ppg_sqi_ok(&sqi, i)) {
+			sqi_pass |= PPG_LED_BIT(i);
+		}
+	}
+
+	/* The engines skipped the gated stretch: restart them on a clean edge */
+	if (!hr_was && hr_gate_open()) {
+		hr_engine_restart(&hr);
+		ppg_anc_restart(&anc);
+	}
+	if (!spo2_was && spo2_gate_open()) {
+		spo2_engine_discard(&spo2);
+	}
+	if (hr_was != hr_gate_open() || spo2_was != spo2_gate_open()) {
+		LOG_INF("SQI gate hr=%s spo2=%s (pass=0x%X)",
+			hr_gate_open() ? "open" : "closed",
+			spo2_gate_open() ? "open" : "closed", sqi_pass);
+	}
+}
+
+static void ppg_process_frame(const uint32_t x[PPG_LED_COUNT], uint32_t t_ms)
+{
+	bool beat = false;
+
+	/* Garbage in (off wrist, motion, clipping): don't spend cycles on it */
+	if (hr_gate_open()) {
+		int16_t acc[ANC_AXES] = { 0 };
+
+		/* -EAGAIN/-ENODATA: nearest accel or zeros, the canceller copes */
+		(void)motion_shared_accel_at(t_ms, acc);
+
+		uint32_t c0 = dsp_cyc_now();
+		int32_t bp = ppg_anc_step(&anc, x[hr_src], acc);
+		uint32_t c1 = dsp_cyc_now();
+
+		struct hr_beat b;
+
+		dsp_ema_step(&hr_base, (int32_t)x[hr_src]);
+		beat = hr_engine_push_filtered(&hr, bp, t_ms, &b);
+		dsp_cyc_add(&anc_cyc, c1 - c0);
+		dsp_cyc_add(&hr_cyc, dsp_cyc_now() - c1);
+
+		if (beat) {
+			ibi_add(&b);
+			resp_engine_beat(&resp, b.t_ms, b.amp, dsp_ema_get(&hr_base), b.ibi_ms);
+		}
+	}
+
+	if (spo2_gate_open()) {
+		spo2_engine_push(&spo2, x[PPG_LED_RED], x[PPG_LED_IR]);
+		if (beat) {
+			spo2_engine_beat(&spo2);
+		}
+	}
+
+	uint8_t done = ppg_sqi_push(&sqi, x, motion_shared_get());
+
+	if (done) {
+		sqi_update(done);
+	}
+}
+
+/* Process queued frames. Unless flushing, stop at the first frame the IMU has
+ * not caught up with yet so the canceller reference lines up in time.
+ */
+static void ppg_pump(bool flush)
+{
+	uint32_t imu_t = 0;
+	bool imu = motion_shared_accel_latest(&imu_t);
+	uint32_t now = k_uptime_get_32();
+
+	while (pend_n) {
+		const struct ppg_frame *f = &pend[pend_rd];
+
+		if (!flush && imu && (int32_t)(f->t_ms - imu_t) > 0 &&
+		    (int32_t)(now - f->t_ms) < PPG_IMU_WAIT_MS) {
+			break;
+		}
+		ppg_process_frame(f->x, f->t_ms);
+		pend_rd = (pend_rd + 1) % PPG_PEND_LEN;
+		pend_n--;
+	}
+}
+
+static void ppg_enqueue(const uint32_t x[PPG_LED_COUNT], uint32_t t_ms)
+{
+	if (pend_n == PPG_PEND_LEN) {
+		ppg_process_frame(pend[pend_rd].x, pend[pend_rd].t_ms);
+		pend_rd = (pend_rd + 1) % PPG_PEND_LEN;
+		pend_n--;
+	}
+
+	struct ppg_frame *f = &pend[(pend_rd + pend_n) % PPG_PEND_LEN];
+
+	memcpy(f->x, x, sizeof(f->x));
+	f->t_ms = t_ms;
+	pend_n++;
+
+	/* LED control follows the raw stream, it needs no alignment */
+	if (ppg_agc_push(&agc, x)) {
+		agc_apply();
+	}
+}
+
+/* Read and process every pending frame; returns frames read or <0 on error */
+static int ppg_drain(void)
+{
+	uint8_t wrp = 0, rdp = 0, ovf = 0;
+
+	if (rd(REG_FIFO_WR_PTR, &wrp) != 0 ||
+	    rd(REG_FIFO_RD_PTR, &rdp) != 0 ||
+	    rd(REG_FIFO_OVF_CNT, &ovf) != 0) {
+		LOG_ERR("Failed to read FIFO pointers");
+		return -EIO;
+	}
+
+	/* On overflow WR == RD and the FIFO is full */
+	uint8_t available = ovf ? FIFO_DEPTH : ((wrp - rdp) & 0x1F);
+
+	dbg_wrp = wrp;
+	dbg_rdp = rdp;
+	dbg_ovf = ovf;
+	dbg_avail = available;
+
+	if (available == 0) {
+		return 0;
+	}
+
+	/* Drain every pending frame in one burst so the engines see the full 100 sps */
+	size_t frame_bytes = (size_t)popcount_u8(slot_mask) * SAMPLE_BYTES;
+	int err = i2c_burst_read(i2c_dev, MAX30101_I2C_ADDR, REG_FIFO_DATA,
+				 fifo_buf, available * frame_bytes);
+	if (err) {
+		LOG_ERR("FIFO read err=%d", err);
+		return err;
+	}
+
+	/* Newest frame was sampled ~now; older ones are one period apart */
+	uint32_t now = k_uptime_get_32();
+
+	for (uint8_t i = 0; i < available; i++) {
+		const uint8_t *f = &fifo_buf[i * frame_bytes];
+		uint32_t t_ms = now - (uint32_t)(available - 1 - i) * PPG_TS_MS;
+		uint32_t x[PPG_LED_COUNT] = { 0 };
+
+		for (int led = 0; led < PPG_LED_COUNT; led++) {
+			if (slot_mask & PPG_LED_BIT(led)) {
+				x[led] = parse_sample18(f);
+				last[led] = x[led];
+				f += SAMPLE_BYTES;
+			}
+		}
+
+		ppg_enqueue(x, t_ms);
+	}
+
+	ppg_pump(false);
+	return available;
+}
+
+/* Switch to chsel.slots without breaking the sample cadence of the channels that stay on */
+static void ppg_reconfigure(void)
+{
+	uint8_t old_mask = slot_mask;
+
+	/* Everything already sampled uses the old layout */
+	(void)ppg_drain();
+	ppg_pump(true);
+
+	if (slots_write(chsel.slots) != 0) {
+		LOG_ERR("MULTI_LED write failed");
+		return;
+	}
+
+	/* Frames sampled between the drain and the write have an ambiguous layout:
+	 * skip them and repeat the last value so every engine keeps its 100 sps clock.
+	 */
+	uint8_t wrp = 0, rdp = 0;
+	rd(REG_FIFO_WR_PTR, &wrp);
+	rd(REG_FIFO_RD_PTR, &rdp);
+	uint8_t lost = (wrp - rdp) & 0x1F;
+
+	wr(REG_FIFO_RD_PTR, wrp);
+	wr(REG_FIFO_OVF_CNT, 0x00);
+
+	slot_mask = chsel.slots;
+	ppg_agc_set_active(&agc, slot_mask);
+	ppg_sqi_set_enabled(&sqi, slot_mask);
+
+	if (hr_src != chsel.hr_src) {
+		hr_src = chsel.hr_src;
+		hr_engine_restart(&hr);
+		ppg_anc_restart(&anc);
+		hr_base.init = false;
+	}
+	if (spo2_slots_on() && !(old_mask & PPG_LED_BIT(PPG_LED_RED))) {
+		spo2_engine_init(&spo2, &spo2_cal);
+	}
+	sqi_update(0);
+
+	uint32_t now = k_uptime_get_32();
+
+	for (uint8_t i = 0; i < lost; i++) {
+		ppg_enqueue(last, now - (uint32_t)(lost - 1 - i) * PPG_TS_MS);
+	}
+
+	LOG_INF("PPG slots 0x%X->0x%X hr_src=%u held=%u | SQI R=%u IR=%u G=%u",
+		old_mask, slot_mask, hr_src, lost,
+		chsel.score[PPG_LED_RED], chsel.score[PPG_LED_IR], chsel.score[PPG_LED_GREEN]);
+}
+
+void max30101_request_spo2(uint16_t seconds)
+{
+	atomic_set(&spo2_req_s, seconds);
+}
+
+void max30101_set_offwrist(bool on)
+{
+	atomic_set(&offwrist_req, on);
+}
+
+/* Writing MODE with PROX_INT_EN set (re-)enters proximity mode */
+static void prox_arm(void)
+{
+	uint8_t tmp;
+
+	rd(REG_INTR_STATUS_1, &tmp);
+	wr(REG_INTR_ENABLE_1, INTR_PROX);
+	wr(REG_MODE_CONFIG, MODE_MULTI_LED);
+}
+
+static void offwrist_enter(void)
+{
+	(void)ppg_drain();
+	ppg_pump(true);
+
+	for (int led = 0; led < PPG_LED_COUNT; led++) {
+		wr(led_pa_reg[led], 0);
+	}
+	wr(REG_PILOT_PA, PROX_PILOT_PA);
+	wr(REG_PROX_INT_THRESH, PROX_THRESH);
+	prox_arm();
+	LOG_INF("PPG off wrist: LEDs dark, proximity armed");
+}
+
+static void offwrist_poll(void)
+{
+	uint8_t s1 = 0;
+
+	if (rd(REG_INTR_STATUS_1, &s1)) {
+		return;
+	}
+	offwrist_post_prox((s1 & INTR_PROX) != 0);
+	if (s1 & INTR_PROX) {
+		/* the part went to normal mode with dark LEDs: back to proximity
+		 * until offwrist_task.c decides the watch is worn again
+		 */
+		prox_arm();
+	}
+}
+
+/* Publish deadlines; after the sensor was dark they start over rather than catch up */
+static struct {
+	int64_t dbg, hr, spo2, hrv, resp;
+} next;
+
+static void publish_restart(void)
+{
+	int64_t t = k_uptime_get();
+
+	next.dbg = t + 1000;
+	next.hr = t + chan_sub_period_ms(CHAN_HR, HR_PUBLISH_MS);
+	next.spo2 = t + chan_sub_period_ms(CHAN_SPO2, SPO2_PUBLISH_MS);
+	next.hrv = t + chan_sub_period_ms(CHAN_HRV, HRV_PUBLISH_MS);
+	next.resp = t + chan_sub_period_ms(CHAN_RESP, RESP_PUBLISH_MS);
+}
+
+/* LED-on time for the duty figure in REC_PPG_SPOT */
+static void lit_set(bool on)
+{
+	int64_t now = k_uptime_get();
+
+	if (on && !lit_since) {
+		lit_since = now;
+	} else if (!on && lit_since) {
+		lit_ms += (uint32_t)(now - lit_since);
+		lit_since = 0;
+	}
+}
+
+static uint16_t duty_pm(void)
+{
+	int64_t now = k_uptime_get();
+	uint64_t on = lit_ms + (lit_since ? (uint64_t)(now - lit_since) : 0);
+
+	return (uint16_t)(now > 0 ? on * 1000 / (uint64_t)now : 0);
+}
+
+/* Lit again after dark LEDs or shutdown: nothing in the FIFO is PPG and
+ * every engine starts over
+ */
+static void ppg_resume(void)
+{
+	wr(REG_MODE_CONFIG, MODE_MULTI_LED);
+	wr(REG_FIFO_WR_PTR, 0x00);
+	wr(REG_FIFO_OVF_CNT, 0x00);
+	wr(REG_FIFO_RD_PTR, 0x00);
+
+	hr_engine_restart(&hr);
+	ppg_anc_restart(&anc);
+	hr_base.init = false;
+	spo2_engine_discard(&spo2);
+	ppg_sqi_init(&sqi);
+	ppg_sqi_set_enabled(&sqi, slot_mask);
+	publish_restart();
+	lit_set(true);
+}
+
+static void offwrist_leave(void)
+{
+	wr(REG_INTR_ENABLE_1, 0x00);
+	for (int led = 0; led < PPG_LED_COUNT; led++) {
+		wr(led_pa_reg[led], agc.pa[led]);
+	}
+	ppg_resume();
+	LOG_INF("PPG on wrist: LEDs restored");
+}
+
+/* Spot check: between sessions the part is in shutdown (<1 uA), LEDs and
+ * ADC off; registers, and with them the AGC currents, are kept
+ */
+static void ppg_shutdown(void)
+{
+	(void)ppg_drain();
+	ppg_pump(true);
+	wr(REG_MODE_CONFIG, MODE_SHDN | MODE_MULTI_LED);
+	ppg_shdn = true;
+	lit_set(false);
+}
+
+static void ppg_wake(void)
+{
+	ppg_shdn = false;
+	ppg_resume();
+}
+
+void max30101_set_low_rate(uint8_t owner, bool on)
+{
+	if (on) {
+		atomic_or(&low_rate, owner);
+	} else {
+		atomic_and(&low_rate, ~(atomic_val_t)owner);
+	}
+}
+
+/* CTRL_PPG_SCHED: u8 mode | u8 flags | u16 period_s | u16 len_s | u16 quiet_wait_s
+ * CTRL_PPG_MEASURE: u16 seconds
+ */
+static void ppg_ctrl(const uint8_t *d, size_t len)
+{
+	if (d[0] == CTRL_PPG_MEASURE && len >= 3) {
+		max30101_request_spo2(sys_get_le16(&d[1]));
+		return;
+	}
+	if (d[0] != CTRL_PPG_SCHED || len < 9) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+	sched_new = (struct ppg_sched_cfg){
+		.mode = d[1],
+		.flags = d[2],
+		.period_s = sys_get_le16(&d[3]),
+		.len_s = sys_get_le16(&d[5]),
+		.quiet_wait_s = sys_get_le16(&d[7]),
+	};
+	sched_pending = true;
+	k_spin_unlock(&sched_lock, key);
+}
+
+static void sched_cfg_take(uint32_t now_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&sched_lock);
+	bool take = sched_pending;
+	struct ppg_sched_cfg cfg = sched_new;
+
+	sched_pending = false;
+	k_spin_unlock(&sched_lock, key);
+
+	if (take) {
+		ppg_sched_set_cfg(&sched, &cfg, now_ms);
+		LOG_INF("PPG schedule: %s, %us every %us, flags 0x%X, quiet wait %us",
+			cfg.mode == PPG_SCHED_SPOT ? "spot check" : "continuous",
+			sched.cfg.len_s, sched.cfg.period_s, cfg.flags, cfg.quiet_wait_s);
+	}
+}
+
+static void session_publish(void)
+{
+	struct rec_ppg_spot rec = {
+		.trig = sched.trig,
+		.spo2 = sched.spo2,
+		.len_s = (uint16_t)((k_uptime_get_32() - sched.start_ms) / 1000),
+		.hr_x10 = sess_hr_x10,
+		.spo2_x10 = sess_spo2_x10,
+		.duty_pm = duty_pm(),
+	};
+	(void)ble_rec_send(REC_PPG_SPOT, &rec, sizeof(rec));
+
+	LOG_INF("PPG session end (trig %u, %us) hr=%u.%u spo2=%u.%u | LEDs on %u.%u%% of uptime",
+		rec.trig, rec.len_s, rec.hr_x10 / 10, rec.hr_x10 % 10,
+		rec.spo2_x10 / 10, rec.spo2_x10 % 10, rec.duty_pm / 10, rec.duty_pm % 10);
+}
+
 static void max30101_thread(void *a, void *b, void *c)
 {
 	ARG_UNUSED(a);
@@ -152,53 +942,145 @@ static void max30101_thread(void *a, void *b, void *c)
 
 	max30101_manual_init();
 
-	uint32_t tick = 0;
+	dsp_cyc_init();
+	hr_engine_init(&hr);
+	ppg_anc_init(&anc);
+	hrv_engine_init(&hrv, &hrv_cfg);
+	resp_engine_init(&resp);
+	spo2_engine_init(&spo2, &spo2_cal);
+	ppg_agc_init(&agc, LED_PA_INIT, SPO2_CFG_RGE_INIT);
+	ppg_chsel_init(&chsel, PPG_SEL_MODE, k_uptime_get_32());
+	ppg_sqi_init(&sqi);
+	ppg_sched_init(&sched, &sched_cfg, k_uptime_get_32());
+	(void)ble_ctrl_register(CTRL_PPG_SCHED, CTRL_PPG_MEASURE, ppg_ctrl);
 
-	while (1) {
-		uint8_t wrp = 0, rdp = 0, ovf = 0;
+	publish_restart();
+	lit_set(true);
 
-		if (rd(REG_FIFO_WR_PTR, &wrp) != 0 ||
-		    rd(REG_FIFO_RD_PTR, &rdp) != 0 ||
-		    rd(REG_FIFO_OVF_CNT, &ovf) != 0) {
-			LOG_ERR("Failed to read FIFO pointers");
-			k_msleep(100);
+	while (1) {
+		/* no subscriber for anything PPG: shut down until there is one */
+		if (!atomic_get(&ppg_on)) {
+			if (offwrist) {
+				offwrist_leave();
+				offwrist = false;
+			}
+			if (!ppg_shdn) {
+				ppg_shutdown();
+				LOG_INF("PPG off: no subscriber");
+			}
+			offwrist_post_prox_unknown();
+			(void)k_sem_take(&on_sem, K_FOREVER);
 			continue;
 		}
 
-		uint8_t available = (wrp - rdp) & 0x1F;
+		bool off = atomic_get(&offwrist_req) != 0;
 
-		/* Always show progress even if no samples */
-		if ((++tick % 50) == 0) { /* ~1 second (50 * 20ms) */
-			uint8_t s1 = 0, s2 = 0, mc = 0;
-			rd(REG_INTR_STATUS_1, &s1);
-			rd(REG_INTR_STATUS_2, &s2);
-			rd(REG_MODE_CONFIG, &mc);
+		if (off != offwrist) {
+			offwrist = off;
+			if (off) {
+				offwrist_enter();
+				ppg_shdn = false;
+				lit_set(false);
+			} else {
+				offwrist_leave();
+			}
+		}
+		if (offwrist) {
+			offwrist_poll();
+			acq_batch_sleep(PPG_POLL_OFF_BATCHES);
+			continue;
+		}
 
-			LOG_INF("FIFO DBG | WR=%u RD=%u OVF=%u avail=%u | INT1=0x%02X INT2=0x%02X | MODE=0x%02X",
-				wrp, rdp, ovf, available, s1, s2, mc);
+		int64_t now = k_uptime_get();
+		uint16_t req_s = (uint16_t)atomic_set(&spo2_req_s, 0);
+		bool low = atomic_get(&low_rate) != 0;
+		struct ppg_sched_out so;
+
+		sched_cfg_take((uint32_t)now);
+		if (req_s) {
+			ppg_sched_demand(&sched, req_s);
 		}
+		/* low rate or nobody wanting SpO2: periodic sessions keep RED+IR dark */
+		int evt = ppg_sched_step(&sched, (uint32_t)now, motion_shared_is_low(),
+					 low || !chan_sub_wanted(CHAN_SPO2), &so);
 
-		if (available == 0) {
-			k_msleep(20);
+		if (evt == PPG_SCHED_EVT_START) {
+			sess_hr_x10 = 0;
+			sess_spo2_x10 = 0;
+			LOG_INF("PPG session start (trig %u)%s", sched.trig,
+				sched.spo2 ? " with SpO2" : "");
+		}
+		if (so.sensor_on == ppg_shdn) {
+			if (so.sensor_on) {
+				ppg_wake();
+			} else {
+				ppg_shutdown();
+			}
+		}
+		if (evt == PPG_SCHED_EVT_END) {
+			session_publish();
+		}
+		if (ppg_shdn) {
+			acq_batch_sleep(PPG_POLL_SHDN_BATCHES);
 			continue;
 		}
 
-		/* Read 1 frame: 3 samples (RED, IR, GREEN) => 9 bytes */
-		uint8_t raw[9];
-		int err = i2c_burst_read(i2c_dev, MAX30101_I2C_ADDR, REG_FIFO_DATA, raw, sizeof(raw));
-		if (err) {
-			LOG_ERR("FIFO read err=%d", err);
-			k_msleep(50);
+		if (ppg_drain() < 0) {
+			k_msleep(100);
 			continue;
 		}
 
-		uint32_t red   = parse_sample18(&raw[0]);
-		uint32_t ir    = parse_sample18(&raw[3]);
-		uint32_t green = parse_sample18(&raw[6]);
+		/* Show progress even if no samples, while somebody reads the log */
+		if (k_uptime_get() >= next.dbg) {
+			next.dbg += 1000;
+			offwrist_post_prox(last[hr_src] >= PPG_SKIN_DC_MIN);
+
+			if (chan_sub_wanted(CHAN_LOG)) {
+				uint8_t s1 = 0, s2 = 0, mc = 0;
+				rd(REG_INTR_STATUS_1, &s1);
+				rd(REG_INTR_STATUS_2, &s2);
+				rd(REG_MODE_CONFIG, &mc);
 
-		LOG_INF("PPG FIFO | RED=%u | IR=%u | GREEN=%u | avail=%u", red, ir, green, available);
+				LOG_INF("FIFO DBG | WR=%u RD=%u OVF=%u avail=%u | INT1=0x%02X INT2=0x%02X | MODE=0x%02X | SLOTS=0x%X | RED=%u IR=%u GREEN=%u",
+					dbg_wrp, dbg_rdp, dbg_ovf, dbg_avail, s1, s2, mc, slot_mask,
+					last[PPG_LED_RED], last[PPG_LED_IR], last[PPG_LED_GREEN]);
+			}
+		}
 
-		k_msleep(50);
+		if (ppg_chsel_update(&chsel, (uint32_t)now, so.spo2, motion_shared_is_low())) {
+			ppg_reconfigure();
+		}
+
+		/* results only for channels somebody consumes */
+		if (now >= next.hr) {
+			next.hr += chan_sub_period_ms(CHAN_HR, HR_PUBLISH_MS);
+			if (hr_gate_open() && chan_sub_wanted(CHAN_HR)) {
+				hr_publish();
+			}
+		}
+
+		if (now >= next.hrv) {
+			next.hrv += chan_sub_period_ms(CHAN_HRV, HRV_PUBLISH_MS);
+			if (hr_gate_open() && chan_sub_wanted(CHAN_HRV)) {
+				hrv_publish();
+			}
+		}
+
+		if (now >= next.resp) {
+			next.resp += chan_sub_period_ms(CHAN_RESP, RESP_PUBLISH_MS);
+			if (hr_gate_open() && chan_sub_wanted(CHAN_RESP)) {
+				resp_publish();
+			}
+		}
+
+		if (now >= next.spo2) {
+			next.spo2 += chan_sub_period_ms(CHAN_SPO2, SPO2_PUBLISH_MS);
+			if (spo2_gate_open() && chan_sub_wanted(CHAN_SPO2)) {
+				spo2_publish();
+			}
+		}
+
+		acq_batch_sleep(PPG_POLL_BATCHES);
 	}
 }
 
@@ -223,3 +1105,10 @@ void max30101_task_start(void)
 
 	k_thread_name_set(&max30101_tcb, "max30101_task");
 }
+
+void max30101_set_enabled(bool on)
+{
+	if (atomic_set(&ppg_on, on) != on && on) {
+		k_sem_give(&on_sem);
+	}
+}
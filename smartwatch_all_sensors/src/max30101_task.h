@@ -1,3 +1,25 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acq_policy.h"
 
 void max30101_task_start(void);
+
+/* Measure HR and SpO2 now for the given time (a demand session in
+ * ppg_sched.h terms; wakes the sensor in spot-check mode)
+ */
+void max30101_request_spo2(uint16_t seconds);
+
+/* Low rate: no automatic SpO2 sessions (RED+IR dark). HR keeps its
+ * 100 sps. Held while any acq_policy.h owner asks for it.
+ */
+void max30101_set_low_rate(uint8_t owner, bool on);
+
+/* Off wrist: all LEDs dark, only the proximity pilot; reflections are
+ * reported with offwrist_post_prox() (offwrist_task.c).
+ */
+void max30101_set_offwrist(bool on);
+
+/* Off: the part is shut down, nothing subscribes to a PPG channel (chan_sub.h) */
+void max30101_set_enabled(bool on);
@@ -0,0 +1,60 @@
+#include "mlp_int8.h"
+
+/* round(acc * mult / 2^31 / 2^shift), gemmlowp-style doubling high multiply */
+static int32_t requant(int32_t acc, int32_t mult, int shift)
+{
+	int64_t p = (int64_t)acc * mult;
+	int32_t hi = (int32_t)((p + (1LL << 30)) >> 31);
+
+	if (shift > 0) {
+		hi = (hi + (1 << (shift - 1))) >> shift;
+	}
+	return hi;
+}
+
+static void layer_run(const struct mlp_layer *l, const int8_t *in, int8_t *out)
+{
+	int32_t lo = l->relu ? l->out_zp : INT8_MIN;
+	const int8_t *w = l->w;
+
+	for (uint16_t o = 0; o < l->n_out; o++) {
+		int32_t acc = l->bias[o];
+
+		for (uint16_t i = 0; i < l->n_in; i++) {
+			acc += (int32_t)w[i] * in[i];
+		}
+		w += l->n_in;
+
+		int32_t y = requant(acc, l->mult_q31, l->shift) + l->out_zp;
+
+		out[o] = (int8_t)((y < lo) ? lo : ((y > INT8_MAX) ? INT8_MAX : y));
+	}
+}
+
+const int8_t *mlp_int8_run(const struct mlp_layer *layers, size_t n,
+			   const int8_t *in, int8_t *arena)
+{
+	const int8_t *x = in;
+
+	for (size_t k = 0; k < n; k++) {
+		if (layers[k].n_out > MLP_WIDTH_MAX) {
+			return NULL;
+		}
+
+		int8_t *y = arena + (k & 1) * MLP_WIDTH_MAX;
+
+		layer_run(&layers[k], x, y);
+		x = y;
+	}
+	return x;
+}
+
+size_t mlp_int8_size(const struct mlp_layer *layers, size_t n)
+{
+	size_t sz = 0;
+
+	for (size_t k = 0; k < n; k++) {
+		sz += (size_t)layers[k].n_in * layers[k].n_out + 4u * layers[k].n_out;
+	}
+	return sz;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Int8 fully connected network, TFLite-style affine quantisation:
+ *   real = scale * (q - zero_point)
+ * with symmetric per-tensor int8 weights (zero point 0) and int32 biases in
+ * units of in_scale * w_scale. Each layer folds in_scale * w_scale / out_scale
+ * into a Q31 multiplier and a right shift, as CMSIS-NN arm_fully_connected_s8
+ * does, so inference is integer only and layers chain without requantising.
+ * The input zero point is folded into the bias offline:
+ *   bias = round(b / (in_scale * w_scale)) - in_zp * sum(w row)
+ */
+struct mlp_layer {
+	uint16_t n_in;
+	uint16_t n_out;
+	const int8_t  *w;       /* n_out rows of n_in */
+	const int32_t *bias;    /* n_out */
+	int32_t  out_zp;
+	int32_t  mult_q31;      /* requantisation multiplier, 0.5..1 */
+	int8_t   shift;         /* right shift after the multiply, >= 0 */
+	uint8_t  relu;          /* clamp at out_zp */
+};
+
+/* Largest layer width the kernel supports (activation ping-pong size) */
+#define MLP_WIDTH_MAX  64
+#define MLP_ARENA_SIZE (2 * MLP_WIDTH_MAX)
+
+/* Run n layers on in[layers[0].n_in]. arena holds MLP_ARENA_SIZE bytes.
+ * Returns the output activations (inside arena) or NULL when a layer is
+ * wider than MLP_WIDTH_MAX.
+ */
+const int8_t *mlp_int8_run(const struct mlp_layer *layers, size_t n,
+			   const int8_t *in, int8_t *arena);
+
+/* Weight and bias bytes of the network (flash footprint of the model) */
+size_t mlp_int8_size(const struct mlp_layer *layers, size_t n);
@@ -0,0 +1,107 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "motion_shared.h"
+
+/* Until the IMU reports, assume movement (conservative for PPG decisions) */
+static atomic_t g_activity_mg = ATOMIC_INIT(UINT16_MAX);
+
+struct accel_sample {
+	uint32_t t_ms;
+	int16_t  a[3];
+};
+
+static struct accel_sample hist[MOTION_HIST_LEN];
+static uint8_t hist_head;   /* next write */
+static uint8_t hist_n;
+static struct k_spinlock hist_lock;
+
+void motion_shared_set(uint32_t activity_mg)
+{
+	atomic_set(&g_activity_mg, (atomic_val_t)activity_mg);
+}
+
+uint32_t motion_shared_get(void)
+{
+	return (uint32_t)atomic_get(&g_activity_mg);
+}
+
+bool motion_shared_is_low(void)
+{
+	return motion_shared_get() < MOTION_LOW_MG;
+}
+
+void motion_shared_put_accel(uint32_t t_ms, const int16_t a_mg[3])
+{
+	k_spinlock_key_t key = k_spin_lock(&hist_lock);
+
+	hist[hist_head] = (struct accel_sample){
+		.t_ms = t_ms, .a = { a_mg[0], a_mg[1], a_mg[2] },
+	};
+	hist_head = (hist_head + 1) % MOTION_HIST_LEN;
+	if (hist_n < MOTION_HIST_LEN) {
+		hist_n++;
+	}
+
+	k_spin_unlock(&hist_lock, key);
+}
+
+bool motion_shared_accel_latest(uint32_t *t_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&hist_lock);
+	bool ok = hist_n > 0;
+
+	if (ok) {
+		*t_ms = hist[(hist_head + MOTION_HIST_LEN - 1) % MOTION_HIST_LEN].t_ms;
+	}
+
+	k_spin_unlock(&hist_lock, key);
+	return ok;
+}
+
+int motion_shared_accel_at(uint32_t t_ms, int16_t a_mg[3])
+{
+	k_spinlock_key_t key = k_spin_lock(&hist_lock);
+	int ret = 0;
+
+	if (hist_n == 0) {
+		k_spin_unlock(&hist_lock, key);
+		return -ENODATA;
+	}
+
+	/* Walk back from the newest sample to the first one at or before t_ms */
+	uint8_t i = (hist_head + MOTION_HIST_LEN - 1) % MOTION_HIST_LEN;
+	const struct accel_sample *nxt = NULL;
+	const struct accel_sample *cur = &hist[i];
+
+	for (uint8_t k = 1; k < hist_n && (int32_t)(cur->t_ms - t_ms) > 0; k++) {
+		nxt = cur;
+		i = (i + MOTION_HIST_LEN - 1) % MOTION_HIST_LEN;
+		cur = &hist[i];
+	}
+
+	if (nxt == NULL) {
+		/* t_ms at/after the newest sample: hold it */
+		for (int ax = 0; ax < 3; ax++) {
+			a_mg[ax] = cur->a[ax];
+		}
+		ret = (cur->t_ms == t_ms) ? 0 : -EAGAIN;
+	} else if ((int32_t)(cur->t_ms - t_ms) > 0) {
+		/* older than the whole history: hold the oldest */
+		for (int ax = 0; ax < 3; ax++) {
+			a_mg[ax] = cur->a[ax];
+		}
+	} else {
+		int32_t span = (int32_t)(nxt->t_ms - cur->t_ms);
+		int32_t off = (int32_t)(t_ms - cur->t_ms);
+
+		for (int ax = 0; ax < 3; ax++) {
+			int32_t d = nxt->a[ax] - cur->a[ax];
+
+			a_mg[ax] = (int16_t)(cur->a[ax] + (span ? d * off / span : 0));
+		}
+	}
+
+	k_spin_unlock(&hist_lock, key);
+	return ret;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Wrist activity published by the IMU task for the PPG side:
+ * EMA of | |a| - baseline | in mg, the baseline a slow EMA of |a|.
+ */
+#define MOTION_LOW_MG   30
+
+void motion_shared_set(uint32_t activity_mg);
+uint32_t motion_shared_get(void);
+bool motion_shared_is_low(void);
+
+/* Timestamped accelerometer history (k_uptime ms, mg), written at the IMU
+ * sample rate (26 Hz samples once, not held to 104 Hz) and read back at
+ * the PPG sample times. Covers a drain interval plus the PPG's wait for it.
+ */
+#define MOTION_HIST_LEN 64      /* ~0.6 s @ 104 Hz (250 ms drains), ~2.4 s @ 26 Hz (1 s) */
+
+void motion_shared_put_accel(uint32_t t_ms, const int16_t a_mg[3]);
+
+/* Newest accel timestamp; false until the IMU has delivered a sample */
+bool motion_shared_accel_latest(uint32_t *t_ms);
+
+/* Accel at t_ms, linearly interpolated between the neighbouring samples.
+ * Returns 0, -EAGAIN if t_ms is newer than the newest sample (the nearest
+ * sample is still written) or -ENODATA if there is no history.
+ */
+int motion_shared_accel_at(uint32_t t_ms, int16_t a_mg[3]);
@@ -0,0 +1,56 @@
+#include <string.h>
+
+#include "offwrist_engine.h"
+
+void offwrist_engine_init(struct offwrist_engine *o, const struct offwrist_cfg *cfg)
+{
+	memset(o, 0, sizeof(*o));
+	o->cfg = *cfg;
+}
+
+bool offwrist_engine_step(struct offwrist_engine *o, const struct offwrist_in *in,
+			  uint32_t t_ms)
+{
+	const struct offwrist_cfg *c = &o->cfg;
+
+	if (in->motion_mg > c->still_mg || !o->moved) {
+		o->moved_ms = t_ms;
+		o->moved = true;
+	}
+
+	uint32_t still_for = t_ms - o->moved_ms;
+
+	if (o->off) {
+		bool recent = still_for <= c->motion_recent_ms;
+
+		if (in->eda == OW_YES || (in->prox == OW_YES && recent)) {
+			o->off = false;
+			o->voting = false;
+			return true;
+		}
+		return false;
+	}
+
+	uint8_t v = 0;
+
+	v += (in->prox == OW_NO) ? 2 : 0;
+	v += (in->eda == OW_NO) ? 1 : 0;
+	v += (in->temp_mc != INT32_MIN && in->temp_mc < c->skin_min_mc) ? 1 : 0;
+	v += (still_for >= c->still_ms) ? 1 : 0;
+	o->votes = v;
+
+	if (v < c->off_votes) {
+		o->voting = false;
+		return false;
+	}
+	if (!o->voting) {
+		o->voting = true;
+		o->vote_ms = t_ms;
+	}
+	if (t_ms - o->vote_ms < c->off_hold_ms) {
+		return false;
+	}
+	o->off = true;
+	o->voting = false;
+	return true;
+}
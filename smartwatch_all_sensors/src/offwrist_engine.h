@@ -0,0 +1,55 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Worn / not worn from four cues, each of which may be unknown:
+ *   prox    PPG reflection (on wrist: DC level, off wrist: MAX30101 PROX_INT)
+ *   eda     electrodes not flat-lined (ads1113_task.c flat_cnt)
+ *   temp    skin temperature above skin_min_mc
+ *   motion  wrist activity (motion_shared)
+ * Going off: votes (no reflection 2, flat EDA 1, cold 1, still for still_ms
+ * 1) at or above off_votes for off_hold_ms. Coming back is immediate on EDA
+ * contact, or on reflection with motion in the last motion_recent_ms (a
+ * reflective desk alone does not count).
+ */
+enum ow_cue {
+	OW_UNKNOWN = -1,
+	OW_NO = 0,
+	OW_YES = 1,
+};
+
+struct offwrist_cfg {
+	uint8_t  off_votes;
+	uint16_t off_hold_ms;
+	int32_t  skin_min_mc;
+	uint16_t still_mg;
+	uint32_t still_ms;
+	uint16_t motion_recent_ms;
+};
+
+#define OFFWRIST_CFG_DEFAULT { \
+	.off_votes = 3, .off_hold_ms = 10000, .skin_min_mc = 30000, \
+	.still_mg = 8, .still_ms = 60000, .motion_recent_ms = 5000 }
+
+struct offwrist_in {
+	int8_t   prox;          /* enum ow_cue */
+	int8_t   eda;           /* enum ow_cue: contact */
+	int32_t  temp_mc;       /* INT32_MIN = unknown */
+	uint32_t motion_mg;
+};
+
+struct offwrist_engine {
+	struct offwrist_cfg cfg;
+	bool     off;
+	bool     voting;        /* off votes reached, waiting out off_hold_ms */
+	uint32_t vote_ms;
+	uint32_t moved_ms;
+	bool     moved;
+	uint8_t  votes;
+};
+
+void offwrist_engine_init(struct offwrist_engine *o, const struct offwrist_cfg *cfg);
+
+/* Evaluate the cues at t_ms; returns true when the state changed */
+bool offwrist_engine_step(struct offwrist_engine *o, const struct offwrist_in *in,
+			  uint32_t t_ms);
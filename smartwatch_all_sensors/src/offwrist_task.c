@@ -0,0 +1,149 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "acq_batch.h"
+#include "ads1113_task.h"
+#include "as6221_task.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "lsm6dso_task.h"
+#include "max30101_task.h"
+#include "motion_shared.h"
+#include "offwrist_engine.h"
+#include "offwrist_task.h"
+#include "sensor_records.h"
+
+LOG_MODULE_REGISTER(offwrist, LOG_LEVEL_INF);
+
+#define OFFWRIST_TICK_MS     250      /* bounds the put-on latency */
+#define OFFWRIST_REPORT_MS   60000
+
+static const struct offwrist_cfg cfg = OFFWRIST_CFG_DEFAULT;
+static struct offwrist_engine eng;
+
+static atomic_t prox = ATOMIC_INIT(OW_UNKNOWN);
+static atomic_t prox_hit;           /* latched until the next tick */
+static atomic_t eda = ATOMIC_INIT(OW_UNKNOWN);
+static atomic_t temp_mc = ATOMIC_INIT(INT32_MIN);
+static atomic_t is_off;
+
+void offwrist_post_prox(bool reflection)
+{
+	atomic_set(&prox, reflection ? OW_YES : OW_NO);
+	if (reflection) {
+		atomic_set(&prox_hit, 1);
+	}
+}
+
+void offwrist_post_prox_unknown(void)
+{
+	atomic_set(&prox, OW_UNKNOWN);
+}
+
+void offwrist_post_eda(bool contact)
+{
+	atomic_set(&eda, contact ? OW_YES : OW_NO);
+}
+
+void offwrist_post_temp(int32_t mc)
+{
+	atomic_set(&temp_mc, mc);
+}
+
+bool offwrist_is_off(void)
+{
+	return atomic_get(&is_off) != 0;
+}
+
+static void acquisition_offwrist(bool off)
+{
+	max30101_set_offwrist(off);
+	lsm6dso_set_low_rate(ACQ_LOW_OFFWRIST, off);
+	ads1113_set_low_rate(ACQ_LOW_OFFWRIST, off);
+	as6221_set_low_rate(ACQ_LOW_OFFWRIST, off);
+	ble_set_low_power(off);
+}
+
+static void wear_publish(const struct offwrist_in *in, uint32_t t_ms)
+{
+	struct rec_wear rec = {
+		.worn = !eng.off,
+		.votes = eng.votes,
+		.prox = in->prox,
+		.eda = in->eda,
+		.temp_c10 = (in->temp_mc == INT32_MIN) ? INT16_MIN :
+			    (int16_t)CLAMP(in->temp_mc / 100, INT16_MIN + 1, INT16_MAX),
+		.still_s = (uint16_t)MIN((t_ms - eng.moved_ms) / 1000, UINT16_MAX),
+	};
+	(void)ble_rec_send(REC_WEAR, &rec, sizeof(rec));
+}
+
+static void offwrist_thread(void *a, void *b, void *c)
+{
+	ARG_UNUSED(a);
+	ARG_UNUSED(b);
+	ARG_UNUSED(c);
+
+	int64_t next_report = k_uptime_get() + OFFWRIST_REPORT_MS;
+
+	while (1) {
+		acq_batch_sleep(OFFWRIST_TICK_MS / ACQ_BATCH_MS);
+
+		if (!chan_sub_wanted(CHAN_WEAR)) {
+			/* nobody asks: assume worn, sensors back to their own rates */
+			if (eng.off) {
+				atomic_set(&is_off, 0);
+				acquisition_offwrist(false);
+			}
+			offwrist_engine_init(&eng, &cfg);
+			continue;
+		}
+
+		uint32_t t_ms = k_uptime_get_32();
+		struct offwrist_in in = {
+			.prox = (int8_t)(atomic_set(&prox_hit, 0) ? OW_YES : atomic_get(&prox)),
+			.eda = (int8_t)atomic_get(&eda),
+			.temp_mc = (int32_t)atomic_get(&temp_mc),
+			.motion_mg = motion_shared_get(),
+		};
+
+		if (offwrist_engine_step(&eng, &in, t_ms)) {
+			atomic_set(&is_off, eng.off);
+			acquisition_offwrist(eng.off);
+			wear_publish(&in, t_ms);
+			next_report = k_uptime_get() + OFFWRIST_REPORT_MS;
+
+			LOG_INF("%s | prox=%d eda=%d temp=%ld mC still=%u s",
+				eng.off ? "Off wrist" : "On wrist", in.prox, in.eda,
+				(long)in.temp_mc, (t_ms - eng.moved_ms) / 1000);
+		} else if (k_uptime_get() >= next_report) {
+			next_report += OFFWRIST_REPORT_MS;
+			wear_publish(&in, t_ms);
+		}
+	}
+}
+
+/* thread objects */
+#define OFFWRIST_STACK_SIZE 1024
+#define OFFWRIST_PRIORITY   5
+
+K_THREAD_STACK_DEFINE(offwrist_stack, OFFWRIST_STACK_SIZE);
+static struct k_thread offwrist_tcb;
+static bool started;
+
+void offwrist_task_start(void)
+{
+	if (started) {
+		return;
+	}
+	started = true;
+
+	offwrist_engine_init(&eng, &cfg);
+
+	k_thread_create(&offwrist_tcb, offwrist_stack, K_THREAD_STACK_SIZEOF(offwrist_stack),
+			offwrist_thread, NULL, NULL, NULL,
+			OFFWRIST_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(&offwrist_tcb, "offwrist_task");
+}
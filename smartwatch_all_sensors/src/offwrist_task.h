@@ -0,0 +1,21 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Off-wrist detection (offwrist_engine.h). Off the wrist the PPG LEDs go
+ * dark with only the MAX30101 proximity pilot running, the IMU, EDA and
+ * skin temperature drop to their low rates, and the radio to its low-power
+ * intervals. Putting the watch on brings everything back (REC_WEAR on each
+ * change) within 1-2 s when the proximity pilot sees skin after motion
+ * (the low-rate IMU drains once a second), or 2-2.5 s on EDA contact alone
+ * (four 500 ms shots in a row, ads1113_task.c).
+ */
+void offwrist_task_start(void);
+
+/* Cues from the sensor tasks (any thread) */
+void offwrist_post_prox(bool reflection);
+void offwrist_post_prox_unknown(void);      /* PPG powered down */
+void offwrist_post_eda(bool contact);
+void offwrist_post_temp(int32_t mc);
+
+bool offwrist_is_off(void);
@@ -0,0 +1,166 @@
+#include <string.h>
+
+#include "ppg_agc.h"
+
+#define AGC_FS              (1u << 18)
+#define AGC_DC_LO           (AGC_FS / 5)            /* 20 % */
+#define AGC_DC_HI           ((AGC_FS * 4) / 5)      /* 80 % */
+#define AGC_DC_TARGET       ((AGC_FS * 2) / 5)      /* 40 %: bias towards low current */
+#define AGC_SAT             (AGC_FS - 512)
+#define AGC_DC_NONE         (AGC_FS / 50)           /* ambient only: nothing to chase */
+
+#define AGC_PA_MIN          0x02    /* 0.4 mA */
+#define AGC_PA_MAX          0x7F    /* 25.4 mA, cap for battery life */
+#define AGC_RGE_MAX         3
+
+#define AGC_EVAL_SAMPLES    50      /* 0.5 s @ 100 sps */
+#define AGC_SETTLE_SAMPLES  20      /* ignore frames right after a change */
+#define AGC_EMA_SHIFT       3
+
+static void restart_measurement(struct ppg_agc *a)
+{
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		a->dc[i].init = false;
+		a->peak[i] = 0;
+	}
+	a->settle = AGC_SETTLE_SAMPLES;
+}
+
+void ppg_agc_init(struct ppg_agc *a, uint8_t pa, uint8_t rge)
+{
+	memset(a, 0, sizeof(*a));
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		a->dc[i] = (struct dsp_ema)DSP_EMA_INIT(AGC_EMA_SHIFT);
+		a->pa[i] = pa;
+	}
+	a->rge = rge;
+	a->active = PPG_LED_ALL;
+	a->settle = AGC_SETTLE_SAMPLES;
+}
+
+void ppg_agc_set_active(struct ppg_agc *a, uint8_t mask)
+{
+	a->active = mask & PPG_LED_ALL;
+	restart_measurement(a);
+}
+
+bool ppg_agc_push(struct ppg_agc *a, const uint32_t x[PPG_LED_COUNT])
+{
+	if (a->settle) {
+		a->settle--;
+		return false;
+	}
+
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if (!(a->active & (1u << i))) {
+			continue;
+		}
+		dsp_ema_step(&a->dc[i], (int32_t)x[i]);
+		if (x[i] > a->peak[i]) {
+			a->peak[i] = x[i];
+		}
+	}
+
+	if (++a->n < AGC_EVAL_SAMPLES) {
+		return false;
+	}
+	a->n = 0;
+	return true;
+}
+
+static uint32_t clamp_u32(uint32_t v, uint32_t lo, uint32_t hi)
+{
+	return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+/* PA that moves dc to the target, limited to one octave per step */
+static uint8_t pa_for_target(uint8_t pa, uint32_t dc)
+{
+	uint32_t want = dc ? ((uint32_t)pa * AGC_DC_TARGET) / dc : (uint32_t)pa * 2;
+
+	want = clamp_u32(want, pa / 2, (uint32_t)pa * 2);
+	return (uint8_t)clamp_u32(want, AGC_PA_MIN, AGC_PA_MAX);
+}
+
+int ppg_agc_eval(struct ppg_agc *a, struct ppg_agc_event *ev, int max_ev)
+{
+	uint32_t dc[PPG_LED_COUNT] = { 0 };
+	bool any_low = false, all_fit_x2 = true, sat_at_min = false;
+	int n = 0;
+
+	if (!a->active || max_ev <= 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if (!(a->active & (1u << i))) {
+			continue;
+		}
+		dc[i] = (uint32_t)dsp_ema_get(&a->dc[i]);
+		any_low |= dc[i] < AGC_DC_LO && dc[i] >= AGC_DC_NONE;
+		all_fit_x2 &= (dc[i] * 2) < AGC_DC_HI && a->peak[i] * 2 < AGC_SAT;
+		sat_at_min |= a->peak[i] >= AGC_SAT && a->pa[i] <= AGC_PA_MIN;
+	}
+
+	/* ADC range is shared by all slots: change it only when every channel agrees */
+	if (any_low && all_fit_x2 && a->rge > 0) {
+		ev[n++] = (struct ppg_agc_event){
+			.led = AGC_LED_RANGE, .from = a->rge, .to = a->rge - 1,
+			.reason = AGC_REASON_LOW, .dc = 0,
+		};
+		a->rge--;
+		restart_measurement(a);
+		return n;
+	}
+	if (sat_at_min && a->rge < AGC_RGE_MAX) {
+		ev[n++] = (struct ppg_agc_event){
+			.led = AGC_LED_RANGE, .from = a->rge, .to = a->rge + 1,
+			.reason = AGC_REASON_SAT, .dc = 0,
+		};
+		a->rge++;
+		restart_measurement(a);
+		return n;
+	}
+
+	for (int i = 0; i < PPG_LED_COUNT && n < max_ev; i++) {
+		if (!(a->active & (1u << i))) {
+			continue;
+		}
+
+		uint8_t reason;
+
+		if (a->peak[i] >= AGC_SAT) {
+			reason = AGC_REASON_SAT;
+		} else if (dc[i] > AGC_DC_HI) {
+			reason = AGC_REASON_HIGH;
+		} else if (dc[i] < AGC_DC_LO && dc[i] >= AGC_DC_NONE) {
+			reason = AGC_REASON_LOW;
+		} else {
+			continue;   /* inside the window: hysteresis, leave it alone */
+		}
+
+		/* Saturated readings under-report DC: always back off by half */
+		uint8_t to = (reason == AGC_REASON_SAT) ?
+			     (uint8_t)((a->pa[i] / 2 > AGC_PA_MIN) ? a->pa[i] / 2 : AGC_PA_MIN) :
+			     pa_for_target(a->pa[i], dc[i]);
+
+		if (to == a->pa[i]) {
+			continue;   /* already at a limit */
+		}
+
+		ev[n++] = (struct ppg_agc_event){
+			.led = (uint8_t)i, .from = a->pa[i], .to = to,
+			.reason = reason, .dc = dc[i],
+		};
+		a->pa[i] = to;
+	}
+
+	if (n) {
+		restart_measurement(a);
+	} else {
+		for (int i = 0; i < PPG_LED_COUNT; i++) {
+			a->peak[i] = 0;
+		}
+	}
+	return n;
+}
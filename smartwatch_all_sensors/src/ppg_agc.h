@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+#include "ppg_common.h"
+
+/* Closed-loop LED current control for the MAX30101.
+ * Holds each channel's DC level inside [AGC_DC_LO, AGC_DC_HI] of the 18-bit
+ * range. Low signal is fixed by ADC sensitivity first (free) and LED current
+ * second; high signal by LED current first, so we settle on the lowest
+ * current that keeps the DC in the window.
+ */
+#define AGC_LED_RANGE   0xFF    /* ppg_agc_event.led value for ADC range changes */
+
+enum ppg_agc_reason {
+	AGC_REASON_LOW = 1,
+	AGC_REASON_HIGH,
+	AGC_REASON_SAT,
+};
+
+struct ppg_agc_event {
+	uint8_t  led;       /* enum ppg_led or AGC_LED_RANGE */
+	uint8_t  from;      /* PA code or ADC_RGE */
+	uint8_t  to;
+	uint8_t  reason;    /* enum ppg_agc_reason */
+	uint32_t dc;
+};
+
+struct ppg_agc {
+	struct dsp_ema dc[PPG_LED_COUNT];
+	uint32_t peak[PPG_LED_COUNT];
+	uint8_t  pa[PPG_LED_COUNT];
+	uint8_t  rge;       /* SPO2_CONFIG ADC_RGE, 0 = 2048 nA (most sensitive) .. 3 */
+	uint8_t  active;    /* bitmask of enum ppg_led being controlled */
+	uint16_t n;
+	uint16_t settle;
+};
+
+void ppg_agc_init(struct ppg_agc *a, uint8_t pa, uint8_t rge);
+
+/* Choose which LEDs take part (others keep their PA and are ignored) */
+void ppg_agc_set_active(struct ppg_agc *a, uint8_t mask);
+
+/* Feed one frame (raw 18-bit, indexed by enum ppg_led).
+ * Returns true when an evaluation is due.
+ */
+bool ppg_agc_push(struct ppg_agc *a, const uint32_t x[PPG_LED_COUNT]);
+
+/* Decide on new settings. Fills up to max_ev events and returns the count;
+ * the caller writes a->pa[] / a->rge to the sensor for each event.
+ */
+int ppg_agc_eval(struct ppg_agc *a, struct ppg_agc_event *ev, int max_ev);
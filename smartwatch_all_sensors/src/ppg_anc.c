@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "ppg_anc.h"
+
+#define ANC_SETTLE_SAMPLES  (2 * HR_FS_HZ)     /* band-pass transients */
+#define ANC_EPS_MG          5                   /* reference floor: no motion, no update */
+#define ANC_EPS             ((int64_t)ANC_AXES * ANC_TAPS * \
+			     ((ANC_EPS_MG << HR_IN_SHIFT) * (ANC_EPS_MG << HR_IN_SHIFT)))
+
+void ppg_anc_init(struct ppg_anc *a)
+{
+	memset(a, 0, sizeof(*a));
+}
+
+void ppg_anc_restart(struct ppg_anc *a)
+{
+	memset(a->bp_d, 0, sizeof(a->bp_d));
+	memset(a->bp_x, 0, sizeof(a->bp_x));
+	memset(a->x, 0, sizeof(a->x));
+	a->pwr = 0;
+	a->n_samples = 0;
+}
+
+int32_t ppg_anc_step(struct ppg_anc *a, uint32_t ppg, const int16_t acc_mg[ANC_AXES])
+{
+	int32_t d = dsp_biquad_cascade_step(hr_bandpass, a->bp_d, HR_BP_STAGES,
+					    (int32_t)ppg << HR_IN_SHIFT);
+	int64_t y = 0;
+
+	for (int ax = 0; ax < ANC_AXES; ax++) {
+		int32_t *x = a->x[ax];
+		int32_t in = dsp_biquad_cascade_step(hr_bandpass, a->bp_x[ax], HR_BP_STAGES,
+						     (int32_t)acc_mg[ax] << HR_IN_SHIFT);
+
+		a->pwr -= (int64_t)x[ANC_TAPS - 1] * x[ANC_TAPS - 1];
+		memmove(&x[1], &x[0], (ANC_TAPS - 1) * sizeof(x[0]));
+		x[0] = in;
+		a->pwr += (int64_t)in * in;
+
+		for (int k = 0; k < ANC_TAPS; k++) {
+			y += (int64_t)a->w[ax][k] * x[k];
+		}
+	}
+
+	int32_t e = dsp_sat32((int64_t)d - (y >> 16));
+
+	if (a->n_samples < ANC_SETTLE_SAMPLES) {
+		/* Filters still ringing from the DC step: don't learn from it */
+		a->n_samples++;
+		return d;
+	}
+
+	/* g = mu * e / (eps + |x|^2) in Q32 (Q16 weight step per unit x) */
+	int64_t g = (((int64_t)ANC_MU_Q15 * e) << 17) / (ANC_EPS + a->pwr);
+
+	for (int ax = 0; ax < ANC_AXES; ax++) {
+		for (int k = 0; k < ANC_TAPS; k++) {
+			a->w[ax][k] = dsp_sat32(a->w[ax][k] + ((g * a->x[ax][k]) >> 16));
+		}
+	}
+	return e;
+}
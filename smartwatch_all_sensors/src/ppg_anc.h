@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+#include "hr_engine.h"
+
+/* Adaptive motion-artifact canceller for the HR channel.
+ * Normalised LMS with the three accelerometer axes (resampled to the PPG
+ * sample times) as the noise reference. Both PPG and accel go through the
+ * pulse band-pass first; the filter predicts the part of the PPG that is
+ * correlated with motion and subtracts it.
+ *
+ *   e = d - sum w[ax][k] * x[ax][n-k]
+ *   w += mu * e * x / (eps + |x|^2)
+ */
+#define ANC_AXES        3
+#define ANC_TAPS        8       /* 80 ms of accel history per axis */
+#define ANC_MU_Q15      DSP_Q15(0.05)
+
+struct ppg_anc {
+	struct dsp_biquad_state bp_d[HR_BP_STAGES];
+	struct dsp_biquad_state bp_x[ANC_AXES][HR_BP_STAGES];
+	int32_t  x[ANC_AXES][ANC_TAPS];     /* newest first, mg << HR_IN_SHIFT */
+	int32_t  w[ANC_AXES][ANC_TAPS];     /* Q16 */
+	int64_t  pwr;                       /* sum of x^2 over all taps */
+	uint32_t n_samples;
+};
+
+void ppg_anc_init(struct ppg_anc *a);
+
+/* New input (channel switch or gap): re-settle filters, keep weights */
+void ppg_anc_restart(struct ppg_anc *a);
+
+/* One PPG sample (raw 18-bit) and the accel at the same instant.
+ * Returns the cleaned band-passed sample for hr_engine_push_filtered().
+ */
+int32_t ppg_anc_step(struct ppg_anc *a, uint32_t ppg, const int16_t acc_mg[ANC_AXES]);
@@ -0,0 +1,74 @@
+#include <string.h>
+
+#include "ppg_chsel.h"
+
+#define PPG_SEL_PROBE_MS     60000
+#define PPG_SEL_PROBE_LEN_MS 7000             /* settle window + SQI window + margin */
+#define PPG_SEL_IR_GAIN_PCT  125              /* IR must beat GREEN by 25 % */
+
+void ppg_chsel_init(struct ppg_chsel *c, enum ppg_sel_mode mode, uint32_t now_ms)
+{
+	memset(c, 0, sizeof(*c));
+	c->mode = mode;
+	c->slots = PPG_LED_ALL;
+	c->hr_src = PPG_LED_GREEN;
+	/* start with everything on: the first windows score all wavelengths */
+	c->probing = (mode == PPG_SEL_ADAPTIVE);
+	c->probe_end_ms = now_ms + PPG_SEL_PROBE_LEN_MS;
+	c->probe_at_ms = now_ms + PPG_SEL_PROBE_MS;
+}
+
+void ppg_chsel_set_score(struct ppg_chsel *c, enum ppg_led led, uint8_t score)
+{
+	c->score[led] = score;
+}
+
+static uint8_t hr_choice(const struct ppg_chsel *c, bool motion_low)
+{
+	/* IR penetrates deeper but is motion sensitive: only at rest, and only if clearly better */
+	if (motion_low &&
+	    (uint32_t)c->score[PPG_LED_IR] * 100 >
+	    (uint32_t)c->score[PPG_LED_GREEN] * PPG_SEL_IR_GAIN_PCT) {
+		return PPG_LED_IR;
+	}
+	return PPG_LED_GREEN;
+}
+
+bool ppg_chsel_update(struct ppg_chsel *c, uint32_t now_ms, bool spo2_wanted, bool motion_low)
+{
+	uint8_t slots, src;
+
+	if (c->mode == PPG_SEL_ALL) {
+		slots = PPG_LED_ALL;
+		src = PPG_LED_GREEN;
+	} else if (spo2_wanted) {
+		c->probing = false;
+		slots = PPG_LED_BIT(PPG_LED_RED) | PPG_LED_BIT(PPG_LED_IR);
+		src = PPG_LED_IR;
+	} else if (c->probing) {
+		if ((int32_t)(now_ms - c->probe_end_ms) < 0) {
+			return false;
+		}
+		c->probing = false;
+		src = hr_choice(c, motion_low);
+		slots = PPG_LED_BIT(src);
+	} else if ((int32_t)(now_ms - c->probe_at_ms) >= 0) {
+		/* Briefly light the HR candidates to refresh their scores */
+		c->probing = true;
+		c->probe_end_ms = now_ms + PPG_SEL_PROBE_LEN_MS;
+		c->probe_at_ms = now_ms + PPG_SEL_PROBE_MS;
+		slots = PPG_LED_BIT(PPG_LED_IR) | PPG_LED_BIT(PPG_LED_GREEN);
+		src = c->hr_src;
+	} else {
+		src = hr_choice(c, motion_low);
+		slots = PPG_LED_BIT(src);
+	}
+
+	if (slots == c->slots && src == c->hr_src) {
+		return false;
+	}
+
+	c->slots = slots;
+	c->hr_src = src;
+	return true;
+}
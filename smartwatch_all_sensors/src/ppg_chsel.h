@@ -0,0 +1,35 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ppg_common.h"
+
+/* Adaptive LED slot selection.
+ * Only the wavelengths the current task needs stay enabled:
+ *   - SpO2 measurement running: RED + IR (HR from IR)
+ *   - HR only: GREEN, or IR alone while motion is low and IR scores better
+ * Scores come from ppg_sqi; inactive wavelengths are re-scored by a short
+ * probe every PPG_SEL_PROBE_MS.
+ */
+enum ppg_sel_mode {
+	PPG_SEL_ALL = 0,    /* legacy: all three slots always on */
+	PPG_SEL_ADAPTIVE,
+};
+
+struct ppg_chsel {
+	enum ppg_sel_mode mode;
+	uint8_t  score[PPG_LED_COUNT];  /* last SQI score, 0 = not measured */
+	uint8_t  slots;                 /* enabled LEDs (PPG_LED_BIT mask) */
+	uint8_t  hr_src;                /* enum ppg_led feeding the HR engine */
+	bool     probing;
+	uint32_t probe_at_ms;
+	uint32_t probe_end_ms;
+};
+
+void ppg_chsel_init(struct ppg_chsel *c, enum ppg_sel_mode mode, uint32_t now_ms);
+
+/* Latest quality score of one channel (ppg_sqi_metrics.score) */
+void ppg_chsel_set_score(struct ppg_chsel *c, enum ppg_led led, uint8_t score);
+
+/* Re-evaluate the slot set. Returns true when slots or hr_src changed. */
+bool ppg_chsel_update(struct ppg_chsel *c, uint32_t now_ms, bool spo2_wanted, bool motion_low);
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+#include "hr_engine.h"
+
+/* MAX30101 LED channels, in FIFO slot order */
+enum ppg_led {
+	PPG_LED_RED = 0,
+	PPG_LED_IR,
+	PPG_LED_GREEN,
+	PPG_LED_COUNT,
+};
+
+#define PPG_LED_BIT(l)    (1u << (l))
+#define PPG_LED_ALL       ((1u << PPG_LED_COUNT) - 1)
+
+/* AC (band-passed peak-to-peak) and DC (mean) of one channel over a window */
+struct ppg_acdc {
+	struct dsp_biquad_state bp[HR_BP_STAGES];
+	int64_t  dc_sum;
+	int32_t  ac_min;
+	int32_t  ac_max;
+	uint16_t n;
+};
+
+static inline void ppg_acdc_reset_window(struct ppg_acdc *w)
+{
+	w->dc_sum = 0;
+	w->ac_min = INT32_MAX;
+	w->ac_max = INT32_MIN;
+	w->n = 0;
+}
+
+/* Returns the band-passed sample (scaled by 1 << HR_IN_SHIFT) */
+static inline int32_t ppg_acdc_push(struct ppg_acdc *w, uint32_t x)
+{
+	int32_t y = dsp_biquad_cascade_step(hr_bandpass, w->bp, HR_BP_STAGES,
+					    (int32_t)x << HR_IN_SHIFT);
+
+	w->dc_sum += x;
+	if (y < w->ac_min) {
+		w->ac_min = y;
+	}
+	if (y > w->ac_max) {
+		w->ac_max = y;
+	}
+	if (w->n < UINT16_MAX) {
+		w->n++;
+	}
+	return y;
+}
+
+/* Raw-unit AC/DC of the window; returns false if the window is empty */
+static inline bool ppg_acdc_get(const struct ppg_acdc *w, int32_t *ac, int32_t *dc)
+{
+	if (w->n == 0) {
+		*ac = 0;
+		*dc = 0;
+		return false;
+	}
+	*dc = (int32_t)(w->dc_sum / w->n);
+	*ac = (w->ac_max - w->ac_min) >> HR_IN_SHIFT;
+	return true;
+}
+
+/* Perfusion index AC/DC in units of 0.01 % */
+static inline uint32_t ppg_pi_x1e4(int32_t ac, int32_t dc)
+{
+	if (ac <= 0 || dc <= 0) {
+		return 0;
+	}
+	return (uint32_t)(((int64_t)ac * 10000) / dc);
+}
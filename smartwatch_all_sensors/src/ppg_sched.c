@@ -0,0 +1,91 @@
+#include <string.h>
+
+#include "ppg_sched.h"
+
+#define SCHED_PERIOD_MIN_S  10
+
+void ppg_sched_init(struct ppg_sched *s, const struct ppg_sched_cfg *cfg, uint32_t now_ms)
+{
+	memset(s, 0, sizeof(*s));
+	ppg_sched_set_cfg(s, cfg, now_ms);
+}
+
+void ppg_sched_set_cfg(struct ppg_sched *s, const struct ppg_sched_cfg *cfg, uint32_t now_ms)
+{
+	s->cfg = *cfg;
+	if (s->cfg.period_s < SCHED_PERIOD_MIN_S) {
+		s->cfg.period_s = SCHED_PERIOD_MIN_S;
+	}
+	if (s->cfg.len_s > s->cfg.period_s) {
+		s->cfg.len_s = s->cfg.period_s;
+	}
+	s->next_ms = now_ms + (uint32_t)s->cfg.period_s * 1000;
+	s->pending = false;
+}
+
+void ppg_sched_demand(struct ppg_sched *s, uint16_t seconds)
+{
+	if (seconds > s->demand_s) {
+		s->demand_s = seconds;
+	}
+}
+
+static void session_start(struct ppg_sched *s, uint32_t now_ms, uint8_t trig, uint16_t len_s,
+			  bool spo2)
+{
+	s->active = true;
+	s->pending = false;
+	s->trig = trig;
+	s->spo2 = spo2;
+	s->start_ms = now_ms;
+	s->until_ms = now_ms + (uint32_t)len_s * 1000;
+}
+
+int ppg_sched_step(struct ppg_sched *s, uint32_t now_ms, bool quiet, bool no_auto_spo2,
+		   struct ppg_sched_out *out)
+{
+	const struct ppg_sched_cfg *c = &s->cfg;
+	int evt = PPG_SCHED_EVT_NONE;
+
+	if ((int32_t)(now_ms - s->next_ms) >= 0) {
+		/* a session still running, or a pending one, absorbs this tick */
+		if (!s->active && !s->pending) {
+			s->pending = true;
+			s->due_ms = now_ms;
+		}
+		s->next_ms += (uint32_t)c->period_s * 1000;
+		if ((int32_t)(now_ms - s->next_ms) >= 0) {
+			s->next_ms = now_ms + (uint32_t)c->period_s * 1000;
+		}
+	}
+
+	if (s->demand_s) {
+		uint32_t until = now_ms + (uint32_t)s->demand_s * 1000;
+
+		if (!s->active) {
+			session_start(s, now_ms, PPG_TRIG_DEMAND, s->demand_s, true);
+			evt = PPG_SCHED_EVT_START;
+		} else {
+			s->spo2 = true;
+			if ((int32_t)(until - s->until_ms) > 0) {
+				s->until_ms = until;
+			}
+		}
+		s->demand_s = 0;
+	} else if (s->pending) {
+		bool waited = now_ms - s->due_ms >= (uint32_t)c->quiet_wait_s * 1000;
+
+		if (!(c->flags & PPG_SCHED_QUIET) || quiet || waited) {
+			session_start(s, now_ms, PPG_TRIG_PERIODIC, c->len_s,
+				      (c->flags & PPG_SCHED_SPO2) && !no_auto_spo2);
+			evt = PPG_SCHED_EVT_START;
+		}
+	} else if (s->active && (int32_t)(now_ms - s->until_ms) >= 0) {
+		s->active = false;
+		evt = PPG_SCHED_EVT_END;
+	}
+
+	out->sensor_on = c->mode == PPG_SCHED_CONTINUOUS || s->active;
+	out->spo2 = s->active && s->spo2;
+	return evt;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* PPG measurement scheduling.
+ * Continuous: the sensor always runs for HR; sessions only light RED+IR
+ * for SpO2. Spot check: the sensor is shut down outside sessions, so a
+ * session is a complete HR (and SpO2) measurement.
+ * Periodic sessions start every period_s for len_s; with PPG_SCHED_QUIET
+ * the start waits for a motion-quiet moment, at most quiet_wait_s. Demand
+ * sessions (host, alerts) start at once and always light RED+IR.
+ */
+enum ppg_sched_mode {
+	PPG_SCHED_CONTINUOUS = 0,
+	PPG_SCHED_SPOT,
+};
+
+#define PPG_SCHED_SPO2   0x01    /* periodic sessions light RED+IR */
+#define PPG_SCHED_QUIET  0x02    /* periodic sessions wait for motion-quiet */
+
+enum ppg_sched_trig {
+	PPG_TRIG_NONE = 0,
+	PPG_TRIG_PERIODIC,
+	PPG_TRIG_DEMAND,
+};
+
+enum ppg_sched_evt {
+	PPG_SCHED_EVT_NONE = 0,
+	PPG_SCHED_EVT_START,
+	PPG_SCHED_EVT_END,
+};
+
+struct ppg_sched_cfg {
+	uint8_t  mode;          /* enum ppg_sched_mode */
+	uint8_t  flags;         /* PPG_SCHED_* */
+	uint16_t period_s;
+	uint16_t len_s;
+	uint16_t quiet_wait_s;
+};
+
+#define PPG_SCHED_CFG_DEFAULT { \
+	.mode = PPG_SCHED_CONTINUOUS, .flags = PPG_SCHED_SPO2, \
+	.period_s = 300, .len_s = 30, .quiet_wait_s = 60 }
+
+struct ppg_sched {
+	struct ppg_sched_cfg cfg;
+	uint32_t next_ms;       /* next periodic session due */
+	uint32_t due_ms;        /* pending session became due */
+	uint32_t start_ms;
+	uint32_t until_ms;
+	bool     pending;
+	bool     active;
+	bool     spo2;          /* current session lights RED+IR */
+	uint8_t  trig;          /* enum ppg_sched_trig of the current session */
+	uint16_t demand_s;
+};
+
+struct ppg_sched_out {
+	bool sensor_on;
+	bool spo2;
+};
+
+void ppg_sched_init(struct ppg_sched *s, const struct ppg_sched_cfg *cfg, uint32_t now_ms);
+
+/* New policy; the periodic clock restarts from now */
+void ppg_sched_set_cfg(struct ppg_sched *s, const struct ppg_sched_cfg *cfg, uint32_t now_ms);
+
+/* Measure now for the given time, with SpO2 (extends a running session) */
+void ppg_sched_demand(struct ppg_sched *s, uint16_t seconds);
+
+/* Advance to now_ms. quiet: wrist motion is low. no_auto_spo2: periodic
+ * sessions keep RED+IR dark (low rate). Returns enum ppg_sched_evt.
+ */
+int ppg_sched_step(struct ppg_sched *s, uint32_t now_ms, bool quiet, bool no_auto_spo2,
+		   struct ppg_sched_out *out);
@@ -0,0 +1,166 @@
+#include <string.h>
+
+#include "ppg_sqi.h"
+
+#define SQI_FS              (1u << 18)
+#define SQI_CLIP_HI         (SQI_FS - 512)
+#define SQI_CLIP_LO         64
+
+#define SQI_PI_NONE         5       /* 0.05 %: no pulse */
+#define SQI_PI_GOOD         30      /* 0.3 % */
+#define SQI_PI_MAX          2000    /* 20 %: not physiological, motion */
+
+#define SQI_LAG_MAX         ((60 * HR_FS_HZ / SQI_DECIM) / 40)    /* 40 bpm */
+
+#define SQI_MOTION_OK_MG    100
+#define SQI_MOTION_BAD_MG   500
+
+#define SQI_CLIP_PCT_STEP   10      /* score lost per percent clipped */
+
+static void chan_reset(struct ppg_sqi_chan *c)
+{
+	memset(c, 0, sizeof(*c));
+	c->dec = (struct dsp_decim)DSP_DECIM_INIT(SQI_DECIM);
+	ppg_acdc_reset_window(&c->acdc);
+}
+
+static void chan_next_window(struct ppg_sqi_chan *c)
+{
+	ppg_acdc_reset_window(&c->acdc);
+	c->n_dec = 0;
+	c->n_clip = 0;
+	c->motion_max = 0;
+}
+
+void ppg_sqi_init(struct ppg_sqi *q)
+{
+	memset(q, 0, sizeof(*q));
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		chan_reset(&q->ch[i]);
+	}
+	q->enabled = PPG_LED_ALL;
+}
+
+void ppg_sqi_set_enabled(struct ppg_sqi *q, uint8_t mask)
+{
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if ((mask & PPG_LED_BIT(i)) && !(q->enabled & PPG_LED_BIT(i))) {
+			chan_reset(&q->ch[i]);
+			q->warm &= ~PPG_LED_BIT(i);
+			q->scored &= ~PPG_LED_BIT(i);
+		}
+	}
+	q->enabled = mask & PPG_LED_ALL;
+}
+
+/* Highest normalised autocorrelation after the first zero crossing, 0..100 */
+static uint8_t periodicity_pct(const int32_t *x, int n)
+{
+	int64_t r0 = 0, best = 0;
+	bool crossed = false;
+
+	for (int i = 0; i < n; i++) {
+		r0 += (int64_t)x[i] * x[i];
+	}
+	if (r0 <= 0) {
+		return 0;
+	}
+
+	for (int k = 1; k <= SQI_LAG_MAX && k < n; k++) {
+		int64_t rk = 0;
+
+		for (int i = 0; i + k < n; i++) {
+			rk += (int64_t)x[i] * x[i + k];
+		}
+		/* unbiased: compensate for the shorter overlap */
+		rk = rk * n / (n - k);
+
+		if (rk < 0) {
+			crossed = true;
+		} else if (crossed && rk > best) {
+			best = rk;
+		}
+	}
+
+	int64_t p = (best * 100) / r0;
+
+	return (uint8_t)((p > 100) ? 100 : p);
+}
+
+/* Linear 100 at 'good' down to 0 at 'bad' (either direction) */
+static uint32_t ramp(uint32_t v, uint32_t good, uint32_t bad)
+{
+	if (good < bad) {
+		return (v <= good) ? 100 : ((v >= bad) ? 0 : 100 * (bad - v) / (bad - good));
+	}
+	return (v >= good) ? 100 : ((v <= bad) ? 0 : 100 * (v - bad) / (good - bad));
+}
+
+static void chan_score(struct ppg_sqi_chan *c)
+{
+	struct ppg_sqi_metrics *m = &c->m;
+	int32_t ac, dc;
+
+	ppg_acdc_get(&c->acdc, &ac, &dc);
+	uint32_t pi = ppg_pi_x1e4(ac, dc);
+
+	m->pi_x1e4 = (uint16_t)((pi > UINT16_MAX) ? UINT16_MAX : pi);
+	m->periodicity = periodicity_pct(c->buf, c->n_dec);
+	m->clip_pct = (uint8_t)((c->n_clip * 100u) / SQI_WIN_SAMPLES);
+	m->motion_mg = (uint16_t)((c->motion_max > UINT16_MAX) ? UINT16_MAX : c->motion_max);
+
+	uint32_t s = (pi > SQI_PI_MAX) ? 0 : ramp(pi, SQI_PI_GOOD, SQI_PI_NONE);
+	uint32_t clip = (m->clip_pct * SQI_CLIP_PCT_STEP >= 100) ?
+			0 : 100 - m->clip_pct * SQI_CLIP_PCT_STEP;
+
+	s = s * m->periodicity / 100;
+	s = s * clip / 100;
+	s = s * ramp(c->motion_max, SQI_MOTION_OK_MG, SQI_MOTION_BAD_MG) / 100;
+	m->score = (uint8_t)s;
+}
+
+uint8_t ppg_sqi_push(struct ppg_sqi *q, const uint32_t x[PPG_LED_COUNT], uint32_t motion_mg)
+{
+	uint8_t done = 0;
+
+	for (int i = 0; i < PPG_LED_COUNT; i++) {
+		if (!(q->enabled & PPG_LED_BIT(i))) {
+			continue;
+		}
+
+		struct ppg_sqi_chan *c = &q->ch[i];
+		int32_t y = ppg_acdc_push(&c->acdc, x[i]);
+		int32_t d;
+
+		if (x[i] >= SQI_CLIP_HI || x[i] <= SQI_CLIP_LO) {
+			c->n_clip++;
+		}
+		if (motion_mg > c->motion_max) {
+			c->motion_max = motion_mg;
+		}
+		if (dsp_decim_push(&c->dec, y >> HR_IN_SHIFT, &d) && c->n_dec < SQI_DEC_LEN) {
+			c->buf[c->n_dec++] = d;
+		}
+
+		if (c->acdc.n < SQI_WIN_SAMPLES) {
+			continue;
+		}
+
+		if (q->warm & PPG_LED_BIT(i)) {
+			chan_score(c);
+			q->scored |= PPG_LED_BIT(i);
+			done |= PPG_LED_BIT(i);
+		}
+		q->warm |= PPG_LED_BIT(i);
+		chan_next_window(c);
+	}
+	return done;
+}
+
+bool ppg_sqi_ok(const struct ppg_sqi *q, enum ppg_led led)
+{
+	if (!(q->enabled & PPG_LED_BIT(led))) {
+		return false;
+	}
+	return !(q->scored & PPG_LED_BIT(led)) || q->ch[led].m.score >= SQI_MIN;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+#include "ppg_common.h"
+
+/* Per-window PPG signal quality index, one per LED channel.
+ * Every SQI_WIN_SAMPLES the window is scored from:
+ *   - perfusion index (band-passed AC / DC)
+ *   - periodicity: normalised autocorrelation at the pulse period. A clean
+ *     pulse puts its energy in one spectral line (plus harmonics), broadband
+ *     noise and motion do not, so this stands in for spectral purity.
+ *   - clipping: share of samples at either end of the 18-bit range
+ *   - motion: peak IMU activity during the window (motion_shared)
+ * Downstream engines only run on channels whose score is >= SQI_MIN.
+ */
+#define SQI_WIN_SAMPLES  (3 * HR_FS_HZ)
+#define SQI_DECIM        4                               /* 25 Hz for the autocorrelation */
+#define SQI_DEC_LEN      (SQI_WIN_SAMPLES / SQI_DECIM)
+#define SQI_MIN          40
+
+struct ppg_sqi_metrics {
+	uint16_t pi_x1e4;
+	uint16_t motion_mg;
+	uint8_t  periodicity;   /* 0..100 */
+	uint8_t  clip_pct;
+	uint8_t  score;         /* 0..100 */
+};
+
+struct ppg_sqi_chan {
+	struct ppg_acdc acdc;
+	struct dsp_decim dec;
+	int32_t  buf[SQI_DEC_LEN];
+	uint8_t  n_dec;
+	uint16_t n_clip;
+	uint32_t motion_max;
+	struct ppg_sqi_metrics m;
+};
+
+struct ppg_sqi {
+	struct ppg_sqi_chan ch[PPG_LED_COUNT];
+	uint8_t enabled;
+	uint8_t warm;       /* channels past their first (filter transient) window */
+	uint8_t scored;     /* channels with a valid m */
+};
+
+void ppg_sqi_init(struct ppg_sqi *q);
+
+/* Follow the FIFO slot set; newly enabled channels start over */
+void ppg_sqi_set_enabled(struct ppg_sqi *q, uint8_t mask);
+
+/* Feed one frame (raw 18-bit, indexed by enum ppg_led) and the current IMU
+ * activity. Returns the mask of channels whose window was just scored.
+ */
+uint8_t ppg_sqi_push(struct ppg_sqi *q, const uint32_t x[PPG_LED_COUNT], uint32_t motion_mg);
+
+/* Channel usable: enabled and either not scored yet or scored >= SQI_MIN */
+bool ppg_sqi_ok(const struct ppg_sqi *q, enum ppg_led led);
@@ -0,0 +1,200 @@
+#include <string.h>
+
+#include "resp_engine.h"
+
+/* 2nd-order Butterworth band-pass 0.1..0.7 Hz @ 4 Hz (6..42 breaths/min) */
+static const struct dsp_biquad_coef resp_bandpass[RESP_BP_STAGES] = {
+	DSP_BIQUAD(0.1311064399, 0.2622128798, 0.1311064399, -0.7068580236, 0.3338577379),
+	DSP_BIQUAD(1.0, -2.0, 1.0, -1.7880823487, 0.8153620681),
+};
+
+#define RESP_TS_MS        (1000 / RESP_FS_HZ)
+#define RESP_GAP_MS       3000    /* beats further apart: restart */
+#define RESP_SETTLE       (10 * RESP_FS_HZ)
+#define RESP_IV_MIN_MS    1400    /* 42 /min */
+#define RESP_IV_MAX_MS    10000   /* 6 /min */
+#define RESP_STALE_MS     20000
+#define RESP_MIN_IV       3
+#define RESP_CV_MAX_PCT   25
+#define RESP_AGREE_X10    40      /* 4 breaths/min */
+#define RESP_ENV_SHIFT    4       /* ~4 s envelope */
+
+/* Input headroom per series so the modulation survives integer filtering */
+static const uint8_t resp_in_shift[RESP_SERIES] = {
+	[RESP_AM] = 0,    /* band-passed PPG amplitude, already << HR_IN_SHIFT */
+	[RESP_BW] = 4,    /* raw 18-bit baseline */
+	[RESP_FM] = 8,    /* IBI in ms */
+};
+
+void resp_engine_init(struct resp_engine *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+static void restart(struct resp_engine *r, const int32_t v[RESP_SERIES])
+{
+	for (int i = 0; i < RESP_SERIES; i++) {
+		struct resp_track *tr = &r->s[i];
+
+		memset(tr->bp, 0, sizeof(tr->bp));
+		tr->env = (struct dsp_ema)DSP_EMA_INIT(RESP_ENV_SHIFT);
+		tr->x0 = v[i];
+		tr->armed = false;
+		tr->have_cross = false;
+	}
+	r->n_grid = 0;
+}
+
+static void track_push(struct resp_track *tr, int32_t x, uint32_t t_ms, bool settled)
+{
+	int32_t y = dsp_biquad_cascade_step(resp_bandpass, tr->bp, RESP_BP_STAGES, x);
+	int32_t thr = dsp_ema_step(&tr->env, dsp_abs32(y)) >> 2;
+
+	if (!settled) {
+		return;
+	}
+
+	if (y < -thr) {
+		tr->armed = true;
+		return;
+	}
+	if (!tr->armed || y <= thr) {
+		return;
+	}
+
+	/* upward crossing = one breath */
+	tr->armed = false;
+	uint32_t iv = t_ms - tr->last_cross_ms;
+
+	if (tr->have_cross && iv < RESP_IV_MIN_MS) {
+		return;     /* ripple, keep the earlier anchor */
+	}
+	if (tr->have_cross && iv <= RESP_IV_MAX_MS) {
+		tr->iv[tr->iv_pos] = (uint16_t)iv;
+		tr->iv_pos = (tr->iv_pos + 1) % RESP_INTERVALS;
+		if (tr->iv_n < RESP_INTERVALS) {
+			tr->iv_n++;
+		}
+	}
+	tr->last_cross_ms = t_ms;
+	tr->have_cross = true;
+}
+
+void resp_engine_beat(struct resp_engine *r, uint32_t t_ms, int32_t amp,
+		      int32_t base, uint16_t ibi_ms)
+{
+	if (ibi_ms == 0) {
+		r->have_prev = false;
+		return;
+	}
+
+	int32_t v[RESP_SERIES] = {
+		[RESP_AM] = amp << resp_in_shift[RESP_AM],
+		[RESP_BW] = base << resp_in_shift[RESP_BW],
+		[RESP_FM] = (int32_t)ibi_ms << resp_in_shift[RESP_FM],
+	};
+
+	if (!r->have_prev || (t_ms - r->prev_ms) > RESP_GAP_MS) {
+		restart(r, v);
+		r->grid_ms = t_ms;
+	} else {
+		int32_t span = (int32_t)(t_ms - r->prev_ms);
+
+		/* Linear resampling of the beat-rate series onto the RESP_FS_HZ grid */
+		while ((int32_t)(r->grid_ms - t_ms) < 0) {
+			int32_t off = (int32_t)(r->grid_ms - r->prev_ms);
+			bool settled = r->n_grid >= RESP_SETTLE;
+
+			for (int i = 0; i < RESP_SERIES; i++) {
+				int64_t x = r->prev_v[i] +
+					    ((int64_t)(v[i] - r->prev_v[i]) * off) / span;
+
+				track_push(&r->s[i], (int32_t)(x - r->s[i].x0), r->grid_ms, settled);
+			}
+			r->grid_ms += RESP_TS_MS;
+			r->n_grid++;
+		}
+	}
+
+	r->have_prev = true;
+	r->prev_ms = t_ms;
+	memcpy(r->prev_v, v, sizeof(v));
+}
+
+/* Mean interval as a rate, or 0 if too few / too irregular / stale */
+static uint16_t track_rate_x10(const struct resp_track *tr, uint32_t now_ms)
+{
+	if (tr->iv_n < RESP_MIN_IV || !tr->have_cross ||
+	    (now_ms - tr->last_cross_ms) > RESP_STALE_MS) {
+		return 0;
+	}
+
+	uint32_t sum = 0;
+	uint64_t sumsq = 0;
+
+	for (uint8_t i = 0; i < tr->iv_n; i++) {
+		sum += tr->iv[i];
+		sumsq += (uint32_t)tr->iv[i] * tr->iv[i];
+	}
+
+	uint32_t n = tr->iv_n;
+	uint32_t mean = sum / n;
+	uint64_t var = (sumsq * n - (uint64_t)sum * sum) / ((uint64_t)n * n);
+
+	if (dsp_isqrt64(var) * 100 > mean * RESP_CV_MAX_PCT) {
+		return 0;
+	}
+	return (uint16_t)(600000 / mean);
+}
+
+void resp_engine_result(const struct resp_engine *r, uint32_t now_ms, struct resp_result *out)
+{
+	memset(out, 0, sizeof(*out));
+
+	uint8_t valid = 0;
+
+	for (int i = 0; i < RESP_SERIES; i++) {
+		out->rate_x10[i] = track_rate_x10(&r->s[i], now_ms);
+		if (out->rate_x10[i]) {
+			valid |= 1u << i;
+		}
+	}
+
+	/* Largest subset whose rates agree; smallest spread breaks ties */
+	uint16_t best_spread = UINT16_MAX;
+
+	for (uint8_t m = 1; m < (1u << RESP_SERIES); m++) {
+		if ((m & valid) != m) {
+			continue;
+		}
+
+		uint16_t lo = UINT16_MAX, hi = 0;
+		uint32_t sum = 0;
+		uint8_t n = 0;
+
+		for (int i = 0; i < RESP_SERIES; i++) {
+			if (m & (1u << i)) {
+				lo = (out->rate_x10[i] < lo) ? out->rate_x10[i] : lo;
+				hi = (out->rate_x10[i] > hi) ? out->rate_x10[i] : hi;
+				sum += out->rate_x10[i];
+				n++;
+			}
+		}
+
+		uint16_t spread = hi - lo;
+
+		if (spread > RESP_AGREE_X10) {
+			continue;
+		}
+		if (n > out->quality || (n == out->quality && spread < best_spread)) {
+			out->quality = n;
+			out->used = m;
+			best_spread = spread;
+			out->brpm_x10 = (uint16_t)(sum / n);
+		}
+	}
+
+	if (out->quality < 2) {
+		out->brpm_x10 = 0;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Respiratory rate from the respiratory modulation of the PPG beats:
+ *   RIAV  amplitude of each beat
+ *   RIIV  baseline intensity at each beat
+ *   RIFV  inter-beat interval
+ * Each series is resampled to RESP_FS_HZ, band-passed to the breathing band
+ * and breaths are counted as hysteresis zero crossings. Series whose rates
+ * agree within RESP_AGREE_X10 are averaged ("smart fusion").
+ */
+#define RESP_FS_HZ        4
+#define RESP_BP_STAGES    2
+#define RESP_INTERVALS    8       /* breath intervals kept per series */
+
+enum resp_series {
+	RESP_AM = 0,
+	RESP_BW,
+	RESP_FM,
+	RESP_SERIES,
+};
+
+struct resp_track {
+	struct dsp_biquad_state bp[RESP_BP_STAGES];
+	struct dsp_ema env;           /* |y| envelope for the hysteresis */
+	int32_t  x0;                  /* first value, removed to limit the filter transient */
+	bool     armed;               /* went below -thr since the last crossing */
+	bool     have_cross;
+	uint32_t last_cross_ms;
+	uint16_t iv[RESP_INTERVALS];  /* breath intervals, ms */
+	uint8_t  iv_n;
+	uint8_t  iv_pos;
+};
+
+struct resp_engine {
+	struct resp_track s[RESP_SERIES];
+	bool     have_prev;
+	uint32_t prev_ms;
+	int32_t  prev_v[RESP_SERIES];
+	uint32_t grid_ms;             /* next resampling instant */
+	uint32_t n_grid;              /* samples since restart (filter settle) */
+};
+
+struct resp_result {
+	uint16_t brpm_x10;            /* 0 when not valid */
+	uint8_t  quality;             /* number of agreeing series, 0..3; valid from 2 */
+	uint8_t  used;                /* bitmask of enum resp_series in the estimate */
+	uint16_t rate_x10[RESP_SERIES];   /* per-series estimate, 0 = none */
+};
+
+void resp_engine_init(struct resp_engine *r);
+
+/* One accepted beat: time, band-passed amplitude, baseline, IBI (0 = gap) */
+void resp_engine_beat(struct resp_engine *r, uint32_t t_ms, int32_t amp,
+		      int32_t base, uint16_t ibi_ms);
+
+void resp_engine_result(const struct resp_engine *r, uint32_t now_ms, struct resp_result *out);
@@ -0,0 +1,341 @@
+#pragma once
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+/* Binary records on the REC characteristic (9f7b0002-...), little endian:
+ *   u8 type | u8 len | u32 t_ms | payload[len]
+ * Keep in sync with REC_FORMATS in nrf.py.
+ */
+#define REC_HDR_LEN  6
+
+#define REC_HR       0x01
+#define REC_SPO2     0x02
+#define REC_AGC      0x03
+#define REC_SQI      0x04
+#define REC_IBI      0x05
+#define REC_HRV      0x06
+#define REC_RESP     0x07
+#define REC_SCR      0x08
+#define REC_EDA      0x09
+#define REC_STRESS   0x0A
+#define REC_IMU_EVT  0x0B
+#define REC_CTRL_ACK 0x0C
+#define REC_QUAT     0x0D
+#define REC_TREMOR   0x0E
+#define REC_FALL     0x0F
+#define REC_ALERT_TX 0x10
+#define REC_ACTIVITY 0x11
+#define REC_SLEEP    0x12
+#define REC_WEAR     0x13
+#define REC_PPG_SPOT 0x14
+#define REC_POWER    0x15
+#define REC_TEMP_ALERT 0x16
+#define REC_SLOW     0x17
+#define REC_SUBS     0x18
+
+/* 1 Hz heart-rate estimate */
+struct rec_hr {
+	uint16_t bpm_x10;
+	uint8_t  conf;         /* 0..100 */
+	uint8_t  n_beats;      /* beats accepted in the last period */
+	uint16_t cyc_per_smp;  /* average engine cost */
+	uint16_t anc_cyc;      /* average motion-artifact canceller cost */
+} __packed;
+
+/* SpO2 every few seconds; spo2_x10 == 0 when quality-gated */
+struct rec_spo2 {
+	uint16_t spo2_x10;
+	uint16_t r_x1000;      /* median ratio of ratios */
+	uint8_t  conf;         /* 0..100 */
+	uint8_t  n_beats;
+} __packed;
+
+/* LED AGC decision (see ppg_agc.h) */
+struct rec_agc {
+	uint8_t  led;          /* 0=RED 1=IR 2=GREEN, 0xFF=ADC range */
+	uint8_t  from;
+	uint8_t  to;
+	uint8_t  reason;       /* 1=low 2=high 3=saturated */
+	uint32_t dc;
+} __packed;
+
+/* PPG signal quality, one per channel per SQI window (see ppg_sqi.h) */
+struct rec_sqi {
+	uint8_t  led;          /* 0=RED 1=IR 2=GREEN */
+	uint8_t  score;        /* 0..100, engines gated below SQI_MIN */
+	uint16_t pi_x1e4;
+	uint8_t  periodicity;  /* 0..100 */
+	uint8_t  clip_pct;
+	uint16_t motion_mg;
+} __packed;
+
+/* Inter-beat intervals, oldest first; 0 marks a gap before that beat.
+ * Sized so header + record fit the default 23-byte ATT MTU.
+ */
+#define REC_IBI_MAX  5
+
+struct rec_ibi {
+	uint32_t t_last_ms;    /* time of the newest beat */
+	uint16_t ibi_ms[REC_IBI_MAX];  /* only len / 2 - 2 entries are sent */
+} __packed;
+
+/* HRV summary (see hrv_engine.h); fields are 0 when their domain is not valid */
+struct rec_hrv {
+	uint16_t rmssd_x10;
+	uint16_t sdnn_x10;
+	uint8_t  pnn50;
+	uint8_t  n_ibi;
+	uint16_t lf_ms2;
+	uint16_t hf_ms2;
+	uint16_t lf_hf_x100;
+	uint16_t kcyc;         /* cost of this evaluation, 1000 cycles */
+} __packed;
+
+/* Respiratory rate from PPG modulation (see resp_engine.h) */
+struct rec_resp {
+	uint16_t brpm_x10;     /* 0 unless at least two series agree */
+	uint8_t  quality;      /* agreeing series, 0..3 */
+	uint8_t  used;         /* bit0=amplitude bit1=baseline bit2=interval */
+	uint16_t am_x10;       /* per-series estimates, 0 = none */
+	uint16_t bw_x10;
+	uint16_t fm_x10;
+} __packed;
+
+/* Skin conductance response (see eda_engine.h) */
+struct rec_scr {
+	uint32_t onset_ms;
+	uint16_t rise_ms;
+	uint16_t amp_ns;
+	uint16_t tonic_ns;     /* tonic level at onset, saturates at 65.5 uS */
+} __packed;
+
+/* Periodic EDA summary */
+struct rec_eda {
+	uint16_t tonic_ns;
+	int16_t  phasic_ns;
+	uint8_t  scr_per_min;
+	uint8_t  contact;      /* 0 = flat line / no skin contact */
+} __packed;
+
+/* Stress / arousal index every few seconds (see stress_engine.h) */
+struct rec_stress {
+	uint8_t  score;        /* 0..100 */
+	uint8_t  fresh;        /* bit0=SCR bit1=HRV bit2=HR bit3=temp in the score */
+	uint8_t  scr;          /* per-feature 0..100 */
+	uint8_t  hrv;
+	uint8_t  hr;
+	uint8_t  temp;
+} __packed;
+
+/* LSM6DSO embedded-function / gesture event, sent as it happens */
+#define IMU_EVT_STEPS   0x01   /* step count changed (rate limited) */
+#define IMU_EVT_SIGMOT  0x02   /* significant motion */
+#define IMU_EVT_TILT    0x03
+#define IMU_EVT_TAP     0x04   /* detail = TAP_SRC sign | X | Y | Z bits */
+#define IMU_EVT_DTAP    0x05
+#define IMU_EVT_FSM     0x06   /* detail = FSM number 1..16 (lsm6dso_fsm.h) */
+#define IMU_EVT_RATE    0x07   /* detail = IMU_RATE_*: sample rates changed */
+
+#define IMU_RATE_ACTIVE 0      /* accel 104 Hz (or CTRL_SPECTRAL rate) + gyro 104 Hz */
+#define IMU_RATE_IDLE   1      /* still: accel 26 Hz low-power, gyro off */
+#define IMU_RATE_LOW    2      /* asleep / off wrist: accel 26 Hz, gyro off */
+
+struct rec_imu_evt {
+	uint8_t  evt;
+	uint8_t  detail;
+	uint32_t steps;        /* steps since boot */
+} __packed;
+
+/* Orientation from the accel+gyro fusion (imu_fusion.h), 25 Hz by default.
+ * Unit quaternion Q15 with w >= 0 implied: w = sqrt(1 - x^2 - y^2 - z^2).
+ */
+struct rec_quat {
+	int16_t  qx;
+	int16_t  qy;
+	int16_t  qz;
+	int16_t  lin_x;        /* mg, gravity removed */
+	int16_t  lin_y;
+	int16_t  lin_z;
+	uint16_t age_ms;       /* sample time = header t_ms - age_ms */
+} __packed;
+
+/* Motion spectrum every 2.5 s while high-ODR capture runs (spectral_engine.h) */
+struct rec_tremor {
+	uint16_t move_x10;     /* band RMS mg x10: 0.5..3 Hz */
+	uint16_t tremor_x10;   /* 3..12 Hz */
+	uint16_t high_x10;     /* 12..25 Hz */
+	uint16_t dom_hz_x10;   /* tremor-band peak */
+	uint8_t  entropy;      /* 0..100 */
+	uint8_t  tremor_pct;
+	uint8_t  n_win;        /* FFT windows averaged */
+	uint16_t kcyc;         /* average cost per window (3 axes) */
+} __packed;
+
+/* Fall detected (fall_engine.h), sent on the alert path (alert_task.h) */
+#define FALL_FLAG_FREEFALL  0x01   /* free fall seen before the impact */
+#define FALL_FLAG_HARD      0x02   /* impact above the hard threshold */
+
+struct rec_fall {
+	uint8_t  seq;
+	uint8_t  flags;        /* FALL_FLAG_* */
+	uint16_t peak_mg;
+	uint16_t freefall_ms;
+	int8_t   cos_x100;     /* gravity before vs. after the impact */
+	uint16_t impact_age_ms;/* impact time = header t_ms - impact_age_ms */
+} __packed;
+
+/* Delivery report for the last alert, on the normal record path */
+struct rec_alert_tx {
+	uint8_t  type;         /* REC_* of the alert */
+	uint8_t  tries;        /* ble_alert_send() calls until queued */
+	uint16_t queue_ms;     /* raise -> accepted by the stack */
+	uint16_t tx_ms;        /* raise -> sent by the controller, 0xFFFF = unknown */
+} __packed;
+
+/* Activity class every window (activity_task.h) */
+struct rec_activity {
+	uint8_t  cls;          /* enum act_class: walk, run, cycle, sit, sleep */
+	uint8_t  conf;         /* softmax probability, % */
+	uint8_t  model;        /* act_model.id */
+	uint16_t infer_cyc;    /* features + quantise + MLP + softmax */
+	uint16_t arena_b;      /* inference RAM */
+	uint16_t flash_b;      /* weights, biases and descriptor */
+} __packed;
+
+/* Sleep epoch every 30 s (sleep_task.h); the same epochs go to NAND */
+struct rec_sleep {
+	uint8_t  flags;        /* SLEEP_REC_* (sleep_store.h): stage | asleep | onset | wake */
+	uint16_t n;            /* epochs since onset */
+	uint16_t score;        /* weighted activity count */
+	uint16_t hr_x10;       /* epoch mean, 0 = no HR */
+	uint16_t hr_sd_x10;
+	uint16_t rmssd_x10;    /* 0 = no HRV */
+	uint16_t night;
+} __packed;
+
+/* Worn / off wrist (offwrist_task.h): on every change, then every minute */
+struct rec_wear {
+	uint8_t  worn;
+	uint8_t  votes;        /* off-wrist votes at the last evaluation */
+	int8_t   prox;         /* enum ow_cue: -1 unknown, 0 no reflection, 1 reflection */
+	int8_t   eda;          /* enum ow_cue: electrode contact */
+	int16_t  temp_c10;     /* skin temperature, INT16_MIN = unknown */
+	uint16_t still_s;      /* time since the last wrist motion */
+} __packed;
+
+/* End of a PPG measurement session (ppg_sched.h) */
+struct rec_ppg_spot {
+	uint8_t  trig;         /* enum ppg_sched_trig: 1 periodic, 2 demand */
+	uint8_t  spo2;         /* RED+IR were lit */
+	uint16_t len_s;
+	uint16_t hr_x10;       /* last valid HR of the session, 0 = none */
+	uint16_t spo2_x10;     /* last valid SpO2, 0 = none */
+	uint16_t duty_pm;      /* LEDs lit, per mille of uptime */
+} __packed;
+
+/* CPU wakeups and duty cycle every 10 s (acq_batch.h) */
+struct rec_power {
+	uint16_t wake_x10;     /* returns from idle per second */
+	uint16_t duty_x100;    /* % of time not idle */
+	uint16_t batch_ms;
+	uint16_t win_s;
+} __packed;
+
+/* AS6221 ALERT: skin temperature crossed a threshold (as6221_task.h) */
+#define TEMP_ALERT_CLEAR 0     /* back below low_c10 */
+#define TEMP_ALERT_HIGH  1     /* above high_c10 */
+
+struct rec_temp_alert {
+	uint8_t  evt;
+	int16_t  temp_c10;
+	int16_t  thresh_c10;   /* the threshold crossed */
+} __packed;
+
+/* Send-on-delta sample of a slow channel (slow_report.h). Hold each value
+ * until the channel's next record: the signal stayed within delta of it.
+ * A seq gap is lost data.
+ */
+#define SLOW_CH_TEMP     0     /* skin temperature, mC */
+#define SLOW_CH_EDA      1     /* EDA electrode voltage, uV */
+#define SLOW_CH_COUNT    2
+
+#define SLOW_DELTA       0     /* moved more than delta */
+#define SLOW_HEARTBEAT   1     /* no such move for the heartbeat interval */
+
+struct rec_slow {
+	uint8_t  ch;
+	uint8_t  kind;
+	uint8_t  seq;          /* per channel */
+	uint16_t delta;
+	int32_t  value;
+} __packed;
+
+/* Channels consumers subscribe to (chan_sub.h), with what they carry */
+#define CHAN_LOG         0     /* text log characteristic */
+#define CHAN_HR          1     /* REC_HR */
+#define CHAN_SPO2        2     /* REC_SPO2, REC_PPG_SPOT */
+#define CHAN_HRV         3     /* REC_HRV, REC_IBI */
+#define CHAN_RESP        4     /* REC_RESP */
+#define CHAN_PPG_DIAG    5     /* REC_AGC, REC_SQI */
+#define CHAN_EDA         6     /* REC_SCR, REC_EDA, REC_SLOW eda */
+#define CHAN_TEMP        7     /* REC_SLOW temp, REC_TEMP_ALERT */
+#define CHAN_IMU_EVT     8     /* REC_IMU_EVT */
+#define CHAN_QUAT        9     /* REC_QUAT */
+#define CHAN_TREMOR      10    /* REC_TREMOR */
+#define CHAN_FALL        11    /* REC_FALL */
+#define CHAN_ACTIVITY    12    /* REC_ACTIVITY */
+#define CHAN_STRESS      13    /* REC_STRESS */
+#define CHAN_SLEEP       14    /* REC_SLEEP, sleep epochs in NAND */
+#define CHAN_WEAR        15    /* REC_WEAR, off-wrist power saving */
+#define CHAN_POWER       16    /* REC_POWER */
+#define CHAN_COUNT       17
+#define CHAN_ALL         0xFF  /* CTRL_SUBSCRIBE: every channel */
+
+#define SUB_BLE          0     /* the connected central */
+#define SUB_NAND         1     /* flash recorder (sleep_store.h) */
+#define SUB_ALGO         2     /* on-device functions: fall alert, wear detection */
+#define SUB_COUNT        3
+
+#define CHAN_SENS_PPG    0x01
+#define CHAN_SENS_IMU    0x02
+#define CHAN_SENS_EDA    0x04
+#define CHAN_SENS_TEMP   0x08
+
+/* Active subscription set, on every change and on CTRL_SUBS_QUERY: one
+ * record per SUB_*, to stay within a 20-byte notification
+ */
+struct rec_subs {
+	uint8_t  sub;          /* SUB_* */
+	uint8_t  sensors;      /* CHAN_SENS_* powered */
+	uint32_t wanted;       /* BIT(CHAN_*) computed, subscribed or an input of one */
+	uint32_t chans;        /* BIT(CHAN_*) subscribed by this SUB_* */
+} __packed;
+
+/* Control writes on the CTRL characteristic (9f7b0003-...), little endian:
+ *   u8 op | args
+ * Long operations answer with a REC_CTRL_ACK record.
+ */
+#define CTRL_FSM_BEGIN   0x10   /* u16 n_ops */
+#define CTRL_FSM_DATA    0x11   /* u16 first op index | (u8 reg, u8 val)[] */
+#define CTRL_FSM_COMMIT  0x12   /* u16 crc16-ccitt (0xFFFF seed) of all pairs */
+#define CTRL_FSM_CLEAR   0x13
+#define CTRL_FUSION_RATE 0x20   /* u8 REC_QUAT rate in Hz, 0 = off */
+#define CTRL_SPECTRAL    0x21   /* u8 SPEC_MODE_*: accel capture rate for REC_TREMOR */
+#define CTRL_PPG_SCHED   0x22   /* u8 mode | u8 flags | u16 period_s | u16 len_s | u16 quiet_wait_s */
+#define CTRL_PPG_MEASURE 0x23   /* u16 seconds: on-demand HR + SpO2 session */
+#define CTRL_TEMP_CFG    0x24   /* u16 interval_s | i16 low_c10 | i16 high_c10 */
+#define CTRL_SLOW_CFG    0x25   /* u8 SLOW_CH_* | u16 delta | u16 heartbeat_s */
+#define CTRL_SUBSCRIBE   0x26   /* u8 CHAN_* or CHAN_ALL | u8 on | u16 period_ms (0 = default)
+				 * [| u8 SUB_*, default SUB_BLE] */
+#define CTRL_SUBS_QUERY  0x27   /* answered with a REC_SUBS per SUB_* */
+
+#define SPEC_MODE_OFF    0
+#define SPEC_MODE_416HZ  1
+#define SPEC_MODE_833HZ  2
+#define SPEC_MODE_1666HZ 3
+
+struct rec_ctrl_ack {
+	uint8_t  op;
+	int8_t   err;          /* 0 or -errno */
+	uint16_t arg;          /* op specific (FSM: ops now active) */
+} __packed;
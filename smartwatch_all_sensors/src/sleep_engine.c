@@ -0,0 +1,116 @@
+#include <string.h>
+
+#include "sleep_engine.h"
+
+#define SLEEP_BASE_SH  5        /* ~16 min baselines */
+
+/* Cole-Kripke weights, current epoch first (future terms dropped) */
+static const uint16_t ck_w[SLEEP_HIST] = { 230, 76, 58, 54, 106 };
+#define CK_W_SUM       524
+
+void sleep_engine_init(struct sleep_engine *s, const struct sleep_cfg *cfg)
+{
+	memset(s, 0, sizeof(*s));
+	s->cfg = *cfg;
+	s->hr_base = (struct dsp_ema)DSP_EMA_INIT(SLEEP_BASE_SH);
+	s->sd_base = (struct dsp_ema)DSP_EMA_INIT(SLEEP_BASE_SH);
+	s->rmssd_base = (struct dsp_ema)DSP_EMA_INIT(SLEEP_BASE_SH);
+}
+
+static uint16_t ck_score(const struct sleep_engine *s)
+{
+	uint32_t sum = 0;
+
+	for (int i = 0; i < SLEEP_HIST; i++) {
+		sum += (uint32_t)ck_w[i] * s->act[i];
+	}
+	sum /= CK_W_SUM;
+	return (uint16_t)((sum > UINT16_MAX) ? UINT16_MAX : sum);
+}
+
+static uint8_t stage(struct sleep_engine *s, const struct sleep_epoch_in *in)
+{
+	const struct sleep_cfg *c = &s->cfg;
+
+	if (in->hr_x10 == 0) {
+		return SLEEP_STAGE_LIGHT;
+	}
+
+	/* baselines of this night, compared before they take the new epoch */
+	bool first = !s->hr_base.init;
+	uint32_t hr_b = (uint32_t)dsp_ema_get(&s->hr_base);
+	uint32_t sd_b = (uint32_t)dsp_ema_get(&s->sd_base);
+	uint32_t rm_b = s->rmssd_base.init ? (uint32_t)dsp_ema_get(&s->rmssd_base) :
+					     in->rmssd_x10;
+
+	(void)dsp_ema_step(&s->hr_base, in->hr_x10);
+	(void)dsp_ema_step(&s->sd_base, in->hr_sd_x10);
+	if (in->rmssd_x10) {
+		(void)dsp_ema_step(&s->rmssd_base, in->rmssd_x10);
+	}
+	if (first) {
+		return SLEEP_STAGE_LIGHT;
+	}
+
+	bool still = in->act <= c->still_count;
+	bool hr_low = (uint32_t)in->hr_x10 * 100 <= hr_b * c->deep_hr_pct;
+	bool sd_high = (uint32_t)in->hr_sd_x10 * 100 >= sd_b * c->rem_sd_pct;
+	bool hrv_up = !in->rmssd_x10 || in->rmssd_x10 >= rm_b;
+
+	if (still && hr_low && !sd_high && hrv_up) {
+		return SLEEP_STAGE_DEEP;
+	}
+	if (still && !hr_low && sd_high && s->n >= c->rem_min_epochs &&
+	    (!in->rmssd_x10 || in->rmssd_x10 <= rm_b)) {
+		return SLEEP_STAGE_REM;
+	}
+	return SLEEP_STAGE_LIGHT;
+}
+
+void sleep_engine_epoch(struct sleep_engine *s, const struct sleep_epoch_in *in,
+			struct sleep_epoch_out *out)
+{
+	const struct sleep_cfg *c = &s->cfg;
+
+	memmove(&s->act[1], &s->act[0], (SLEEP_HIST - 1) * sizeof(s->act[0]));
+	s->act[0] = in->act;
+
+	uint16_t score = ck_score(s);
+	bool wake = score > c->wake_thr;
+
+	memset(out, 0, sizeof(*out));
+	out->score = score;
+
+	if (wake) {
+		s->run_wake = (s->run_wake < UINT8_MAX) ? s->run_wake + 1 : UINT8_MAX;
+		s->run_sleep = 0;
+	} else {
+		s->run_sleep = (s->run_sleep < UINT8_MAX) ? s->run_sleep + 1 : UINT8_MAX;
+		s->run_wake = 0;
+	}
+
+	if (!s->asleep) {
+		if (s->run_sleep >= c->onset_epochs) {
+			s->asleep = true;
+			/* the quiet run counts; this epoch is added below */
+			s->n = s->run_sleep - 1;
+			out->evt = SLEEP_EVT_ONSET;
+			s->hr_base.init = false;
+			s->sd_base.init = false;
+			s->rmssd_base.init = false;
+		}
+	} else if (s->run_wake >= c->wake_epochs) {
+		s->asleep = false;
+		s->n = 0;
+		out->evt = SLEEP_EVT_WAKE;
+	}
+
+	out->asleep = s->asleep;
+	if (s->asleep) {
+		s->n = (s->n < UINT16_MAX) ? s->n + 1 : UINT16_MAX;
+		out->stage = wake ? SLEEP_STAGE_WAKE : stage(s, in);
+	} else {
+		out->stage = SLEEP_STAGE_WAKE;
+	}
+	out->n = s->n;
+}
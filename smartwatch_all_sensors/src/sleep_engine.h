@@ -0,0 +1,84 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Sleep/wake and staging on SLEEP_EPOCH_S epochs.
+ *   sleep/wake  causal Cole-Kripke style: weighted activity count of the
+ *               current and the four previous epochs against wake_thr
+ *   onset       onset_epochs consecutive sleep epochs; the night starts at
+ *               the first of them
+ *   wake        wake_epochs consecutive wake epochs end the night
+ *   staging     while asleep, against slow baselines of the night:
+ *               deep  HR below baseline, steady HR, RMSSD at/above baseline
+ *               REM   HR at/above baseline and irregular, no movement, not
+ *                     in the first rem_min_epochs of the night
+ *               light otherwise (and whenever HR is missing)
+ * Staging from wrist HR/HRV is an estimate, not polysomnography.
+ */
+#define SLEEP_EPOCH_S   30
+#define SLEEP_HIST      5
+
+enum sleep_stage {
+	SLEEP_STAGE_WAKE = 0,
+	SLEEP_STAGE_LIGHT,
+	SLEEP_STAGE_DEEP,
+	SLEEP_STAGE_REM,
+};
+
+enum sleep_evt {
+	SLEEP_EVT_NONE = 0,
+	SLEEP_EVT_ONSET,
+	SLEEP_EVT_WAKE,
+};
+
+struct sleep_cfg {
+	uint16_t wake_thr;          /* weighted activity count */
+	uint8_t  onset_epochs;
+	uint8_t  wake_epochs;
+	uint8_t  deep_hr_pct;       /* HR <= baseline * pct / 100 */
+	uint8_t  rem_sd_pct;        /* HR SD >= its baseline * pct / 100 */
+	uint16_t rem_min_epochs;
+	uint8_t  still_count;       /* activity count of a motionless epoch */
+};
+
+#define SLEEP_CFG_DEFAULT { \
+	.wake_thr = 40, .onset_epochs = 10, .wake_epochs = 4, \
+	.deep_hr_pct = 97, .rem_sd_pct = 130, .rem_min_epochs = 90, \
+	.still_count = 5 }
+
+/* One epoch of inputs; 0 = not available */
+struct sleep_epoch_in {
+	uint16_t act;               /* activity count (sleep_task.c) */
+	uint16_t hr_x10;            /* mean HR */
+	uint16_t hr_sd_x10;         /* HR standard deviation within the epoch */
+	uint16_t rmssd_x10;
+};
+
+struct sleep_epoch_out {
+	uint8_t  stage;             /* enum sleep_stage */
+	uint8_t  evt;               /* enum sleep_evt */
+	bool     asleep;
+	uint16_t n;                 /* epochs since onset (0 while awake) */
+	uint16_t score;             /* weighted activity count */
+};
+
+struct sleep_engine {
+	struct sleep_cfg cfg;
+
+	uint16_t act[SLEEP_HIST];   /* newest first */
+	uint8_t  run_sleep;
+	uint8_t  run_wake;
+	bool     asleep;
+	uint16_t n;
+
+	struct dsp_ema hr_base;     /* x10 bpm */
+	struct dsp_ema sd_base;
+	struct dsp_ema rmssd_base;
+};
+
+void sleep_engine_init(struct sleep_engine *s, const struct sleep_cfg *cfg);
+
+void sleep_engine_epoch(struct sleep_engine *s, const struct sleep_epoch_in *in,
+			struct sleep_epoch_out *out);
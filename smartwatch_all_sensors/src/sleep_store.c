@@ -0,0 +1,143 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+#include "sleep_store.h"
+#include "w25n01_task.h"
+
+LOG_MODULE_REGISTER(sleep_store, LOG_LEVEL_INF);
+
+#define SLEEP_MAGIC      0x31504C53   /* "SLP1" */
+#define SLEEP_PAGE0      (W25N01_BLOCK_SLEEP * W25N01_PAGES_PER_BLOCK)
+#define SLEEP_PAGES      (W25N01_SLEEP_BLOCKS * W25N01_PAGES_PER_BLOCK)
+
+struct sleep_page_hdr {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t t_s;          /* uptime of the first epoch */
+	uint16_t night;
+	uint16_t n;
+	uint16_t crc;          /* CRC-16/CCITT (0xFFFF seed) over the records */
+	uint16_t rsvd;
+} __packed;
+
+#define SLEEP_PER_PAGE   ((W25N01_PAGE_SIZE - sizeof(struct sleep_page_hdr)) / \
+			  sizeof(struct sleep_rec))
+
+static struct {
+	struct sleep_page_hdr h;
+	struct sleep_rec rec[SLEEP_PER_PAGE];
+} page;
+
+BUILD_ASSERT(sizeof(page) <= W25N01_PAGE_SIZE);
+
+static uint32_t head;          /* next page to program, ring relative */
+static uint32_t next_seq;
+static uint16_t last_night;
+static bool scanned;
+
+static bool hdr_read(uint32_t p, struct sleep_page_hdr *h)
+{
+	return w25n01_read_page(SLEEP_PAGE0 + p, 0, h, sizeof(*h)) == 0 &&
+	       h->magic == SLEEP_MAGIC;
+}
+
+/* Pages are programmed in ring order: find the newest block from its first
+ * page, then the newest page inside it.
+ */
+static void scan(void)
+{
+	struct sleep_page_hdr h;
+	uint32_t best = 0, best_seq = 0;
+	bool any = false;
+
+	scanned = true;
+	for (uint32_t b = 0; b < W25N01_SLEEP_BLOCKS; b++) {
+		uint32_t p = b * W25N01_PAGES_PER_BLOCK;
+
+		if (hdr_read(p, &h) && (!any || (int32_t)(h.seq - best_seq) > 0)) {
+			best = p;
+			best_seq = h.seq;
+			last_night = h.night;
+			any = true;
+		}
+	}
+	if (!any) {
+		LOG_INF("Sleep ring empty");
+		return;
+	}
+	for (uint32_t p = best + 1; p < best + W25N01_PAGES_PER_BLOCK; p++) {
+		if (!hdr_read(p, &h) || (int32_t)(h.seq - best_seq) <= 0) {
+			break;
+		}
+		best = p;
+		best_seq = h.seq;
+		last_night = h.night;
+	}
+	head = (best + 1) % SLEEP_PAGES;
+	next_seq = best_seq + 1;
+	LOG_INF("Sleep ring: page %u seq %u night %u", best, best_seq, last_night);
+}
+
+uint16_t sleep_store_night(void)
+{
+	if (!scanned) {
+		scan();
+	}
+	return last_night;
+}
+
+int sleep_store_flush(void)
+{
+	if (page.h.n == 0) {
+		return 0;
+	}
+	if (!scanned) {
+		scan();
+	}
+
+	int ret = 0;
+
+	if (head % W25N01_PAGES_PER_BLOCK == 0) {
+		ret = w25n01_erase_block(W25N01_BLOCK_SLEEP + head / W25N01_PAGES_PER_BLOCK);
+	}
+
+	page.h.magic = SLEEP_MAGIC;
+	page.h.seq = next_seq;
+	page.h.crc = crc16_itu_t(0xFFFF, (const uint8_t *)page.rec,
+				 page.h.n * sizeof(page.rec[0]));
+	if (ret == 0) {
+		ret = w25n01_write_page(SLEEP_PAGE0 + head, &page,
+					sizeof(page.h) + page.h.n * sizeof(page.rec[0]));
+	}
+	if (ret) {
+		LOG_ERR("Sleep page %u write failed (%d), %u epochs lost", head, ret, page.h.n);
+	} else {
+		LOG_INF("Sleep page %u: night %u, %u epochs", head, page.h.night, page.h.n);
+	}
+
+	/* a bad page is skipped, not retried forever */
+	head = (head + 1) % SLEEP_PAGES;
+	next_seq++;
+	last_night = page.h.night;
+	page.h.n = 0;
+	return ret;
+}
+
+int sleep_store_append(const struct sleep_rec *r, uint16_t night)
+{
+	int ret = 0;
+
+	if (page.h.n && page.h.night != night) {
+		ret = sleep_store_flush();
+	}
+	if (page.h.n == 0) {
+		page.h.night = night;
+		page.h.t_s = k_uptime_get_32() / 1000;
+	}
+	page.rec[page.h.n++] = *r;
+	if (page.h.n == SLEEP_PER_PAGE) {
+		ret = sleep_store_flush();
+	}
+	return ret;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+
+/* Sleep epochs in the NAND ring W25N01_BLOCK_SLEEP..+W25N01_SLEEP_BLOCKS.
+ * Records collect in a RAM page and are programmed when the page is full
+ * (~4 h of epochs) or flushed at the end of a night; each page carries a
+ * sequence number, the night it belongs to and a CRC.
+ */
+#define SLEEP_REC_STAGE_MSK  0x03   /* enum sleep_stage */
+#define SLEEP_REC_ASLEEP     0x04
+#define SLEEP_REC_ONSET      0x08
+#define SLEEP_REC_WAKE       0x10
+
+struct sleep_rec {
+	uint8_t flags;         /* SLEEP_REC_* */
+	uint8_t act;           /* weighted activity count, clamped */
+	uint8_t hr_bpm;        /* 0 = no HR */
+	uint8_t rmssd_ms;      /* 0 = no HRV */
+} __packed;
+
+/* Night counter continuing from the ring contents */
+uint16_t sleep_store_night(void);
+
+int sleep_store_append(const struct sleep_rec *r, uint16_t night);
+
+/* Program the partial page now */
+int sleep_store_flush(void);
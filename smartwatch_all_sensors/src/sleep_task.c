@@ -0,0 +1,199 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "acq_batch.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "lsm6dso_task.h"
+#include "max30101_task.h"
+#include "motion_shared.h"
+#include "sensor_records.h"
+#include "sleep_engine.h"
+#include "sleep_store.h"
+#include "sleep_task.h"
+
+LOG_MODULE_REGISTER(sleep, LOG_LEVEL_INF);
+
+#define SLEEP_TICK_MS        1000
+#define SLEEP_ACT_DEADBAND   6        /* mg of motion_shared activity: sensor noise */
+#define SLEEP_HRV_MAX_AGE_MS 60000
+
+static const struct sleep_cfg cfg = SLEEP_CFG_DEFAULT;
+static struct sleep_engine eng;
+static struct k_spinlock lock;
+
+/* HR within the current epoch */
+static uint32_t hr_sum, hr_n;
+static uint64_t hr_sumsq;
+static uint16_t rmssd_x10;
+static uint32_t rmssd_ms;
+
+static const char *const stage_name[] = { "wake", "light", "deep", "REM" };
+
+void sleep_post_hr(uint16_t bpm_x10)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	hr_sum += bpm_x10;
+	hr_sumsq += (uint32_t)bpm_x10 * bpm_x10;
+	hr_n++;
+	k_spin_unlock(&lock, key);
+}
+
+void sleep_post_hrv(uint16_t rmssd)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	rmssd_x10 = rmssd;
+	rmssd_ms = k_uptime_get_32();
+	k_spin_unlock(&lock, key);
+}
+
+/* Epoch inputs from the HR posted since the last call */
+static void epoch_take(struct sleep_epoch_in *in)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (hr_n) {
+		uint64_t var = (hr_sumsq * hr_n - (uint64_t)hr_sum * hr_sum) / ((uint64_t)hr_n * hr_n);
+
+		in->hr_x10 = (uint16_t)(hr_sum / hr_n);
+		in->hr_sd_x10 = (uint16_t)MIN(dsp_isqrt64(var), UINT16_MAX);
+	}
+	if (k_uptime_get_32() - rmssd_ms <= SLEEP_HRV_MAX_AGE_MS) {
+		in->rmssd_x10 = rmssd_x10;
+	}
+	hr_sum = 0;
+	hr_sumsq = 0;
+	hr_n = 0;
+	k_spin_unlock(&lock, key);
+}
+
+/* Asleep: low-rate sampling, and HR/HRV for staging until wake-up */
+static void acquisition_low(bool on)
+{
+	chan_sub_set_mask(SUB_NAND, BIT(CHAN_HR) | BIT(CHAN_HRV), on);
+	lsm6dso_set_low_rate(ACQ_LOW_SLEEP, on);
+	max30101_set_low_rate(ACQ_LOW_SLEEP, on);
+	LOG_INF("Acquisition %s", on ? "low rate (asleep)" : "normal");
+}
+
+static void sleep_thread(void *a, void *b, void *c)
+{
+	ARG_UNUSED(a);
+	ARG_UNUSED(b);
+	ARG_UNUSED(c);
+
+	uint32_t act = 0;
+	uint8_t ticks = 0;
+	uint16_t night = 0;
+	bool low = false;
+
+	while (1) {
+		acq_batch_sleep(SLEEP_TICK_MS / ACQ_BATCH_MS);
+
+		if (!chan_sub_wanted(CHAN_SLEEP)) {
+			if (ticks || low || eng.n) {
+				/* unsubscribed: close the night, start over on return */
+				if (low) {
+					(void)sleep_store_flush();
+					acquisition_low(false);
+					low = false;
+				}
+				sleep_engine_init(&eng, &cfg);
+				ticks = 0;
+				act = 0;
+			}
+			continue;
+		}
+
+		/* activity count: motion above the noise floor, integrated per second */
+		uint32_t m = motion_shared_get();
+
+		act += (m > SLEEP_ACT_DEADBAND) ? m - SLEEP_ACT_DEADBAND : 0;
+		if (++ticks < SLEEP_EPOCH_S) {
+			continue;
+		}
+
+		struct sleep_epoch_in in = { .act = (uint16_t)MIN(act, UINT16_MAX) };
+		struct sleep_epoch_out out;
+
+		ticks = 0;
+		act = 0;
+		epoch_take(&in);
+		sleep_engine_epoch(&eng, &in, &out);
+
+		uint8_t flags = out.stage | (out.asleep ? SLEEP_REC_ASLEEP : 0) |
+				(out.evt == SLEEP_EVT_ONSET ? SLEEP_REC_ONSET : 0) |
+				(out.evt == SLEEP_EVT_WAKE ? SLEEP_REC_WAKE : 0);
+
+		if (out.evt == SLEEP_EVT_ONSET) {
+			night = sleep_store_night() + 1;
+			LOG_INF("Sleep onset, night %u", night);
+			acquisition_low(true);
+			low = true;
+		}
+
+		if (out.asleep || out.evt == SLEEP_EVT_WAKE) {
+			struct sleep_rec r = {
+				.flags = flags,
+				.act = (uint8_t)MIN(out.score, UINT8_MAX),
+				.hr_bpm = (uint8_t)MIN(in.hr_x10 / 10, UINT8_MAX),
+				.rmssd_ms = (uint8_t)MIN(in.rmssd_x10 / 10, UINT8_MAX),
+			};
+			(void)sleep_store_append(&r, night);
+		}
+
+		if (out.evt == SLEEP_EVT_WAKE) {
+			(void)sleep_store_flush();
+			LOG_INF("Woke up, night %u", night);
+			acquisition_low(false);
+			low = false;
+		}
+
+		struct rec_sleep rec = {
+			.flags = flags,
+			.n = out.n,
+			.score = out.score,
+			.hr_x10 = in.hr_x10,
+			.hr_sd_x10 = in.hr_sd_x10,
+			.rmssd_x10 = in.rmssd_x10,
+			.night = night,
+		};
+		(void)ble_rec_send(REC_SLEEP, &rec, sizeof(rec));
+
+		LOG_INF("SLEEP %s%s | n=%u act=%u score=%u hr=%u.%u sd=%u.%u rmssd=%u.%u",
+			out.asleep ? "asleep " : "", stage_name[out.stage], out.n, in.act,
+			out.score, in.hr_x10 / 10, in.hr_x10 % 10, in.hr_sd_x10 / 10,
+			in.hr_sd_x10 % 10, in.rmssd_x10 / 10, in.rmssd_x10 % 10);
+	}
+}
+
+/* thread objects */
+#define SLEEP_STACK_SIZE 1536
+#define SLEEP_PRIORITY   6
+
+K_THREAD_STACK_DEFINE(sleep_stack, SLEEP_STACK_SIZE);
+static struct k_thread sleep_tcb;
+static bool started;
+
+void sleep_task_start(void)
+{
+	if (started) {
+		return;
+	}
+	started = true;
+
+	sleep_engine_init(&eng, &cfg);
+	/* nights are kept in NAND whether or not a central listens; awake,
+	 * onset detection needs the IMU only
+	 */
+	chan_sub_set(SUB_NAND, CHAN_SLEEP, true, 0);
+
+	k_thread_create(&sleep_tcb, sleep_stack, K_THREAD_STACK_SIZEOF(sleep_stack),
+			sleep_thread, NULL, NULL, NULL,
+			SLEEP_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(&sleep_tcb, "sleep_task");
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdint.h>
+
+/* Sleep tracking on SLEEP_EPOCH_S epochs (sleep_engine.h). Nights are kept
+ * in NAND (sleep_store.h) and reported live as REC_SLEEP; while asleep the
+ * IMU and PPG run at their low rates.
+ */
+void sleep_task_start(void);
+
+/* Inputs from the sensor tasks (any thread) */
+void sleep_post_hr(uint16_t bpm_x10);
+void sleep_post_hrv(uint16_t rmssd_x10);
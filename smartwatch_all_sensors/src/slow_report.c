@@ -0,0 +1,112 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "slow_report.h"
+#include "sod_engine.h"
+
+LOG_MODULE_REGISTER(slow_report, LOG_LEVEL_INF);
+
+#define SLOW_SILENCE_MAX_S  3600
+
+struct slow_chan {
+	const char *name;
+	const char *unit;
+	uint8_t chan;
+	struct sod_engine sod;
+	struct sod_cfg cfg_new;
+	bool cfg_pending;
+	uint8_t seq;
+};
+
+/* temp: 0.1 C or 1 min; EDA: more than 1 LSB (125 uV) or 30 s */
+static struct slow_chan chans[SLOW_CH_COUNT] = {
+	[SLOW_CH_TEMP] = {
+		.name = "temp", .unit = "mC", .chan = CHAN_TEMP,
+		.sod = { .cfg = { .delta = 100, .max_silence_ms = 60000 } },
+	},
+	[SLOW_CH_EDA] = {
+		.name = "eda", .unit = "uV", .chan = CHAN_EDA,
+		.sod = { .cfg = { .delta = 125, .max_silence_ms = 30000 } },
+	},
+};
+
+static struct k_spinlock cfg_lock;
+
+static void slow_ctrl(const uint8_t *d, size_t len)
+{
+	if (len < 6 || d[1] >= SLOW_CH_COUNT) {
+		return;
+	}
+
+	struct slow_chan *c = &chans[d[1]];
+	uint16_t silence_s = CLAMP(sys_get_le16(&d[4]), 1, SLOW_SILENCE_MAX_S);
+	k_spinlock_key_t key = k_spin_lock(&cfg_lock);
+
+	c->cfg_new = (struct sod_cfg){
+		.delta = sys_get_le16(&d[2]),
+		.max_silence_ms = (uint32_t)silence_s * 1000,
+	};
+	c->cfg_pending = true;
+	k_spin_unlock(&cfg_lock, key);
+}
+
+static void cfg_take(struct slow_chan *c)
+{
+	k_spinlock_key_t key = k_spin_lock(&cfg_lock);
+	bool take = c->cfg_pending;
+	struct sod_cfg cfg = c->cfg_new;
+
+	c->cfg_pending = false;
+	k_spin_unlock(&cfg_lock, key);
+
+	if (take) {
+		sod_engine_set_cfg(&c->sod, &cfg);
+		LOG_INF("%s: report on %u %s change, heartbeat %u s", c->name, cfg.delta, c->unit,
+			cfg.max_silence_ms / 1000);
+	}
+}
+
+void slow_report_init(void)
+{
+	(void)ble_ctrl_register(CTRL_SLOW_CFG, CTRL_SLOW_CFG, slow_ctrl);
+}
+
+void slow_report_push(uint8_t ch, int32_t v)
+{
+	struct slow_chan *c = &chans[ch];
+
+	cfg_take(c);
+
+	if (!chan_sub_wanted(c->chan)) {
+		/* first value after a resubscribe is reported */
+		sod_engine_restart(&c->sod);
+		return;
+	}
+
+	int kind = sod_engine_push(&c->sod, v, k_uptime_get_32());
+
+	if (kind == SOD_NONE) {
+		return;
+	}
+
+	struct rec_slow rec = {
+		.ch = ch,
+		.kind = (kind == SOD_HEARTBEAT) ? SLOW_HEARTBEAT : SLOW_DELTA,
+		.seq = c->seq++,
+		.delta = (uint16_t)MIN(c->sod.cfg.delta, UINT16_MAX),
+		.value = v,
+	};
+	(void)ble_rec_send(REC_SLOW, &rec, sizeof(rec));
+
+	LOG_INF("%s=%ld %s%s", c->name, (long)v, c->unit,
+		(kind == SOD_HEARTBEAT) ? " (unchanged)" : "");
+}
+
+void slow_report_restart(uint8_t ch)
+{
+	sod_engine_restart(&chans[ch].sod);
+}
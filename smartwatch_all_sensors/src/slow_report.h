@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+
+#include "sensor_records.h"
+
+/* Send-on-delta reporting (sod_engine.h) for the slow channels, SLOW_CH_*
+ * in sensor_records.h: skin temperature in mC and the EDA electrode
+ * voltage in uV. Each report is a REC_SLOW with a per-channel sequence
+ * number, counted whether or not a link was up, so a lost record shows
+ * up as a gap; CTRL_SLOW_CFG changes a channel's deadband and heartbeat
+ * interval.
+ */
+void slow_report_init(void);
+
+/* One sample from the channel's sensor task */
+void slow_report_push(uint8_t ch, int32_t v);
+
+/* The sensor stopped or restarted: the next sample is reported */
+void slow_report_restart(uint8_t ch);
@@ -0,0 +1,39 @@
+#include <string.h>
+
+#include "sod_engine.h"
+
+void sod_engine_init(struct sod_engine *s, const struct sod_cfg *cfg)
+{
+	memset(s, 0, sizeof(*s));
+	s->cfg = *cfg;
+}
+
+void sod_engine_set_cfg(struct sod_engine *s, const struct sod_cfg *cfg)
+{
+	s->cfg = *cfg;
+	s->have = false;
+}
+
+void sod_engine_restart(struct sod_engine *s)
+{
+	s->have = false;
+}
+
+int sod_engine_push(struct sod_engine *s, int32_t v, uint32_t t_ms)
+{
+	int kind;
+	int64_t d = (int64_t)v - s->sent;
+
+	if (!s->have || d > (int64_t)s->cfg.delta || d < -(int64_t)s->cfg.delta) {
+		kind = SOD_DELTA;
+	} else if (t_ms - s->sent_ms >= s->cfg.max_silence_ms) {
+		kind = SOD_HEARTBEAT;
+	} else {
+		return SOD_NONE;
+	}
+
+	s->sent = v;
+	s->sent_ms = t_ms;
+	s->have = true;
+	return kind;
+}
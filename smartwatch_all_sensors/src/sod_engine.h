@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Send-on-delta for one slow channel. A sample is reported when it moves
+ * more than delta away from the last reported value; otherwise a heartbeat
+ * (carrying the current value) once max_silence_ms has passed since the
+ * last report. Between two reports every sample stayed within delta of
+ * the first, so a sample-and-hold of the reports is within delta of the
+ * signal, and a missing heartbeat means missing data, not a flat signal.
+ */
+enum sod_kind {
+	SOD_NONE = 0,
+	SOD_DELTA,
+	SOD_HEARTBEAT,
+};
+
+struct sod_cfg {
+	uint32_t delta;
+	uint32_t max_silence_ms;
+};
+
+struct sod_engine {
+	struct sod_cfg cfg;
+	int32_t  sent;
+	uint32_t sent_ms;
+	bool     have;
+};
+
+void sod_engine_init(struct sod_engine *s, const struct sod_cfg *cfg);
+
+/* New deadband; the next sample is reported */
+void sod_engine_set_cfg(struct sod_engine *s, const struct sod_cfg *cfg);
+
+/* Report the next sample whatever its value (data gap, lost record) */
+void sod_engine_restart(struct sod_engine *s);
+
+/* Returns enum sod_kind; anything but SOD_NONE means report v now */
+int sod_engine_push(struct sod_engine *s, int32_t v, uint32_t t_ms);
@@ -0,0 +1,310 @@
+#include <string.h>
+
+#include "spectral_engine.h"
+
+#define SPEC_M            (SPEC_N / 2)   /* complex FFT length */
+#define SPEC_IN_SHIFT     12             /* headroom: raw << 12 stays below 2^28 */
+#define SPEC_PSD_SHIFT    16
+
+/* (mg x10)^2 per PSD unit, x1e6: 2 |X/N|^2 / mean(w^2) with the 2/N scale
+ * of the FFT, the input shift and PSD shift, and 0.061 mg/LSB at 2 g
+ */
+#define SPEC_MG10SQ_X1E6  1938
+
+#define SPEC_MOVE_X10     5              /* band edges, Hz x10 */
+#define SPEC_TREMOR_X10   30
+#define SPEC_HIGH_X10     120
+#define SPEC_TOP_X10      250
+
+/* sin(2 pi m / SPEC_N), m = 0..SPEC_N/4, Q31 */
+static const int32_t sin_q31[SPEC_N / 4 + 1] = {
+	0, 26352928, 52701887, 79042909, 105372028, 131685278,
+	157978697, 184248325, 210490206, 236700388, 262874923, 289009871,
+	315101295, 341145265, 367137861, 393075166, 418953276, 444768294,
+	470516330, 496193509, 521795963, 547319836, 572761285, 598116479,
+	623381598, 648552838, 673626408, 698598533, 723465451, 748223418,
+	772868706, 797397602, 821806413, 846091463, 870249095, 894275671,
+	918167572, 941921200, 965532978, 988999351, 1012316784, 1035481766,
+	1058490808, 1081340445, 1104027237, 1126547765, 1148898640, 1171076495,
+	1193077991, 1214899813, 1236538675, 1257991320, 1279254516, 1300325060,
+	1321199781, 1341875533, 1362349204, 1382617710, 1402678000, 1422527051,
+	1442161874, 1461579514, 1480777044, 1499751576, 1518500250, 1537020244,
+	1555308768, 1573363068, 1591180426, 1608758157, 1626093616, 1643184191,
+	1660027308, 1676620432, 1692961062, 1709046739, 1724875040, 1740443581,
+	1755750017, 1770792044, 1785567396, 1800073849, 1814309216, 1828271356,
+	1841958164, 1855367581, 1868497586, 1881346202, 1893911494, 1906191570,
+	1918184581, 1929888720, 1941302225, 1952423377, 1963250501, 1973781967,
+	1984016189, 1993951625, 2003586779, 2012920201, 2021950484, 2030676269,
+	2039096241, 2047209133, 2055013723, 2062508835, 2069693342, 2076566160,
+	2083126254, 2089372638, 2095304370, 2100920556, 2106220352, 2111202959,
+	2115867626, 2120213651, 2124240380, 2127947206, 2131333572, 2134398966,
+	2137142927, 2139565043, 2141664948, 2143442326, 2144896910, 2146028480,
+	2146836866, 2147321946, 2147483647,
+};
+
+static int32_t sin_n(uint32_t m)
+{
+	m &= SPEC_N - 1;
+	if (m <= SPEC_N / 4) {
+		return sin_q31[m];
+	}
+	if (m <= SPEC_N / 2) {
+		return sin_q31[SPEC_N / 2 - m];
+	}
+	if (m <= 3 * SPEC_N / 4) {
+		return -sin_q31[m - SPEC_N / 2];
+	}
+	return -sin_q31[SPEC_N - m];
+}
+
+static int32_t cos_n(uint32_t m)
+{
+	return sin_n(m + SPEC_N / 4);
+}
+
+static int32_t mul31(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b) >> 31);
+}
+
+static uint16_t bin_of(uint16_t f_x10, uint16_t fs_hz)
+{
+	/* first bin at or above f */
+	return (uint16_t)(((uint32_t)f_x10 * SPEC_N + fs_hz * 10 - 1) / (fs_hz * 10u));
+}
+
+void spectral_engine_init(struct spectral_engine *s, uint16_t fs_hz)
+{
+	memset(s, 0, sizeof(*s));
+	s->fs_hz = fs_hz;
+	s->k_move = bin_of(SPEC_MOVE_X10, fs_hz);
+	s->k_tremor = bin_of(SPEC_TREMOR_X10, fs_hz);
+	s->k_high = bin_of(SPEC_HIGH_X10, fs_hz);
+	s->k_top = bin_of(SPEC_TOP_X10, fs_hz);
+	if (s->k_top > SPEC_BINS) {
+		s->k_top = SPEC_BINS;
+	}
+	if (s->k_move == 0) {
+		s->k_move = 1;
+	}
+}
+
+/* In-place radix-2 DIT complex FFT of SPEC_M points, output scaled 1/SPEC_M */
+static void cfft(int32_t *d)
+{
+	for (uint32_t i = 1, j = 0; i < SPEC_M; i++) {
+		uint32_t bit = SPEC_M >> 1;
+
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			int32_t tr = d[2 * i], ti = d[2 * i + 1];
+
+			d[2 * i] = d[2 * j];
+			d[2 * i + 1] = d[2 * j + 1];
+			d[2 * j] = tr;
+			d[2 * j + 1] = ti;
+		}
+	}
+
+	for (uint32_t len = 2; len <= SPEC_M; len <<= 1) {
+		uint32_t half = len / 2;
+		uint32_t step = SPEC_N / len;       /* W_len^j = W_N^(j step) */
+
+		for (uint32_t j = 0; j < half; j++) {
+			int32_t wr = cos_n(j * step);
+			int32_t wi = -sin_n(j * step);
+
+			for (uint32_t i = j; i < SPEC_M; i += len) {
+				int32_t *a = &d[2 * i];
+				int32_t *b = &d[2 * (i + half)];
+				int32_t tr = mul31(b[0], wr) - mul31(b[1], wi);
+				int32_t ti = mul31(b[0], wi) + mul31(b[1], wr);
+
+				b[0] = (a[0] - tr) >> 1;
+				b[1] = (a[1] - ti) >> 1;
+				a[0] = (a[0] + tr) >> 1;
+				a[1] = (a[1] + ti) >> 1;
+			}
+		}
+	}
+}
+
+/* One axis: window the ring into work, FFT, add |X_k|^2 to psd */
+static void analyse_axis(struct spectral_engine *s, const int16_t *ring)
+{
+	int32_t *d = s->work;
+	int32_t sum = 0;
+
+	for (uint32_t n = 0; n < SPEC_N; n++) {
+		sum += ring[n];
+	}
+	int32_t mean = sum / SPEC_N;
+
+	/* oldest sample first; pairs packed as z[n] = x[2n] + i x[2n+1] */
+	for (uint32_t n = 0; n < SPEC_N; n++) {
+		int32_t x = (ring[(s->head + n) % SPEC_N] - mean) * (1 << SPEC_IN_SHIFT);
+		/* Hann, Q31; the peak at n = N/2 is 1.0, held at INT32_MAX */
+		int32_t w = dsp_sat32(0x40000000LL - (cos_n(n) >> 1));
+
+		d[n] = mul31(x, w);
+	}
+
+	cfft(d);
+
+	/* Real split: X[k] = (Z[k] + Z*[M-k]) / 2 - i W^k (Z[k] - Z*[M-k]) / 2 */
+	for (uint32_t k = 0; k < SPEC_BINS; k++) {
+		uint32_t k1 = k % SPEC_M, k2 = (SPEC_M - k) % SPEC_M;
+		int32_t zr = d[2 * k1], zi = d[2 * k1 + 1];
+		int32_t cr = d[2 * k2], ci = -d[2 * k2 + 1];
+		int32_t er = (zr + cr) / 2, ei = (zi + ci) / 2;
+		int32_t dr = (zr - cr) / 2, di = (zi - ci) / 2;
+		/* -i W^k, W^k = cos - i sin */
+		int32_t wr = -sin_n(k), wi = -cos_n(k);
+		int64_t xr = (int64_t)er + mul31(dr, wr) - mul31(di, wi);
+		int64_t xi = (int64_t)ei + mul31(dr, wi) + mul31(di, wr);
+
+		s->psd[k] += (uint64_t)(xr * xr + xi * xi) >> SPEC_PSD_SHIFT;
+	}
+}
+
+bool spectral_engine_push(struct spectral_engine *s, const int16_t raw[SPEC_AXES])
+{
+	for (int a = 0; a < SPEC_AXES; a++) {
+		s->ring[a][s->head] = raw[a];
+	}
+	s->head = (s->head + 1) % SPEC_N;
+	if (s->fill < SPEC_N) {
+		s->fill++;
+	}
+	if (++s->since < SPEC_HOP || s->fill < SPEC_N) {
+		return false;
+	}
+	s->since = 0;
+
+	for (int a = 0; a < SPEC_AXES; a++) {
+		analyse_axis(s, s->ring[a]);
+	}
+	if (s->n_win < UINT16_MAX) {
+		s->n_win++;
+	}
+	return true;
+}
+
+/* log2(x) in Q16, x > 0 */
+static uint32_t log2_q16(uint64_t x)
+{
+	uint32_t n = 0;
+
+	while (x >> (n + 1)) {
+		n++;
+	}
+	/* mantissa in [1, 2), Q30 */
+	uint64_t m = (n >= 30) ? (x >> (n - 30)) : (x << (30 - n));
+	uint32_t frac = 0;
+
+	for (int i = 15; i >= 0; i--) {
+		m = (m * m) >> 30;
+		if (m >= (2ULL << 30)) {
+			m >>= 1;
+			frac |= 1u << i;
+		}
+	}
+	return (n << 16) | frac;
+}
+
+static uint16_t band_rms_x10(const struct spectral_engine *s, uint16_t k0, uint16_t k1)
+{
+	uint64_t p = 0;
+
+	for (uint16_t k = k0; k < k1; k++) {
+		p += s->psd[k];
+	}
+	p = p / s->n_win * SPEC_MG10SQ_X1E6 / 1000000;
+
+	uint32_t r = dsp_isqrt64(p);
+
+	return (uint16_t)((r > UINT16_MAX) ? UINT16_MAX : r);
+}
+
+void spectral_engine_result(struct spectral_engine *s, struct spectral_result *out)
+{
+	memset(out, 0, sizeof(*out));
+	if (s->n_win == 0) {
+		return;
+	}
+
+	out->n_win = (uint8_t)((s->n_win > UINT8_MAX) ? UINT8_MAX : s->n_win);
+	out->move_x10 = band_rms_x10(s, s->k_move, s->k_tremor);
+	out->tremor_x10 = band_rms_x10(s, s->k_tremor, s->k_high + 1);
+	out->high_x10 = band_rms_x10(s, s->k_high + 1, s->k_top);
+
+	/* tremor-band peak, refined on the parabola through its neighbours */
+	uint16_t kp = s->k_tremor;
+
+	for (uint16_t k = s->k_tremor; k <= s->k_high; k++) {
+		if (s->psd[k] > s->psd[kp]) {
+			kp = k;
+		}
+	}
+
+	uint64_t top = 0, tot = 0, trem = 0;
+
+	for (uint16_t k = s->k_move; k < s->k_top; k++) {
+		top = (s->psd[k] > top) ? s->psd[k] : top;
+	}
+
+	/* scale to 31 bits for the parabola and the entropy sums */
+	uint32_t sh = 0;
+
+	while ((top >> sh) >= (1u << 31)) {
+		sh++;
+	}
+	if (s->psd[kp] && kp > 0) {
+		int32_t nb[3] = {
+			(int32_t)(s->psd[kp - 1] >> sh),
+			(int32_t)(s->psd[kp] >> sh),
+			(int32_t)(s->psd[kp + 1] >> sh),
+		};
+		int32_t k_q8 = kp * 256 + dsp_parabolic_q8(nb);
+
+		out->dom_hz_x10 = (uint16_t)((k_q8 * s->fs_hz * 10 + SPEC_N * 128) / (SPEC_N * 256));
+	}
+
+	/* H = sum p (log2 P - log2 p_k) / P / log2(bins) */
+	uint64_t hsum = 0;
+	uint32_t bins = s->k_top - s->k_move;
+
+	for (uint16_t k = s->k_move; k < s->k_top; k++) {
+		uint64_t p = s->psd[k] >> sh;
+
+		tot += p;
+		if (k >= s->k_tremor && k <= s->k_high) {
+			trem += p;
+		}
+	}
+	if (tot == 0) {
+		s->n_win = 0;
+		memset(s->psd, 0, sizeof(s->psd));
+		return;
+	}
+
+	uint32_t l_tot = log2_q16(tot);
+
+	for (uint16_t k = s->k_move; k < s->k_top; k++) {
+		uint64_t p = s->psd[k] >> sh;
+
+		if (p) {
+			hsum += p * (l_tot - log2_q16(p));
+		}
+	}
+	uint64_t h_q16 = hsum / tot;
+
+	out->entropy = (bins > 1) ? (uint8_t)((h_q16 * 100) / log2_q16(bins)) : 0;
+	out->tremor_pct = (uint8_t)((trem * 100) / tot);
+
+	s->n_win = 0;
+	memset(s->psd, 0, sizeof(s->psd));
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Motion spectrum from high-ODR accelerometer data. Every SPEC_HOP samples
+ * the last SPEC_N samples of each axis are mean-removed, Hann-windowed and
+ * transformed with an in-place Q31 real FFT (SPEC_N/2-point complex FFT,
+ * 1/2 scaling per stage, plus the real split). Axis power spectra are
+ * summed and averaged over the windows since the last result (Welch).
+ * Bands: movement 0.5..3 Hz, tremor 3..12 Hz, high 12..25 Hz.
+ * Resolution is fs / SPEC_N: 0.81 Hz at 416 Hz, 3.3 Hz at 1666 Hz.
+ */
+#define SPEC_N        512
+#define SPEC_HOP      (SPEC_N / 2)          /* 50 % overlap */
+#define SPEC_BINS     (SPEC_N / 2 + 1)
+#define SPEC_AXES     3
+
+struct spectral_result {
+	uint16_t move_x10;       /* band RMS, mg x10 */
+	uint16_t tremor_x10;
+	uint16_t high_x10;
+	uint16_t dom_hz_x10;     /* tremor-band peak */
+	uint8_t  entropy;        /* 0..100, normalised over 0.5..25 Hz */
+	uint8_t  tremor_pct;     /* tremor share of 0.5..25 Hz power */
+	uint8_t  n_win;
+};
+
+struct spectral_engine {
+	uint16_t fs_hz;
+	uint16_t k_move, k_tremor, k_high, k_top;   /* first bin of each band, last+1 */
+
+	int16_t  ring[SPEC_AXES][SPEC_N];           /* raw LSB */
+	uint16_t head;
+	uint16_t fill;
+	uint16_t since;
+
+	int32_t  work[SPEC_N];                      /* SPEC_N/2 complex, re/im */
+	uint64_t psd[SPEC_BINS];                    /* |X|^2 >> SPEC_PSD_SHIFT, summed */
+	uint16_t n_win;
+};
+
+void spectral_engine_init(struct spectral_engine *s, uint16_t fs_hz);
+
+/* One raw accel sample (2 g full scale). Returns true when a window was
+ * analysed, i.e. this call carried the FFT cost.
+ */
+bool spectral_engine_push(struct spectral_engine *s, const int16_t raw[SPEC_AXES]);
+
+/* Band features over the windows since the previous call, which restarts
+ * the average. n_win == 0 when there was none.
+ */
+void spectral_engine_result(struct spectral_engine *s, struct spectral_result *out);
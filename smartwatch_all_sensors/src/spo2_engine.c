@@ -0,0 +1,129 @@
+#include <string.h>
+
+#include "spo2_engine.h"
+
+#define SPO2_SETTLE_SAMPLES (2 * HR_FS_HZ)
+#define SPO2_WIN_MIN        (300 / HR_TS_MS)    /* 200 bpm */
+#define SPO2_WIN_MAX        (2000 / HR_TS_MS)   /* 30 bpm */
+
+/* Per-beat signal checks (raw 18-bit units) */
+#define SPO2_DC_MIN         20000       /* below: no tissue / ambient only */
+#define SPO2_DC_MAX         250000      /* above: near ADC full scale */
+#define SPO2_PI_MIN_X1E4    5           /* perfusion index 0.05 % */
+#define SPO2_PI_MAX_X1E4    2000        /* 20 %: motion, not pulse */
+#define SPO2_R_MIN_Q16      DSP_Q16(0.3)
+#define SPO2_R_MAX_Q16      DSP_Q16(2.0)
+
+/* Result gating */
+#define SPO2_MIN_BEATS      3
+#define SPO2_MIN_CONF       50
+
+/* AC/DC of the window in raw units; false if unusable */
+static bool chan_window(const struct ppg_acdc *c, int32_t *ac, int32_t *dc)
+{
+	if (!ppg_acdc_get(c, ac, dc) ||
+	    *dc < SPO2_DC_MIN || *dc > SPO2_DC_MAX || *ac <= 0) {
+		return false;
+	}
+
+	uint32_t pi = ppg_pi_x1e4(*ac, *dc);
+
+	return pi >= SPO2_PI_MIN_X1E4 && pi <= SPO2_PI_MAX_X1E4;
+}
+
+void spo2_engine_init(struct spo2_engine *s, const struct spo2_cal *cal)
+{
+	memset(s, 0, sizeof(*s));
+	s->cal = *cal;
+	ppg_acdc_reset_window(&s->red);
+	ppg_acdc_reset_window(&s->ir);
+}
+
+void spo2_engine_set_cal(struct spo2_engine *s, const struct spo2_cal *cal)
+{
+	s->cal = *cal;
+}
+
+void spo2_engine_push(struct spo2_engine *s, uint32_t red, uint32_t ir)
+{
+	ppg_acdc_push(&s->red, red);
+	ppg_acdc_push(&s->ir, ir);
+	s->n_samples++;
+}
+
+void spo2_engine_discard(struct spo2_engine *s)
+{
+	ppg_acdc_reset_window(&s->red);
+	ppg_acdc_reset_window(&s->ir);
+}
+
+void spo2_engine_beat(struct spo2_engine *s)
+{
+	int32_t ac_r, dc_r, ac_ir, dc_ir;
+	bool ok = s->n_samples >= SPO2_SETTLE_SAMPLES &&
+		  s->red.n >= SPO2_WIN_MIN && s->red.n <= SPO2_WIN_MAX &&
+		  chan_window(&s->red, &ac_r, &dc_r) &&
+		  chan_window(&s->ir, &ac_ir, &dc_ir);
+
+	if (ok) {
+		/* R = (AC_red / DC_red) / (AC_ir / DC_ir) */
+		int64_t r = (((int64_t)ac_r * dc_ir) << 16) / ((int64_t)dc_r * ac_ir);
+
+		ok = r >= SPO2_R_MIN_Q16 && r <= SPO2_R_MAX_Q16;
+		if (ok && s->n_r < SPO2_MAX_BEATS) {
+			s->r_q16[s->n_r++] = (int32_t)r;
+		}
+	}
+
+	if (!ok && s->n_samples >= SPO2_SETTLE_SAMPLES && s->n_rej < UINT8_MAX) {
+		s->n_rej++;
+	}
+
+	spo2_engine_discard(s);
+}
+
+static void sort_i32(int32_t *v, uint8_t n)
+{
+	for (uint8_t i = 1; i < n; i++) {
+		int32_t x = v[i];
+		int j = i - 1;
+
+		while (j >= 0 && v[j] > x) {
+			v[j + 1] = v[j];
+			j--;
+		}
+		v[j + 1] = x;
+	}
+}
+
+void spo2_engine_result(struct spo2_engine *s, struct spo2_result *out)
+{
+	memset(out, 0, sizeof(*out));
+	out->n_beats = s->n_r;
+
+	if (s->n_r >= SPO2_MIN_BEATS) {
+		sort_i32(s->r_q16, s->n_r);
+
+		int32_t r = s->r_q16[s->n_r / 2];
+		int32_t iqr = s->r_q16[(3 * s->n_r) / 4] - s->r_q16[s->n_r / 4];
+		uint32_t spread = (uint32_t)(((int64_t)iqr * 100) / r);
+		uint32_t ratio = (100u * s->n_r) / (s->n_r + s->n_rej);
+
+		spread = (spread * 2 > 100) ? 100 : spread * 2;
+		out->conf = (uint8_t)(ratio * (100 - spread) / 100);
+		out->r_x1000 = (uint16_t)(((int64_t)r * 1000 + 0x8000) >> 16);
+
+		if (out->conf >= SPO2_MIN_CONF) {
+			int64_t r2 = ((int64_t)r * r) >> 16;
+			int64_t spo2 = (int64_t)s->cal.a_q16 +
+				       (((int64_t)s->cal.b_q16 * r) >> 16) +
+				       (((int64_t)s->cal.c_q16 * r2) >> 16);
+			int64_t x10 = (spo2 * 10 + 0x8000) >> 16;
+
+			out->spo2_x10 = (uint16_t)(x10 < 0 ? 0 : (x10 > 1000 ? 1000 : x10));
+		}
+	}
+
+	s->n_r = 0;
+	s->n_rej = 0;
+}
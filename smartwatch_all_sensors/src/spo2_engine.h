@@ -0,0 +1,55 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+#include "hr_engine.h"
+#include "ppg_common.h"
+
+/* Ratio-of-ratios SpO2 from the RED/IR slots, one R value per beat window
+ * (windows are delimited by the beats hr_engine finds on GREEN).
+ */
+#define SPO2_MAX_BEATS   16
+
+/* SpO2[%] = a + b*R + c*R^2, coefficients in Q16 */
+struct spo2_cal {
+	int32_t a_q16;
+	int32_t b_q16;
+	int32_t c_q16;
+};
+
+/* Generic empirical curve (110 - 25 R); replace with a per-device fit */
+#define SPO2_CAL_DEFAULT { DSP_Q16(110.0), DSP_Q16(-25.0), DSP_Q16(0.0) }
+
+struct spo2_result {
+	uint16_t spo2_x10;  /* 0 when gated */
+	uint16_t r_x1000;   /* median ratio of ratios */
+	uint8_t  conf;      /* 0..100 */
+	uint8_t  n_beats;   /* beats that passed the per-beat checks */
+};
+
+struct spo2_engine {
+	struct spo2_cal cal;
+	struct ppg_acdc red;
+	struct ppg_acdc ir;
+	uint32_t n_samples;
+
+	int32_t  r_q16[SPO2_MAX_BEATS];
+	uint8_t  n_r;
+	uint8_t  n_rej;
+};
+
+void spo2_engine_init(struct spo2_engine *s, const struct spo2_cal *cal);
+void spo2_engine_set_cal(struct spo2_engine *s, const struct spo2_cal *cal);
+
+/* Feed one RED/IR frame (raw 18-bit) */
+void spo2_engine_push(struct spo2_engine *s, uint32_t red, uint32_t ir);
+
+/* Close the current beat window (call on every accepted beat) */
+void spo2_engine_beat(struct spo2_engine *s);
+
+/* Drop the current window without counting it (LED/range just changed) */
+void spo2_engine_discard(struct spo2_engine *s);
+
+/* Snapshot the estimate over the beats since the previous call */
+void spo2_engine_result(struct spo2_engine *s, struct spo2_result *out);
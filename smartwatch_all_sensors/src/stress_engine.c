@@ -0,0 +1,185 @@
+#include <string.h>
+
+#include "stress_engine.h"
+
+#define STRESS_SCR_SHIFT     4      /* ~16 evals */
+#define STRESS_RMSSD_SHIFT   5      /* ~16 min at 30 s summaries */
+#define STRESS_HR_FAST_SHIFT 3      /* ~8 s at 1 Hz */
+#define STRESS_HR_BASE_SHIFT 9      /* ~8.5 min at 1 Hz */
+#define STRESS_T_FAST_SHIFT  4      /* 16 s at 1 Hz */
+#define STRESS_T_SLOW_SHIFT  7      /* 128 s at 1 Hz */
+#define STRESS_T_LAG_S       ((1 << STRESS_T_SLOW_SHIFT) - (1 << STRESS_T_FAST_SHIFT))
+#define STRESS_SCORE_SHIFT   2
+
+/* Max age of the last input before the feature drops out of the score */
+static const uint32_t stress_stale_ms[STRESS_FEATS] = {
+	[STRESS_SCR] = 30000,       /* EDA contact summary every 10 s */
+	[STRESS_HRV] = 90000,       /* HRV summary every 30 s */
+	[STRESS_HR] = 5000,
+	[STRESS_TEMP] = 5000,       /* or two reading intervals, if longer */
+};
+
+void stress_engine_init(struct stress_engine *s, const struct stress_model *m)
+{
+	memset(s, 0, sizeof(*s));
+	s->model = *m;
+	s->scr_rate = (struct dsp_ema)DSP_EMA_INIT(STRESS_SCR_SHIFT);
+	s->rmssd_base = (struct dsp_ema)DSP_EMA_INIT(STRESS_RMSSD_SHIFT);
+	s->hr_fast = (struct dsp_ema)DSP_EMA_INIT(STRESS_HR_FAST_SHIFT);
+	s->hr_base = (struct dsp_ema)DSP_EMA_INIT(STRESS_HR_BASE_SHIFT);
+	s->temp_fast = (struct dsp_ema)DSP_EMA_INIT(STRESS_T_FAST_SHIFT);
+	s->temp_slow = (struct dsp_ema)DSP_EMA_INIT(STRESS_T_SLOW_SHIFT);
+	s->score = (struct dsp_ema)DSP_EMA_INIT(STRESS_SCORE_SHIFT);
+}
+
+static void touch(struct stress_engine *s, enum stress_feat f, uint32_t now_ms)
+{
+	s->seen |= 1u << f;
+	s->last_ms[f] = now_ms;
+}
+
+void stress_engine_eda(struct stress_engine *s, bool contact, uint32_t now_ms)
+{
+	if (contact) {
+		touch(s, STRESS_SCR, now_ms);
+	}
+}
+
+void stress_engine_scr(struct stress_engine *s)
+{
+	if (s->scr_count < UINT16_MAX) {
+		s->scr_count++;
+	}
+}
+
+void stress_engine_hrv(struct stress_engine *s, uint16_t rmssd_x10, uint32_t now_ms)
+{
+	touch(s, STRESS_HRV, now_ms);
+	s->rmssd_x10 = rmssd_x10;
+	dsp_ema_step(&s->rmssd_base, rmssd_x10);
+}
+
+void stress_engine_hr(struct stress_engine *s, uint16_t bpm_x10, uint32_t now_ms)
+{
+	touch(s, STRESS_HR, now_ms);
+	dsp_ema_step(&s->hr_fast, bpm_x10);
+	dsp_ema_step(&s->hr_base, bpm_x10);
+}
+
+/* (1 - 2^-shift)^n in Q30, by squaring */
+static int32_t decay_pow_q30(uint8_t shift, uint32_t n)
+{
+	int32_t a = (1 << 30) - (1 << (30 - shift));
+	int32_t p = 1 << 30;
+
+	for (; n && p; n >>= 1) {
+		if (n & 1) {
+			p = dsp_mul_q30(p, a);
+		}
+		a = dsp_mul_q30(a, a);
+	}
+	return p;
+}
+
+/* n EMA steps along the ramp x0 -> x1 (x1 reached at step n), closed form:
+ * on a ramp of slope d the EMA settles at x - d (2^shift - 1), and the
+ * distance from there decays by (1 - 2^-shift) per step.
+ */
+static void ema_ramp(struct dsp_ema *e, int32_t x0, int32_t x1, uint32_t n)
+{
+	if (!e->init) {
+		dsp_ema_step(e, x1);
+		return;
+	}
+
+	int64_t lag = (((int64_t)(x1 - x0) * ((1 << e->shift) - 1)) << e->shift) / n;
+	int64_t off = e->acc - (((int64_t)x0 << e->shift) - lag);
+
+	e->acc = ((int64_t)x1 << e->shift) - lag +
+		 ((off * decay_pow_q30(e->shift, n) + (1 << 29)) >> 30);
+}
+
+void stress_engine_temp(struct stress_engine *s, int32_t mc, uint32_t now_ms)
+{
+	/* one EMA step per second, interpolated from the previous reading, so
+	 * the time constants hold at any AS6221 interval (one interval late)
+	 */
+	uint32_t n = 1;
+	int32_t prev = mc;
+
+	if (s->seen & (1u << STRESS_TEMP)) {
+		s->temp_dt_ms = now_ms - s->last_ms[STRESS_TEMP];
+		n = (s->temp_dt_ms + 500) / 1000;
+		n = (n < 1) ? 1 : n;
+		prev = s->temp_mc;
+	}
+	touch(s, STRESS_TEMP, now_ms);
+	s->temp_mc = mc;
+
+	ema_ramp(&s->temp_fast, prev, mc, n);
+	ema_ramp(&s->temp_slow, prev, mc, n);
+}
+
+static uint8_t scale100(int32_t v, int32_t fs)
+{
+	if (v <= 0 || fs <= 0) {
+		return 0;
+	}
+	return (uint8_t)((v >= fs) ? 100 : (v * 100) / fs);
+}
+
+void stress_engine_eval(struct stress_engine *s, uint32_t now_ms, uint32_t dt_ms,
+			struct stress_result *out)
+{
+	const struct stress_model *m = &s->model;
+
+	memset(out, 0, sizeof(*out));
+
+	/* SCR/min over this interval, smoothed */
+	if (dt_ms) {
+		dsp_ema_step(&s->scr_rate, (int32_t)((s->scr_count * 6000000u) / dt_ms));
+	}
+	s->scr_count = 0;
+
+	out->feat[STRESS_SCR] = scale100(dsp_ema_get(&s->scr_rate), m->scr_fs_x100);
+
+	int32_t base = dsp_ema_get(&s->rmssd_base);
+
+	if (base > 0) {
+		out->feat[STRESS_HRV] = scale100(((base - s->rmssd_x10) * 100) / base,
+						 m->hrv_drop_fs_pct);
+	}
+
+	out->feat[STRESS_HR] = scale100(dsp_ema_get(&s->hr_fast) - dsp_ema_get(&s->hr_base),
+					m->hr_rise_fs_x10);
+
+	/* EMA difference ~ slope * lag; falling skin temperature = arousal */
+	int32_t fall_mc_min = ((dsp_ema_get(&s->temp_slow) - dsp_ema_get(&s->temp_fast)) * 60) /
+			      STRESS_T_LAG_S;
+
+	out->feat[STRESS_TEMP] = scale100(fall_mc_min, m->temp_fall_fs_mc_min);
+
+	uint32_t acc = 0, wsum = 0;
+
+	for (int f = 0; f < STRESS_FEATS; f++) {
+		uint32_t stale = stress_stale_ms[f];
+
+		if (f == STRESS_TEMP && 2 * s->temp_dt_ms > stale) {
+			stale = 2 * s->temp_dt_ms;
+		}
+
+		bool fresh = (s->seen & (1u << f)) && (now_ms - s->last_ms[f]) <= stale;
+
+		if (fresh) {
+			out->fresh |= 1u << f;
+			acc += (uint32_t)m->weight[f] * out->feat[f];
+			wsum += m->weight[f];
+		}
+	}
+
+	if (wsum) {
+		out->score = (uint8_t)dsp_ema_step(&s->score, (int32_t)(acc / wsum));
+	} else {
+		out->score = (uint8_t)dsp_ema_get(&s->score);
+	}
+}
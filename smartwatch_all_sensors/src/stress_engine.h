@@ -0,0 +1,78 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_fixed.h"
+
+/* Stress / arousal index from incrementally updated features:
+ *   SCR rate       EMA of skin conductance responses per minute
+ *   HRV            RMSSD drop against its own slow baseline
+ *   HR             rise against its own slow baseline
+ *   skin temp      falling trend (fast EMA - slow EMA, vasoconstriction)
+ * Each feature maps to 0..100 and the score is their weighted mean over
+ * the features that are fresh. No raw samples are kept.
+ */
+enum stress_feat {
+	STRESS_SCR = 0,
+	STRESS_HRV,
+	STRESS_HR,
+	STRESS_TEMP,
+	STRESS_FEATS,
+};
+
+/* Linear model: feature weights (sum 100) and full-scale points */
+struct stress_model {
+	uint8_t  weight[STRESS_FEATS];
+	uint16_t scr_fs_x100;         /* SCR/min for 100 */
+	uint8_t  hrv_drop_fs_pct;     /* RMSSD drop below baseline for 100 */
+	uint16_t hr_rise_fs_x10;      /* bpm above baseline for 100 */
+	uint16_t temp_fall_fs_mc_min; /* mC/min fall for 100 */
+};
+
+#define STRESS_MODEL_DEFAULT {                                     \
+	.weight = { [STRESS_SCR] = 35, [STRESS_HRV] = 30,          \
+		    [STRESS_HR] = 15, [STRESS_TEMP] = 20 },         \
+	.scr_fs_x100 = 600, .hrv_drop_fs_pct = 50,                 \
+	.hr_rise_fs_x10 = 200, .temp_fall_fs_mc_min = 300,         \
+}
+
+struct stress_result {
+	uint8_t score;                /* 0..100, smoothed */
+	uint8_t feat[STRESS_FEATS];   /* per-feature 0..100 */
+	uint8_t fresh;                /* bitmask of features in the score */
+};
+
+struct stress_engine {
+	struct stress_model model;
+
+	uint16_t scr_count;           /* since the last eval */
+	struct dsp_ema scr_rate;      /* SCR/min x100 */
+
+	struct dsp_ema rmssd_base;    /* x10 ms */
+	uint16_t rmssd_x10;
+
+	struct dsp_ema hr_fast;       /* x10 bpm */
+	struct dsp_ema hr_base;
+
+	struct dsp_ema temp_fast;     /* mC, one step per second */
+	struct dsp_ema temp_slow;
+	int32_t  temp_mc;             /* last reading */
+	uint32_t temp_dt_ms;          /* between the last two readings */
+
+	struct dsp_ema score;
+	uint32_t last_ms[STRESS_FEATS];
+	uint8_t  seen;
+};
+
+void stress_engine_init(struct stress_engine *s, const struct stress_model *m);
+
+/* EDA engine alive; the SCR feature only counts while there is skin contact */
+void stress_engine_eda(struct stress_engine *s, bool contact, uint32_t now_ms);
+void stress_engine_scr(struct stress_engine *s);
+void stress_engine_hrv(struct stress_engine *s, uint16_t rmssd_x10, uint32_t now_ms);
+void stress_engine_hr(struct stress_engine *s, uint16_t bpm_x10, uint32_t now_ms);
+void stress_engine_temp(struct stress_engine *s, int32_t mc, uint32_t now_ms);
+
+/* Update the score; call every STRESS_EVAL_MS */
+void stress_engine_eval(struct stress_engine *s, uint32_t now_ms, uint32_t dt_ms,
+			struct stress_result *out);
@@ -0,0 +1,119 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "acq_batch.h"
+#include "ble_log_service.h"
+#include "chan_sub.h"
+#include "sensor_records.h"
+#include "stress_engine.h"
+#include "stress_task.h"
+
+LOG_MODULE_REGISTER(stress, LOG_LEVEL_INF);
+
+#define STRESS_EVAL_MS  5000
+
+static const struct stress_model model = STRESS_MODEL_DEFAULT;
+static struct stress_engine eng;
+static struct k_spinlock lock;
+
+void stress_post_eda(bool contact)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stress_engine_eda(&eng, contact, k_uptime_get_32());
+	k_spin_unlock(&lock, key);
+}
+
+void stress_post_scr(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stress_engine_scr(&eng);
+	k_spin_unlock(&lock, key);
+}
+
+void stress_post_hrv(uint16_t rmssd_x10)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stress_engine_hrv(&eng, rmssd_x10, k_uptime_get_32());
+	k_spin_unlock(&lock, key);
+}
+
+void stress_post_hr(uint16_t bpm_x10)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stress_engine_hr(&eng, bpm_x10, k_uptime_get_32());
+	k_spin_unlock(&lock, key);
+}
+
+void stress_post_temp(int32_t mc)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stress_engine_temp(&eng, mc, k_uptime_get_32());
+	k_spin_unlock(&lock, key);
+}
+
+static void stress_thread(void *a, void *b, void *c)
+{
+	ARG_UNUSED(a);
+	ARG_UNUSED(b);
+	ARG_UNUSED(c);
+
+	uint32_t t_prev = k_uptime_get_32();
+
+	while (1) {
+		acq_batch_sleep(STRESS_EVAL_MS / ACQ_BATCH_MS);
+		if (!chan_sub_wanted(CHAN_STRESS)) {
+			continue;
+		}
+
+		/* SCRs counted while unsubscribed spread over the whole gap */
+		struct stress_result r;
+		uint32_t now = k_uptime_get_32();
+		k_spinlock_key_t key = k_spin_lock(&lock);
+
+		stress_engine_eval(&eng, now, now - t_prev, &r);
+		k_spin_unlock(&lock, key);
+		t_prev = now;
+
+		struct rec_stress rec = {
+			.score = r.score,
+			.fresh = r.fresh,
+			.scr = r.feat[STRESS_SCR],
+			.hrv = r.feat[STRESS_HRV],
+			.hr = r.feat[STRESS_HR],
+			.temp = r.feat[STRESS_TEMP],
+		};
+		(void)ble_rec_send(REC_STRESS, &rec, sizeof(rec));
+
+		LOG_INF("STRESS %u (fresh=0x%X) | scr=%u hrv=%u hr=%u temp=%u",
+			r.score, r.fresh, rec.scr, rec.hrv, rec.hr, rec.temp);
+	}
+}
+
+/* thread objects */
+#define STRESS_STACK_SIZE 1024
+#define STRESS_PRIORITY   6
+
+K_THREAD_STACK_DEFINE(stress_stack, STRESS_STACK_SIZE);
+static struct k_thread stress_tcb;
+static bool started;
+
+void stress_task_start(void)
+{
+	if (started) {
+		return;
+	}
+	started = true;
+
+	stress_engine_init(&eng, &model);
+
+	k_thread_create(&stress_tcb, stress_stack, K_THREAD_STACK_SIZEOF(stress_stack),
+			stress_thread, NULL, NULL, NULL,
+			STRESS_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(&stress_tcb, "stress_task");
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+void stress_task_start(void);
+
+/* Feature inputs from the sensor tasks (any thread) */
+void stress_post_eda(bool contact);
+void stress_post_scr(void);
+void stress_post_hrv(uint16_t rmssd_x10);
+void stress_post_hr(uint16_t bpm_x10);
+void stress_post_temp(int32_t mc);
@@ -5,6 +5,8 @@
 #include <zephyr/logging/log.h>
 #include <string.h>
 
+#include "w25n01_task.h"
+
 LOG_MODULE_REGISTER(w25n01_mem, LOG_LEVEL_INF);
 
 /* GPIO */
@@ -28,6 +30,10 @@ static const struct device *gpio0;
 static const struct device *gpio1;
 static const struct device *spi_dev;
 
+/* One owner of the SPI bus at a time: demo loop and storage users */
+static K_MUTEX_DEFINE(nand_lock);
+static bool nand_ready;
+
 static inline void cs_low(void)  { gpio_pin_set(gpio0, CS_PIN, 0); }
 static inline void cs_high(void) { gpio_pin_set(gpio0, CS_PIN, 1); }
 
@@ -63,9 +69,7 @@ static int spi_rx(uint8_t *rx, size_t len)
 #define SR_EFAIL (1 << 2)
 #define SR_PFAIL (1 << 3)
 
-#define PAGES_PER_BLOCK 64
-#define DEMO_BLOCK      1
-#define DEMO_PAGE       (DEMO_BLOCK * PAGES_PER_BLOCK)
+#define DEMO_PAGE       (W25N01_BLOCK_DEMO * W25N01_PAGES_PER_BLOCK)
 #define COL_ADDR        0x0000
 
 static uint8_t get_status(void)
@@ -81,20 +85,20 @@ static uint8_t get_status(void)
 	return rx[2];
 }
 
-static void wait_ready(const char *tag, int timeout_ms)
+static int wait_ready(const char *tag, int timeout_ms)
 {
 	int elapsed = 0;
 	while (1) {
 		uint8_t sr = get_status();
 		if ((sr & SR_OIP) == 0) {
-			LOG_INF("%s: READY (STATUS=0x%02X)", tag, sr);
-			return;
+			LOG_DBG("%s: READY (STATUS=0x%02X)", tag, sr);
+			return 0;
 		}
 		k_msleep(5);
 		elapsed += 5;
 		if (elapsed >= timeout_ms) {
 			LOG_ERR("%s: TIMEOUT (STATUS=0x%02X)", tag, sr);
-			return;
+			return -ETIMEDOUT;
 		}
 	}
 }
@@ -127,7 +131,7 @@ static void nand_wren(void)
 	cs_high();
 }
 
-static void nand_block_erase(uint32_t page_addr)
+static int nand_block_erase(uint32_t page_addr)
 {
 	uint8_t tx[4] = {
 		CMD_BLOCK_ERASE,
@@ -141,18 +145,22 @@ static void nand_block_erase(uint32_t page_addr)
 	spi_tx(tx, sizeof(tx));
 	cs_high();
 
-	LOG_INF("Erase issued for block=%d (page=%d)", DEMO_BLOCK, (int)page_addr);
-	wait_ready("ERASE", 3000);
+	LOG_INF("Erase issued for block=%d (page=%d)",
+		(int)(page_addr / W25N01_PAGES_PER_BLOCK), (int)page_addr);
+	if (wait_ready("ERASE", 3000)) {
+		return -ETIMEDOUT;
+	}
 
 	uint8_t sr = get_status();
 	if (sr & SR_EFAIL) {
 		LOG_ERR("ERASE FAILED (STATUS=0x%02X)", sr);
-	} else {
-		LOG_INF("Erase OK");
+		return -EIO;
 	}
+	LOG_INF("Erase OK");
+	return 0;
 }
 
-static void nand_program_page(uint32_t page_addr, const uint8_t *data, size_t len)
+static int nand_program_page(uint32_t page_addr, const uint8_t *data, size_t len)
 {
 	uint8_t hdr[3] = { CMD_PROG_LOAD, 0x00, 0x00 };
 
@@ -174,17 +182,20 @@ static void nand_program_page(uint32_t page_addr, const uint8_t *data, size_t le
 	cs_high();
 
 	LOG_INF("Program execute issued (page=%d)", (int)page_addr);
-	wait_ready("PROGRAM", 3000);
+	if (wait_ready("PROGRAM", 3000)) {
+		return -ETIMEDOUT;
+	}
 
 	uint8_t sr = get_status();
 	if (sr & SR_PFAIL) {
 		LOG_ERR("PROGRAM FAILED (STATUS=0x%02X)", sr);
-	} else {
-		LOG_INF("Program OK");
+		return -EIO;
 	}
+	LOG_INF("Program OK");
+	return 0;
 }
 
-static void nand_page_read_to_cache(uint32_t page_addr)
+static int nand_page_read_to_cache(uint32_t page_addr)
 {
 	uint8_t tx[4] = {
 		CMD_PAGE_READ,
@@ -197,7 +208,7 @@ static void nand_page_read_to_cache(uint32_t page_addr)
 	spi_tx(tx, sizeof(tx));
 	cs_high();
 
-	wait_ready("PAGE_READ", 3000);
+	return wait_ready("PAGE_READ", 3000);
 }
 
 static void nand_read_cache(uint16_t col, uint8_t *out, size_t len)
@@ -229,15 +240,14 @@ static void dump_10_bytes_one_line(const uint8_t *rb)
 		ascii);
 }
 
-/* ---------- thread wrapper ---------- */
-static void w25n01_thread(void *a, void *b, void *c)
+/* Bring the bus and the chip up once, for whichever user comes first.
+ * Call with nand_lock held.
+ */
+static int nand_init(void)
 {
-	ARG_UNUSED(a);
-	ARG_UNUSED(b);
-	ARG_UNUSED(c);
-
-	LOG_INF("W25N01 task started. Connect BLE now; demo will repeat every 30s.");
-	k_sleep(K_SECONDS(8));
+	if (nand_ready) {
+		return 0;
+	}
 
 	gpio0 = DEVICE_DT_GET(GPIO0_NODE);
 	gpio1 = DEVICE_DT_GET(GPIO1_NODE);
@@ -245,7 +255,7 @@ static void w25n01_thread(void *a, void *b, void *c)
 
 	if (!device_is_ready(gpio0) || !device_is_ready(gpio1) || !device_is_ready(spi_dev)) {
 		LOG_ERR("Devices not ready");
-		return;
+		return -ENODEV;
 	}
 
 	gpio_pin_configure(gpio0, CS_PIN, GPIO_OUTPUT_HIGH);
@@ -255,19 +265,85 @@ static void w25n01_thread(void *a, void *b, void *c)
 
 	nand_reset();
 	set_protection_off();
+	nand_ready = true;
+	return 0;
+}
+
+/* ---------- storage API ---------- */
+int w25n01_erase_block(uint32_t block)
+{
+	k_mutex_lock(&nand_lock, K_FOREVER);
+
+	int ret = nand_init();
+
+	if (ret == 0) {
+		ret = nand_block_erase(block * W25N01_PAGES_PER_BLOCK);
+	}
+	k_mutex_unlock(&nand_lock);
+	return ret;
+}
+
+int w25n01_write_page(uint32_t page, const void *data, size_t len)
+{
+	if (len > W25N01_PAGE_SIZE) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&nand_lock, K_FOREVER);
+
+	int ret = nand_init();
+
+	if (ret == 0) {
+		ret = nand_program_page(page, data, len);
+	}
+	k_mutex_unlock(&nand_lock);
+	return ret;
+}
+
+int w25n01_read_page(uint32_t page, uint16_t col, void *out, size_t len)
+{
+	if ((size_t)col + len > W25N01_PAGE_SIZE) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&nand_lock, K_FOREVER);
+
+	int ret = nand_init();
+
+	if (ret == 0) {
+		ret = nand_page_read_to_cache(page);
+	}
+	if (ret == 0) {
+		nand_read_cache(col, out, len);
+	}
+	k_mutex_unlock(&nand_lock);
+	return ret;
+}
+
+/* ---------- thread wrapper ---------- */
+static void w25n01_thread(void *a, void *b, void *c)
+{
+	ARG_UNUSED(a);
+	ARG_UNUSED(b);
+	ARG_UNUSED(c);
+
+	LOG_INF("W25N01 task started. Connect BLE now; demo will repeat every 30s.");
+	k_sleep(K_SECONDS(8));
 
 	const char msg[] = "HELLO NAND";
 
 	while (1) {
 		LOG_INF("=== W25N01 NAND DEMO START ===");
 
-		nand_block_erase(DEMO_PAGE);
-		nand_program_page(DEMO_PAGE, (const uint8_t *)msg, strlen(msg));
-
-		nand_page_read_to_cache(DEMO_PAGE);
+		(void)w25n01_erase_block(W25N01_BLOCK_DEMO);
+		(void)w25n01_write_page(DEMO_PAGE, msg, strlen(msg));
 
 		uint8_t rb[16] = {0};
-		nand_read_cache(COL_ADDR, rb, sizeof(rb));
+
+		if (w25n01_read_page(DEMO_PAGE, COL_ADDR, rb, sizeof(rb))) {
+			LOG_ERR("NAND not available");
+			return;
+		}
 
 		LOG_INF("SUMMARY STRING: '%c%c%c%c%c%c%c%c%c%c'",
 			rb[0], rb[1], rb[2], rb[3], rb[4],
@@ -1,3 +1,22 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* W25N01GV: 1 Gbit SPI NAND, 1024 blocks x 64 pages x 2048 bytes */
+#define W25N01_PAGE_SIZE        2048
+#define W25N01_PAGES_PER_BLOCK  64
+
+/* Block map */
+#define W25N01_BLOCK_DEMO       1    /* erase/program/verify loop */
+#define W25N01_BLOCK_FSM        2    /* LSM6DSO FSM program (lsm6dso_fsm.c) */
+#define W25N01_BLOCK_SLEEP      8    /* sleep epoch ring (sleep_store.c) */
+#define W25N01_SLEEP_BLOCKS     8
 
 void w25n01_task_start(void);
+
+/* Thread-safe storage access; the chip is brought up on first use.
+ * Pages must be erased (by block) before they are written.
+ */
+int w25n01_erase_block(uint32_t block);
+int w25n01_write_page(uint32_t page, const void *data, size_t len);
+int w25n01_read_page(uint32_t page, uint16_t col, void *out, size_t len);
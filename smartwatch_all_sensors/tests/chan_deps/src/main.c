@@ -0,0 +1,61 @@
+#include <zephyr/ztest.h>
+#include <zephyr/sys/util.h>
+
+#include "chan_deps.h"
+
+#define SENS_ALL (CHAN_SENS_PPG | CHAN_SENS_IMU | CHAN_SENS_EDA | CHAN_SENS_TEMP)
+
+/* The boot subscriptions: wear and fall (SUB_ALGO), sleep (SUB_NAND) */
+#define DAY_SUBS (BIT(CHAN_WEAR) | BIT(CHAN_FALL) | BIT(CHAN_SLEEP))
+
+static uint8_t sensors_for(uint32_t subs)
+{
+	return chan_deps_sensors(chan_deps_closure(subs));
+}
+
+ZTEST(chan_deps, test_nothing_subscribed)
+{
+	zassert_equal(chan_deps_closure(0), 0);
+	zassert_equal(sensors_for(0), 0);
+}
+
+ZTEST(chan_deps, test_day_defaults_leave_ppg_off)
+{
+	zassert_equal(chan_deps_closure(DAY_SUBS), DAY_SUBS);
+	zassert_equal(sensors_for(DAY_SUBS), CHAN_SENS_IMU | CHAN_SENS_EDA | CHAN_SENS_TEMP);
+}
+
+ZTEST(chan_deps, test_night_staging_adds_ppg)
+{
+	uint32_t night = DAY_SUBS | BIT(CHAN_HR) | BIT(CHAN_HRV);
+
+	zassert_equal(sensors_for(night), SENS_ALL);
+}
+
+ZTEST(chan_deps, test_dropping_algo_and_nand)
+{
+	/* only fall left: IMU */
+	zassert_equal(sensors_for(BIT(CHAN_FALL)), CHAN_SENS_IMU);
+	/* only sleep left: IMU */
+	zassert_equal(sensors_for(BIT(CHAN_SLEEP)), CHAN_SENS_IMU);
+	/* only wear left: no PPG */
+	zassert_equal(sensors_for(BIT(CHAN_WEAR)) & CHAN_SENS_PPG, 0);
+	/* temperature alone */
+	zassert_equal(sensors_for(BIT(CHAN_TEMP)), CHAN_SENS_TEMP);
+}
+
+ZTEST(chan_deps, test_stress_pulls_its_inputs)
+{
+	uint32_t w = chan_deps_closure(BIT(CHAN_STRESS));
+
+	zassert_equal(w, BIT(CHAN_STRESS) | BIT(CHAN_HR) | BIT(CHAN_HRV) | BIT(CHAN_EDA) |
+			 BIT(CHAN_TEMP));
+	zassert_equal(chan_deps_sensors(w), SENS_ALL);
+}
+
+ZTEST(chan_deps, test_log_and_power_need_no_sensor)
+{
+	zassert_equal(sensors_for(BIT(CHAN_LOG) | BIT(CHAN_POWER)), 0);
+}
+
+ZTEST_SUITE(chan_deps, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,132 @@
+#include <zephyr/ztest.h>
+
+#include "sleep_engine.h"
+
+#define ACT_STILL  0
+#define ACT_MOVE   200      /* weighted alone: 230 * 200 / 524 = 87 > wake_thr */
+
+static const struct sleep_cfg cfg = SLEEP_CFG_DEFAULT;
+static struct sleep_engine eng;
+
+static void epoch(uint16_t act, struct sleep_epoch_out *out)
+{
+	struct sleep_epoch_in in = { .act = act };
+
+	sleep_engine_epoch(&eng, &in, out);
+}
+
+static void fall_asleep(void)
+{
+	struct sleep_epoch_out out;
+
+	for (int i = 0; i < cfg.onset_epochs; i++) {
+		epoch(ACT_STILL, &out);
+	}
+	zassert_equal(out.evt, SLEEP_EVT_ONSET);
+}
+
+static void before(void *f)
+{
+	ARG_UNUSED(f);
+	sleep_engine_init(&eng, &cfg);
+}
+
+ZTEST(sleep_engine, test_awake_until_onset_epochs)
+{
+	struct sleep_epoch_out out;
+
+	for (int i = 0; i < cfg.onset_epochs - 1; i++) {
+		epoch(ACT_STILL, &out);
+		zassert_false(out.asleep);
+		zassert_equal(out.evt, SLEEP_EVT_NONE);
+		zassert_equal(out.n, 0);
+		zassert_equal(out.stage, SLEEP_STAGE_WAKE);
+	}
+}
+
+ZTEST(sleep_engine, test_onset_counts_from_first_quiet_epoch)
+{
+	struct sleep_epoch_out out;
+
+	for (int i = 0; i < cfg.onset_epochs; i++) {
+		epoch(ACT_STILL, &out);
+	}
+	zassert_equal(out.evt, SLEEP_EVT_ONSET);
+	zassert_true(out.asleep);
+	zassert_equal(out.n, cfg.onset_epochs);
+
+	epoch(ACT_STILL, &out);
+	zassert_equal(out.evt, SLEEP_EVT_NONE);
+	zassert_equal(out.n, cfg.onset_epochs + 1);
+}
+
+ZTEST(sleep_engine, test_movement_delays_onset)
+{
+	struct sleep_epoch_out out;
+
+	for (int i = 0; i < cfg.onset_epochs - 1; i++) {
+		epoch(ACT_STILL, &out);
+	}
+	epoch(ACT_MOVE, &out);
+	zassert_false(out.asleep);
+
+	/* the move stays in the weighted window for SLEEP_HIST epochs */
+	int quiet = 0;
+
+	do {
+		epoch(ACT_STILL, &out);
+		quiet++;
+	} while (!out.asleep && quiet < 100);
+	zassert_equal(out.evt, SLEEP_EVT_ONSET);
+	zassert_equal(out.n, cfg.onset_epochs);
+}
+
+ZTEST(sleep_engine, test_wake_after_wake_epochs)
+{
+	struct sleep_epoch_out out;
+
+	fall_asleep();
+	uint16_t n = cfg.onset_epochs;
+
+	for (int i = 0; i < cfg.wake_epochs - 1; i++) {
+		epoch(ACT_MOVE, &out);
+		zassert_true(out.asleep);
+		zassert_equal(out.stage, SLEEP_STAGE_WAKE);
+		zassert_equal(out.n, ++n);
+	}
+	epoch(ACT_MOVE, &out);
+	zassert_equal(out.evt, SLEEP_EVT_WAKE);
+	zassert_false(out.asleep);
+	zassert_equal(out.n, 0);
+}
+
+ZTEST(sleep_engine, test_second_night_counts_again)
+{
+	struct sleep_epoch_out out;
+
+	fall_asleep();
+	for (int i = 0; i < cfg.wake_epochs; i++) {
+		epoch(ACT_MOVE, &out);
+	}
+	zassert_equal(out.evt, SLEEP_EVT_WAKE);
+
+	int quiet = 0;
+
+	do {
+		epoch(ACT_STILL, &out);
+		quiet++;
+	} while (!out.asleep && quiet < 100);
+	zassert_equal(out.evt, SLEEP_EVT_ONSET);
+	zassert_equal(out.n, cfg.onset_epochs);
+}
+
+ZTEST(sleep_engine, test_light_without_hr)
+{
+	struct sleep_epoch_out out;
+
+	fall_asleep();
+	epoch(ACT_STILL, &out);
+	zassert_equal(out.stage, SLEEP_STAGE_LIGHT);
+}
+
+ZTEST_SUITE(sleep_engine, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,103 @@
+#include <zephyr/ztest.h>
+
+#include "stress_engine.h"
+
+#define T0_MC      33000
+#define FALL_MC_S  25      /* x0.1: 2.5 mC/s = 150 mC/min, half of full scale */
+
+static const struct stress_model model = STRESS_MODEL_DEFAULT;
+static struct stress_engine eng;
+
+static void before(void *f)
+{
+	ARG_UNUSED(f);
+	stress_engine_init(&eng, &model);
+}
+
+/* Falling skin temperature read every interval_s for an hour */
+static void temp_ramp(struct stress_engine *s, uint32_t interval_s)
+{
+	for (uint32_t t = 0; t <= 3600; t += interval_s) {
+		stress_engine_temp(s, T0_MC - (int32_t)(t * FALL_MC_S) / 10, t * 1000);
+	}
+}
+
+ZTEST(stress_engine, test_scr_rate_independent_of_eval_interval)
+{
+	struct stress_engine late;
+	struct stress_result r;
+
+	stress_engine_init(&late, &model);
+
+	/* 12 SCR/min: one per 5 s eval, or twelve held over a 60 s eval */
+	stress_engine_scr(&eng);
+	stress_engine_eval(&eng, 5000, 5000, &r);
+	for (int i = 0; i < 12; i++) {
+		stress_engine_scr(&late);
+	}
+	stress_engine_eval(&late, 60000, 60000, &r);
+
+	zassert_equal(dsp_ema_get(&eng.scr_rate), 1200);
+	zassert_equal(dsp_ema_get(&late.scr_rate), 1200);
+}
+
+ZTEST(stress_engine, test_temp_closed_form_matches_per_second_steps)
+{
+	struct dsp_ema fast = DSP_EMA_INIT(4);
+	struct dsp_ema slow = DSP_EMA_INIT(7);
+	int32_t prev = T0_MC;
+
+	temp_ramp(&eng, 300);
+
+	/* reference: one EMA step per second, interpolated between readings */
+	dsp_ema_step(&fast, prev);
+	dsp_ema_step(&slow, prev);
+	for (uint32_t t = 300; t <= 3600; t += 300) {
+		int32_t mc = T0_MC - (int32_t)(t * FALL_MC_S) / 10;
+
+		for (int32_t i = 1; i <= 300; i++) {
+			int32_t x = prev + ((mc - prev) * i) / 300;
+
+			dsp_ema_step(&fast, x);
+			dsp_ema_step(&slow, x);
+		}
+		prev = mc;
+	}
+
+	zassert_within(dsp_ema_get(&eng.temp_fast), dsp_ema_get(&fast), 2);
+	zassert_within(dsp_ema_get(&eng.temp_slow), dsp_ema_get(&slow), 2);
+}
+
+ZTEST(stress_engine, test_temp_feature_independent_of_read_interval)
+{
+	static const uint32_t interval_s[] = { 1, 10, 60, 600 };
+	struct stress_result r;
+
+	for (size_t i = 0; i < ARRAY_SIZE(interval_s); i++) {
+		stress_engine_init(&eng, &model);
+		temp_ramp(&eng, interval_s[i]);
+		stress_engine_eval(&eng, 3600000, 5000, &r);
+		zassert_true(r.fresh & BIT(STRESS_TEMP));
+		zassert_within(r.feat[STRESS_TEMP], 50, 2);
+	}
+}
+
+ZTEST(stress_engine, test_temp_stale_after_two_intervals)
+{
+	struct stress_result r;
+
+	stress_engine_temp(&eng, T0_MC, 0);
+	stress_engine_eval(&eng, 5000, 5000, &r);
+	zassert_true(r.fresh & BIT(STRESS_TEMP));
+	stress_engine_eval(&eng, 5001, 1, &r);
+	zassert_false(r.fresh & BIT(STRESS_TEMP));
+
+	/* 600 s readings: fresh until two intervals have passed */
+	stress_engine_temp(&eng, T0_MC, 600000);
+	stress_engine_eval(&eng, 600000 + 1200000, 5000, &r);
+	zassert_true(r.fresh & BIT(STRESS_TEMP));
+	stress_engine_eval(&eng, 600000 + 1200001, 1, &r);
+	zassert_false(r.fresh & BIT(STRESS_TEMP));
+}
+
+ZTEST_SUITE(stress_engine, NULL, NULL, before, NULL, NULL);